@@ -1,6 +1,7 @@
 #include <maya/MAnimControl.h>
 #include <maya/MArrayDataBuilder.h>
 #include <maya/MConditionMessage.h>
+#include <maya/MDGContext.h>
 #include <maya/MDataHandle.h>
 #include <maya/MFnCompoundAttribute.h>
 #include <maya/MFnEnumAttribute.h>
@@ -15,6 +16,7 @@
 #include <maya/MTime.h>
 
 #include "Asset.h"
+#include "AssetFrameCache.h"
 #include "AssetNode.h"
 #include "Input.h"
 #include "OutputGeometryObject.h"
@@ -485,7 +487,9 @@ private:
 
 Asset::Asset(const MString &otlFilePath, const MString &assetName)
     : // initialize values here because instantiating the asset could error out
-      myAssetInputs(NULL)
+      myAssetInputs(NULL),
+      myInputGeneration(0),
+      myIsOutputStale(false)
 {
     myParmNameCache = std::unique_ptr<ParmNameCache>(new ParmNameCache());
 
@@ -620,6 +624,9 @@ Asset::~Asset()
     }
     myMaterials.clear();
 
+    OutputMaterial::removeAsset(myAssetInfo.nodeId);
+    AssetFrameCache::removeNode(myNodeInfo.id);
+
     if (!Util::theHAPISession.get())
         return;
 
@@ -694,6 +701,8 @@ Asset::resetSimulation()
     assert(myNodeInfo.id >= 0);
 
     HoudiniApi::ResetSimulation(Util::theHAPISession.get(), myNodeInfo.id);
+
+    AssetFrameCache::removeNode(myNodeInfo.id);
 }
 
 MString
@@ -933,6 +942,7 @@ Asset::setInputs(const MPlug &plug, MDataBlock &data)
     MStatus status;
 
     myAssetInputs->compute(data);
+    myInputGeneration++;
 
     for (int i = 0; i < myNodeInfo.inputCount; i++)
     {
@@ -970,47 +980,111 @@ Asset::compute(const MPlug &plug,
 {
     assert(myNodeInfo.id >= 0);
 
-    HAPI_Result hapiResult;
-
     MStatus stat(MS::kSuccess);
 
     if (MGlobal::optionVarIntValue("houdiniEngineDisableCooking") == 1)
         return stat;
 
+#if MAYA_API_VERSION >= 20180000
+    // Computed ahead of the current time by the frame cache
+    const bool isCookAhead = !data.context().isNormal();
+#else
+    const bool isCookAhead = false;
+#endif
+
+    AssetFrameCache::FrameScope frameScope(
+        myNodeInfo.id, myTime, myInputGeneration);
+
+    // All the outputs are computed when they come from the frame cache, since
+    // the cook counts don't follow the time, and when they go into it, so
+    // that the cached frame has all of their calls. The outputs that were
+    // computed ahead went to another data block, so the previous outputs
+    // can't be kept either.
+    const bool recomputeOutputData = needToRecomputeOutputData ||
+                                     myIsOutputStale || isCookAhead ||
+                                     frameScope.isActive();
+
+    if (!frameScope.isCached())
     {
-        Util::PythonInterpreterLock pythonInterpreterLock;
-
-        HAPI_CookOptions cookOptions;
-        HoudiniApi::CookOptions_Init(&cookOptions);
-        cookOptions.splitGeosByGroup  = options.splitGeosByGroup();
-        cookOptions.cookTemplatedGeos = options.outputTemplatedGeometries();
-
-        if (options.useInstancerNode())
+        stat = cook(options);
+        if (MFAIL(stat))
         {
-            // Particle instancer cannot instance other particle instancer. So
-            // we can only do flatten.
-            cookOptions.packedPrimInstancingMode =
-                HAPI_PACKEDPRIM_INSTANCING_MODE_FLAT;
+            frameScope.discard();
+            return stat;
         }
-        else
+    }
+
+    frameScope.start();
+    computeOutputs(plug, data, options, needToSyncOutputs, recomputeOutputData);
+
+    if (frameScope.isIncomplete())
+    {
+        // Some of the calls were not in the cached frame, so the outputs
+        // are computed again from a cook.
+        frameScope.discard();
+
+        stat = cook(options);
+        if (MFAIL(stat))
         {
-            cookOptions.packedPrimInstancingMode =
-                HAPI_PACKEDPRIM_INSTANCING_MODE_HIERARCHY;
+            return stat;
         }
 
-        hapiResult = HoudiniApi::CookNode(
-            Util::theHAPISession.get(), myNodeInfo.id, &cookOptions);
-        CHECK_HAPI(hapiResult);
+        computeOutputs(
+            plug, data, options, needToSyncOutputs, recomputeOutputData);
+    }
 
-        if (!Util::statusCheckLoop())
-        {
-            GET_HAPI_STATUS_COOK();
-            DISPLAY_MSG(displayError, hapiStatus);
+    myIsOutputStale = isCookAhead;
 
-            return MStatus::kFailure;
-        }
+    return stat;
+}
+
+MStatus
+Asset::cook(AssetNodeOptions::AccessorDataBlock &options)
+{
+    HAPI_Result hapiResult;
+
+    Util::PythonInterpreterLock pythonInterpreterLock;
+
+    HAPI_CookOptions cookOptions;
+    HoudiniApi::CookOptions_Init(&cookOptions);
+    cookOptions.splitGeosByGroup  = options.splitGeosByGroup();
+    cookOptions.cookTemplatedGeos = options.outputTemplatedGeometries();
+
+    if (options.useInstancerNode())
+    {
+        // Particle instancer cannot instance other particle instancer. So
+        // we can only do flatten.
+        cookOptions.packedPrimInstancingMode =
+            HAPI_PACKEDPRIM_INSTANCING_MODE_FLAT;
+    }
+    else
+    {
+        cookOptions.packedPrimInstancingMode =
+            HAPI_PACKEDPRIM_INSTANCING_MODE_HIERARCHY;
+    }
+
+    hapiResult = HoudiniApi::CookNode(
+        Util::theHAPISession.get(), myNodeInfo.id, &cookOptions);
+    CHECK_HAPI(hapiResult);
+
+    if (!Util::statusCheckLoop())
+    {
+        GET_HAPI_STATUS_COOK();
+        DISPLAY_MSG(displayError, hapiStatus);
+
+        return MStatus::kFailure;
     }
 
+    return MStatus::kSuccess;
+}
+
+void
+Asset::computeOutputs(const MPlug &plug,
+                      MDataBlock &data,
+                      AssetNodeOptions::AccessorDataBlock &options,
+                      bool &needToSyncOutputs,
+                      const bool needToRecomputeOutputData)
+{
     update();
 
     // output asset transform
@@ -1067,8 +1141,6 @@ Asset::compute(const MPlug &plug,
 
     computeMaterial(
         plug, data, options.bakeOutputTextures(), needToSyncOutputs);
-
-    return stat;
 }
 
 class GetMultiparmLengthOperation : public AttrOperation
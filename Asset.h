@@ -71,6 +71,13 @@ public:
 private:
     void update();
 
+    MStatus cook(AssetNodeOptions::AccessorDataBlock &options);
+    void computeOutputs(const MPlug &plug,
+                        MDataBlock &data,
+                        AssetNodeOptions::AccessorDataBlock &options,
+                        bool &needToSyncOutputs,
+                        const bool needToRecomputeOutputData);
+
     void computeInstancerObjects(const MPlug &plug,
                                  MDataBlock &data,
                                  MIntArray &instancedObjIds,
@@ -101,6 +108,11 @@ private:
     HAPI_NodeInfo myNodeInfo;
 
     Inputs *myAssetInputs;
+    // Incremented each time the inputs are pushed to Houdini
+    unsigned int myInputGeneration;
+    // Whether the last outputs were computed in another context than the
+    // normal one, so they are not the outputs of the normal data block.
+    bool myIsOutputStale;
     OutputObjects myObjects; // the OutputObject class contains a 1 to 1 map
                              // with HAPI_ObjectInfos.
 
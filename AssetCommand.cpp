@@ -88,9 +88,9 @@ public:
         HAPI_Result hapiResult;
 
         int libraryId = -1;
-        hapiResult = HAPI_LoadAssetLibraryFromFile(Util::theHAPISession.get(),
-                                                   myOTLFilePath.asChar(), true,
-                                                   &libraryId);
+        hapiResult = HoudiniApi::LoadAssetLibraryFromFile(Util::theHAPISession.get(),
+                                                          myOTLFilePath.asChar(), true,
+                                                          &libraryId);
         if (HAPI_FAIL(hapiResult))
         {
             DISPLAY_ERROR("Could not load OTL file: ^1s", myOTLFilePath);
@@ -100,14 +100,14 @@ public:
         }
 
         int assetCount = 0;
-        hapiResult     = HAPI_GetAvailableAssetCount(
+        hapiResult     = HoudiniApi::GetAvailableAssetCount(
             Util::theHAPISession.get(), libraryId, &assetCount);
         CHECK_HAPI_AND_RETURN(hapiResult, MStatus::kFailure);
 
         std::vector<HAPI_StringHandle> assetNamesSH(assetCount);
-        hapiResult = HAPI_GetAvailableAssets(Util::theHAPISession.get(),
-                                             libraryId, &assetNamesSH.front(),
-                                             assetNamesSH.size());
+        hapiResult = HoudiniApi::GetAvailableAssets(Util::theHAPISession.get(),
+                                                    libraryId, &assetNamesSH.front(),
+                                                    assetNamesSH.size());
         CHECK_HAPI_AND_RETURN(hapiResult, MStatus::kFailure);
 
         for (unsigned int i = 0; i < assetNamesSH.size(); i++)
@@ -156,8 +156,8 @@ public:
 
         int nodeId = asset->getNodeInfo().id;
 
-        hapiResult = HAPI_GetParmInfoFromName(Util::theHAPISession.get(), nodeId,
-                                              myParmName.asChar(), &parmInfo);
+        hapiResult = HoudiniApi::GetParmInfoFromName(Util::theHAPISession.get(), nodeId,
+                                                     myParmName.asChar(), &parmInfo);
 
         if (!HAPI_FAIL(hapiResult))
         {
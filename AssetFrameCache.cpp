@@ -0,0 +1,700 @@
+#include "AssetFrameCache.h"
+
+#include <maya/MAnimControl.h>
+#include <maya/MDGContext.h>
+#if MAYA_API_VERSION >= 20180000
+#include <maya/MDGContextGuard.h>
+#endif
+#include <maya/MEventMessage.h>
+#include <maya/MObjectHandle.h>
+
+#include <cstring>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "HoudiniApiArguments.h"
+#include "util.h"
+
+namespace
+{
+using namespace HoudiniApiArguments;
+
+struct Frame
+{
+    HAPI_NodeId nodeId;
+    double time;
+    unsigned long long stateHash;
+
+    // Position of the return value and of the outputs of each call in bytes,
+    // by the hash of the function and of its arguments.
+    std::unordered_map<unsigned long long, size_t> calls;
+    ByteWriter bytes;
+};
+
+// Most recently used first
+typedef std::list<Frame> Frames;
+
+// Rough size of an entry of Frame::calls
+const size_t theCallOverhead = 4 * sizeof(void *) + 2 * sizeof(size_t);
+
+struct CookAheadRequest
+{
+    MObjectHandle node;
+    MPlug plug;
+    HAPI_NodeId nodeId;
+    MTime time;
+};
+
+// The role of a function in the calls whose result depends on an earlier
+// call, like HAPI_GetStringBatch() on HAPI_GetStringBatchSize() or
+// HAPI_GetComposedObjectList() on HAPI_ComposeObjectList().
+enum CallRole
+{
+    CallRoleNone,
+    CallRoleComposer,
+    CallRoleComposed
+};
+
+std::mutex theMutex;
+Frames theFrames;
+
+bool theIsEnabled              = false;
+size_t theByteBudget           = 0;
+int theCookAheadFrames         = 0;
+size_t theByteCount            = 0;
+unsigned int theHitCount       = 0;
+unsigned int theMissCount      = 0;
+unsigned int theEvictionCount  = 0;
+unsigned int theCookAheadCount = 0;
+
+// The frame that the calls are answered from or recorded into, if any
+Frame *theCurrentFrame            = NULL;
+bool theIsAnswering               = false;
+bool theIsIncomplete              = false;
+unsigned long long theComposerKey = 0;
+Frame theRecordedFrame;
+// Reused by the calls, which are serialized by theMutex.
+ByteWriter theArgumentBuffer;
+
+std::deque<CookAheadRequest> theCookAheadRequests;
+MCallbackId theIdleCallbackId = 0;
+bool theHasIdleCallback       = false;
+bool theIsCookingAhead        = false;
+
+size_t
+frameByteCount(const Frame &frame)
+{
+    return sizeof(Frame) + frame.bytes.size() +
+           frame.calls.size() * theCallOverhead;
+}
+
+Frames::iterator
+removeFrame(Frames::iterator frame)
+{
+    theByteCount -= frameByteCount(*frame);
+    return theFrames.erase(frame);
+}
+
+// Returns the frame of the node at the time. A frame of the node at the same
+// time, but with a different state, means that its parms or inputs changed
+// since it was cached. All the frames of the node are dropped then.
+Frames::iterator
+findFrame(HAPI_NodeId nodeId, double time, unsigned long long stateHash)
+{
+    bool isStale = false;
+    for (Frames::iterator iter = theFrames.begin(); iter != theFrames.end();
+         iter++)
+    {
+        if (iter->nodeId != nodeId || iter->time != time)
+        {
+            continue;
+        }
+
+        if (iter->stateHash == stateHash)
+        {
+            return iter;
+        }
+
+        isStale = true;
+    }
+
+    if (isStale)
+    {
+        for (Frames::iterator iter = theFrames.begin();
+             iter != theFrames.end();)
+        {
+            iter = iter->nodeId == nodeId ? removeFrame(iter) : ++iter;
+        }
+    }
+
+    return theFrames.end();
+}
+
+bool
+hasFrame(HAPI_NodeId nodeId, double time)
+{
+    for (Frames::const_iterator iter = theFrames.begin();
+         iter != theFrames.end(); iter++)
+    {
+        if (iter->nodeId == nodeId && iter->time == time)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void
+evictFrames()
+{
+    while (theByteCount > theByteBudget && !theFrames.empty())
+    {
+        removeFrame(--theFrames.end());
+        theEvictionCount++;
+    }
+}
+
+// Hashes the state that a cook of the node depends on, other than the time:
+// the values of its parms, and the inputs that were pushed to Houdini.
+bool
+hashState(HAPI_NodeId nodeId,
+          unsigned int inputGeneration,
+          unsigned long long &hash)
+{
+    hash = Util::hashBytes(
+        Util::hashSeed, &inputGeneration, sizeof(inputGeneration));
+
+    return Util::hashParmValues(nodeId, hash);
+}
+
+template <typename FuncPtr, FuncPtr *Slot>
+struct CachedFunction;
+
+template <typename R, typename... Args, R (**Slot)(Args...)>
+struct CachedFunction<R (*)(Args...), Slot>
+    : public HoudiniApiArguments::SlotWrapper<
+          R (*)(Args...),
+          Slot,
+          CachedFunction<R (*)(Args...), Slot>,
+          HoudiniApiArguments::LayerFrameCache>
+{
+    typedef R (*FuncPtr)(Args...);
+    typedef HoudiniApiArguments::SlotWrapper<
+        FuncPtr,
+        Slot,
+        CachedFunction,
+        HoudiniApiArguments::LayerFrameCache>
+        Base;
+
+    static R call(Args... args)
+    {
+        std::unique_lock<std::mutex> lock(theMutex);
+
+        if (!theCurrentFrame)
+        {
+            lock.unlock();
+            return Base::theOriginal(args...);
+        }
+
+        theArgumentBuffer.clear();
+        theArgumentBuffer.write(theIndex);
+        if (theRole == CallRoleComposed)
+        {
+            theArgumentBuffer.write(theComposerKey);
+        }
+
+        ArgumentWriter argumentWriter(theArgumentBuffer);
+        HoudiniApiArguments::visit<FuncPtr, Slot>(argumentWriter, args...);
+
+        const unsigned long long key = Util::hashBytes(
+            Util::hashSeed, theArgumentBuffer.data(), theArgumentBuffer.size());
+        if (theRole == CallRoleComposer)
+        {
+            theComposerKey = key;
+        }
+
+        Frame &frame = *theCurrentFrame;
+        ReturnValue<R> result;
+
+        if (theIsAnswering)
+        {
+            if (answer(frame, key, result, args...))
+            {
+                return result.get();
+            }
+
+            theIsIncomplete = true;
+            result.call([&]() { return Base::theOriginal(args...); });
+            return result.get();
+        }
+
+        // Failed calls are kept as well, since they fail the same way when
+        // the frame is computed again.
+        result.call([&]() { return Base::theOriginal(args...); });
+
+        if (frame.calls.find(key) == frame.calls.end())
+        {
+            frame.calls[key] = frame.bytes.size();
+            result.write(frame.bytes);
+
+            OutputWriter outputWriter(frame.bytes);
+            HoudiniApiArguments::visit<FuncPtr, Slot>(outputWriter, args...);
+        }
+
+        return result.get();
+    }
+
+    static bool answer(const Frame &frame,
+                       unsigned long long key,
+                       ReturnValue<R> &result,
+                       Args... args)
+    {
+        std::unordered_map<unsigned long long, size_t>::const_iterator call =
+            frame.calls.find(key);
+        if (call == frame.calls.end())
+        {
+            return false;
+        }
+
+        ByteReader reader(frame.bytes.bytes(), call->second);
+        if (!result.read(reader))
+        {
+            return false;
+        }
+
+        OutputReader outputReader(reader);
+        HoudiniApiArguments::visit<FuncPtr, Slot>(outputReader, args...);
+
+        return outputReader.isValid() && outputReader.isMatching();
+    }
+
+    static void install(int index, CallRole role)
+    {
+        theIndex = index;
+        theRole  = role;
+        Base::install();
+    }
+
+    static int theIndex;
+    static CallRole theRole;
+};
+
+template <typename R, typename... Args, R (**Slot)(Args...)>
+int CachedFunction<R (*)(Args...), Slot>::theIndex = -1;
+
+template <typename R, typename... Args, R (**Slot)(Args...)>
+CallRole CachedFunction<R (*)(Args...), Slot>::theRole = CallRoleNone;
+
+bool
+startsWith(const char *name, const char *prefix)
+{
+    return strncmp(name, prefix, strlen(prefix)) == 0;
+}
+
+// Only the calls that read the results of a cook are cached. The status of
+// the session is always asked to HAPI.
+bool
+isCachedFunction(const char *name)
+{
+    return (startsWith(name, "Get") || startsWith(name, "Compose")) &&
+           !startsWith(name, "GetStatus") && !startsWith(name, "GetCooking");
+}
+
+CallRole
+callRole(const char *name)
+{
+    if (startsWith(name, "Compose") || strcmp(name, "GetStringBatchSize") == 0)
+    {
+        return CallRoleComposer;
+    }
+
+    if (startsWith(name, "GetComposed") || strcmp(name, "GetStringBatch") == 0)
+    {
+        return CallRoleComposed;
+    }
+
+    return CallRoleNone;
+}
+
+#define HOUDINI_API_INSTALL(name)                                              \
+    if (isCachedFunction(#name))                                               \
+    {                                                                          \
+        CachedFunction<HoudiniApi::name##FuncPtr, &HoudiniApi::name>::install( \
+            index, callRole(#name));                                           \
+    }                                                                          \
+    index++;
+#define HOUDINI_API_UNINSTALL(name)                                            \
+    CachedFunction<HoudiniApi::name##FuncPtr, &HoudiniApi::name>::uninstall();
+
+void
+install()
+{
+    int index = 0;
+    HOUDINI_API_FUNCTIONS(HOUDINI_API_INSTALL)
+}
+
+void
+uninstall()
+{
+    HOUDINI_API_FUNCTIONS(HOUDINI_API_UNINSTALL)
+}
+
+void
+removeIdleCallback()
+{
+    if (theHasIdleCallback)
+    {
+        MMessage::removeCallback(theIdleCallbackId);
+        theHasIdleCallback = false;
+    }
+}
+
+// Computes one of the requested frames each time Maya is idle, so that
+// playback stays responsive.
+void
+cookAheadIdleCallback(void *clientData)
+{
+    if (!theIsEnabled || !MAnimControl::isPlaying() ||
+        theCookAheadRequests.empty())
+    {
+        theCookAheadRequests.clear();
+        removeIdleCallback();
+        return;
+    }
+
+    CookAheadRequest request = theCookAheadRequests.front();
+    theCookAheadRequests.pop_front();
+
+    {
+        std::lock_guard<std::mutex> lock(theMutex);
+        if (hasFrame(request.nodeId, request.time.as(MTime::kSeconds)))
+        {
+            return;
+        }
+    }
+
+    if (!request.node.isValid())
+    {
+        return;
+    }
+
+    theIsCookingAhead = true;
+    {
+        MDGContext context(request.time);
+#if MAYA_API_VERSION >= 20180000
+        MDGContextGuard contextGuard(context);
+        request.plug.asDouble();
+#else
+        request.plug.asDouble(context);
+#endif
+    }
+    theIsCookingAhead = false;
+
+    theCookAheadCount++;
+}
+}
+
+void
+AssetFrameCache::enable(size_t byteBudget, int cookAheadFrames)
+{
+    std::lock_guard<std::mutex> lock(theMutex);
+
+    theByteBudget      = byteBudget;
+    theCookAheadFrames = cookAheadFrames;
+    evictFrames();
+
+    if (!theIsEnabled)
+    {
+        install();
+        theIsEnabled = true;
+    }
+}
+
+void
+AssetFrameCache::disable()
+{
+    {
+        std::lock_guard<std::mutex> lock(theMutex);
+
+        if (!theIsEnabled)
+        {
+            return;
+        }
+
+        uninstall();
+        theIsEnabled = false;
+    }
+
+    theCookAheadRequests.clear();
+    removeIdleCallback();
+
+    clear();
+}
+
+bool
+AssetFrameCache::isEnabled()
+{
+    return theIsEnabled;
+}
+
+void
+AssetFrameCache::clear()
+{
+    std::lock_guard<std::mutex> lock(theMutex);
+
+    theFrames.clear();
+    theByteCount      = 0;
+    theHitCount       = 0;
+    theMissCount      = 0;
+    theEvictionCount  = 0;
+    theCookAheadCount = 0;
+}
+
+void
+AssetFrameCache::removeNode(HAPI_NodeId nodeId)
+{
+    std::lock_guard<std::mutex> lock(theMutex);
+
+    for (Frames::iterator iter = theFrames.begin(); iter != theFrames.end();)
+    {
+        iter = iter->nodeId == nodeId ? removeFrame(iter) : ++iter;
+    }
+
+    for (std::deque<CookAheadRequest>::iterator iter =
+             theCookAheadRequests.begin();
+         iter != theCookAheadRequests.end();)
+    {
+        iter = iter->nodeId == nodeId ? theCookAheadRequests.erase(iter) :
+                                        ++iter;
+    }
+}
+
+MString
+AssetFrameCache::summary()
+{
+    std::lock_guard<std::mutex> lock(theMutex);
+
+    MString result;
+    result.format("frames: ^1s, bytes: ^2s of ^3s, hits: ^4s, misses: ^5s, "
+                  "evictions: ^6s, cooked ahead: ^7s",
+                  MString() + (double)theFrames.size(),
+                  MString() + (double)theByteCount,
+                  MString() + (double)theByteBudget, MString() + theHitCount,
+                  MString() + theMissCount, MString() + theEvictionCount,
+                  MString() + theCookAheadCount);
+
+    return result;
+}
+
+void
+AssetFrameCache::scheduleCookAhead(const MPlug &outputPlug,
+                                   HAPI_NodeId nodeId,
+                                   const MTime &time)
+{
+    if (!theIsEnabled || theCookAheadFrames <= 0 || theIsCookingAhead ||
+        !MAnimControl::isPlaying())
+    {
+        return;
+    }
+
+    const MTime oneFrame(1, MTime::uiUnit());
+    const MTime minTime = MAnimControl::minTime();
+    const MTime maxTime = MAnimControl::maxTime();
+
+    MTime frameTime = time;
+    for (int i = 0; i < theCookAheadFrames; i++)
+    {
+        // Playback loops over the range
+        frameTime += oneFrame;
+        if (frameTime > maxTime)
+        {
+            frameTime = minTime;
+        }
+
+        if (frameTime == time)
+        {
+            break;
+        }
+
+        bool isScheduled = false;
+        {
+            std::lock_guard<std::mutex> lock(theMutex);
+            isScheduled = hasFrame(nodeId, frameTime.as(MTime::kSeconds));
+        }
+
+        for (size_t j = 0; !isScheduled && j < theCookAheadRequests.size();
+             j++)
+        {
+            isScheduled = theCookAheadRequests[j].nodeId == nodeId &&
+                          theCookAheadRequests[j].time == frameTime;
+        }
+
+        if (isScheduled)
+        {
+            continue;
+        }
+
+        CookAheadRequest request;
+        request.node   = outputPlug.node();
+        request.plug   = outputPlug;
+        request.nodeId = nodeId;
+        request.time   = frameTime;
+        theCookAheadRequests.push_back(request);
+    }
+
+    if (!theCookAheadRequests.empty() && !theHasIdleCallback)
+    {
+        MStatus status;
+        theIdleCallbackId = MEventMessage::addEventCallback(
+            "idle", cookAheadIdleCallback, NULL, &status);
+        theHasIdleCallback = status;
+        CHECK_MSTATUS(status);
+    }
+}
+
+AssetFrameCache::FrameScope::FrameScope(HAPI_NodeId nodeId,
+                                        const MTime &time,
+                                        unsigned int inputGeneration)
+    : myIsActive(false),
+      myIsCached(false),
+      myIsStarted(false),
+      myNodeId(nodeId),
+      myTime(time.as(MTime::kSeconds)),
+      myStateHash(0)
+{
+    if (!theIsEnabled || !hashState(nodeId, inputGeneration, myStateHash))
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(theMutex);
+
+    // Scopes don't nest
+    if (theCurrentFrame)
+    {
+        return;
+    }
+
+    myIsActive = true;
+
+    Frames::iterator frame = findFrame(myNodeId, myTime, myStateHash);
+    myIsCached             = frame != theFrames.end();
+    if (myIsCached)
+    {
+        theFrames.splice(theFrames.begin(), theFrames, frame);
+        theHitCount++;
+    }
+    else
+    {
+        theMissCount++;
+    }
+}
+
+AssetFrameCache::FrameScope::~FrameScope()
+{
+    std::lock_guard<std::mutex> lock(theMutex);
+
+    if (!myIsActive || !myIsStarted)
+    {
+        return;
+    }
+
+    theCurrentFrame = NULL;
+
+    if (myIsCached)
+    {
+        return;
+    }
+
+    theFrames.push_front(std::move(theRecordedFrame));
+    theRecordedFrame = Frame();
+    theByteCount += frameByteCount(theFrames.front());
+    evictFrames();
+}
+
+bool
+AssetFrameCache::FrameScope::isActive() const
+{
+    return myIsActive;
+}
+
+bool
+AssetFrameCache::FrameScope::isCached() const
+{
+    return myIsCached;
+}
+
+void
+AssetFrameCache::FrameScope::start()
+{
+    std::lock_guard<std::mutex> lock(theMutex);
+
+    if (!myIsActive || myIsStarted)
+    {
+        return;
+    }
+
+    myIsStarted     = true;
+    theIsIncomplete = false;
+    theComposerKey  = 0;
+
+    if (myIsCached)
+    {
+        // The frame was moved to the front when it was looked up
+        theCurrentFrame = &theFrames.front();
+        theIsAnswering  = true;
+    }
+    else
+    {
+        theRecordedFrame           = Frame();
+        theRecordedFrame.nodeId    = myNodeId;
+        theRecordedFrame.time      = myTime;
+        theRecordedFrame.stateHash = myStateHash;
+        theCurrentFrame            = &theRecordedFrame;
+        theIsAnswering             = false;
+    }
+}
+
+bool
+AssetFrameCache::FrameScope::isIncomplete() const
+{
+    std::lock_guard<std::mutex> lock(theMutex);
+
+    return myIsActive && myIsStarted && theIsIncomplete;
+}
+
+void
+AssetFrameCache::FrameScope::discard()
+{
+    std::lock_guard<std::mutex> lock(theMutex);
+
+    if (!myIsActive)
+    {
+        return;
+    }
+
+    if (myIsStarted)
+    {
+        theCurrentFrame = NULL;
+    }
+
+    if (myIsCached)
+    {
+        Frames::iterator frame = findFrame(myNodeId, myTime, myStateHash);
+        if (frame != theFrames.end())
+        {
+            removeFrame(frame);
+        }
+    }
+    else
+    {
+        theRecordedFrame = Frame();
+    }
+
+    myIsActive = false;
+}
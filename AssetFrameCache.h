@@ -0,0 +1,85 @@
+#ifndef __AssetFrameCache_h__
+#define __AssetFrameCache_h__
+
+#include <maya/MPlug.h>
+#include <maya/MString.h>
+#include <maya/MTime.h>
+
+#include <HAPI/HAPI.h>
+
+#include <cstddef>
+
+// Optional in-memory cache of the cooked frames of the assets. A frame holds
+// the HAPI Get calls, and the data that they returned, that were made while
+// the outputs of an asset were computed after a cook. When the asset is
+// computed again at the same time, with the same parm values and inputs, the
+// cook is skipped and the Get calls are answered from the cache instead. This
+// lets looping playback run without cooking Houdini again. The frames are
+// evicted, least recently used first, once they take more than the byte
+// budget.
+//
+// Cook-ahead computes the next frames of the assets that are computed during
+// playback while Maya is idle between two frames, so that they are already
+// cached when playback reaches them.
+class AssetFrameCache
+{
+public:
+    static void enable(size_t byteBudget, int cookAheadFrames);
+    static void disable();
+    static bool isEnabled();
+
+    static void clear();
+
+    // Removes the frames of a node, e.g. when it is deleted or its simulation
+    // is reset.
+    static void removeNode(HAPI_NodeId nodeId);
+
+    // Returns the number of frames, bytes, hits and misses of the cache.
+    static MString summary();
+
+    // Computes the node at the next frames while Maya is idle, if playback is
+    // running. outputPlug is evaluated at each of the frames, in a timed
+    // context, which computes the node.
+    static void scheduleCookAhead(const MPlug &outputPlug,
+                                  HAPI_NodeId nodeId,
+                                  const MTime &time);
+
+    // Looks up the frame of a node. When the frame is cached, the cook can be
+    // skipped. Once start() is called, the Get calls made until the scope ends
+    // are answered from the cached frame, or recorded into a new frame.
+    class FrameScope
+    {
+    public:
+        FrameScope(HAPI_NodeId nodeId,
+                   const MTime &time,
+                   unsigned int inputGeneration);
+        ~FrameScope();
+
+        bool isActive() const;
+        bool isCached() const;
+
+        void start();
+
+        // Whether a call was not found in the cached frame. It was forwarded
+        // to HAPI, so the outputs must be computed again after a cook.
+        bool isIncomplete() const;
+
+        // Ends the scope without keeping the frame, and removes it from the
+        // cache if it was cached.
+        void discard();
+
+    private:
+        bool myIsActive;
+        bool myIsCached;
+        bool myIsStarted;
+        HAPI_NodeId myNodeId;
+        double myTime;
+        unsigned long long myStateHash;
+
+    private:
+        FrameScope(const FrameScope &);
+        FrameScope &operator=(const FrameScope &);
+    };
+};
+
+#endif
@@ -20,7 +20,9 @@
 #include <maya/MTime.h>
 
 #include "Asset.h"
+#include "AssetFrameCache.h"
 #include "AssetNode.h"
+#include "HoudiniApiTracer.h"
 #include "Input.h"
 #include "MayaTypeID.h"
 #include "util.h"
@@ -1398,6 +1400,8 @@ AssetNode::compute(const MPlug &plug, MDataBlock &data)
         return MPxTransform::compute(plug, data);
     }
 
+    HoudiniApiTracer::NodeScope traceScope(thisMObject(), "AssetNode::compute");
+
     if (Util::isPlugBelow(plug, MPlug(thisMObject(), AssetNode::output)))
     {
         // make sure asset was created properly
@@ -1448,6 +1452,31 @@ AssetNode::compute(const MPlug &plug, MDataBlock &data)
             return status;
         }
 
+        // Compute the next frames while Maya is idle during playback. Assets
+        // with inputs are left out, since computing them at another time
+        // would push the inputs of that time to Houdini.
+        if (AssetFrameCache::isEnabled())
+        {
+            MPlug inputPlug(thisMObject(), AssetNode::input);
+
+            bool hasInputs = false;
+            for (unsigned int i = 0; !hasInputs && i < inputPlug.numElements();
+                 i++)
+            {
+                MPlug elementPlug = inputPlug.elementByPhysicalIndex(i);
+                MPlug inputNodeIdPlug =
+                    elementPlug.child(AssetNode::inputNodeId);
+                hasInputs = !Util::plugSource(inputNodeIdPlug).isNull();
+            }
+
+            if (!hasInputs)
+            {
+                AssetFrameCache::scheduleCookAhead(
+                    MPlug(thisMObject(), AssetNode::outputAssetTranslateX),
+                    myAsset->getNodeInfo().id, mayaTime);
+            }
+        }
+
         if (options.autoSyncOutputs() && needToSyncOutputs)
         {
             myAutoSyncId++;
@@ -1952,16 +1981,35 @@ AssetNode::setParmValues(MDataBlock &data, bool onlyDirtyParms)
         return;
     }
 
-    MObjectVector cache  = myDirtyParmAttributes;
-    MObjectVector *attrs = &cache;
-    myDirtyParmAttributes.clear();
+#if MAYA_API_VERSION >= 20180000
+    // Maya doesn't dirty the parms in the contexts that cook ahead, so all of
+    // them are set for the other time. The dirty parms are kept for the next
+    // normal compute, which sets all of them again.
+    const bool isCookAhead = !data.context().isNormal();
+#else
+    const bool isCookAhead = false;
+#endif
 
-    if (!onlyDirtyParms || mySetAllParms)
+    MObjectVector cache;
+    MObjectVector *attrs = &cache;
+    if (isCookAhead)
     {
-        mySetAllParms = false;
+        mySetAllParms = true;
 
         attrs = NULL;
     }
+    else
+    {
+        cache = myDirtyParmAttributes;
+        myDirtyParmAttributes.clear();
+
+        if (!onlyDirtyParms || mySetAllParms)
+        {
+            mySetAllParms = false;
+
+            attrs = NULL;
+        }
+    }
     AssetNodeOptions::AccessorDataBlock options(
         assetNodeOptionsDefinition, data);
     if (options.updateParmsForEvalMode() && mySetAllParmsForEM)
@@ -2,11 +2,14 @@
 
 #include <maya/MArgDatabase.h>
 #include <maya/MArgList.h>
+#include <maya/MGlobal.h>
 #include <maya/MStatus.h>
 
 #include <HAPI/HAPI.h>
 #include <HAPI/HAPI_Version.h>
 
+#include "AssetFrameCache.h"
+#include "HoudiniApiTracer.h"
 #include "SubCommand.h"
 
 #define kLicenseFlag "-lic"
@@ -23,6 +26,24 @@
 #define kTempDirFlagLong "-makeTempDir"
 #define kSaveHIPFlag "-sh"
 #define kSaveHIPFlagLong "-saveHIP"
+#define kHapiTraceFlag "-ht"
+#define kHapiTraceFlagLong "-hapiTrace"
+#define kHapiTraceSummaryFlag "-hts"
+#define kHapiTraceSummaryFlagLong "-hapiTraceSummary"
+#define kHapiTraceWriteFlag "-htw"
+#define kHapiTraceWriteFlagLong "-hapiTraceWrite"
+#define kHapiTraceResetFlag "-htr"
+#define kHapiTraceResetFlagLong "-hapiTraceReset"
+#define kStatusCheckStatsFlag "-scs"
+#define kStatusCheckStatsFlagLong "-statusCheckStats"
+#define kStatusCheckStatsResetFlag "-scr"
+#define kStatusCheckStatsResetFlagLong "-statusCheckStatsReset"
+#define kFrameCacheFlag "-fc"
+#define kFrameCacheFlagLong "-frameCache"
+#define kFrameCacheSummaryFlag "-fcs"
+#define kFrameCacheSummaryFlagLong "-frameCacheSummary"
+#define kFrameCacheClearFlag "-fcc"
+#define kFrameCacheClearFlagLong "-frameCacheClear"
 
 const char *EngineCommand::commandName = "houdiniEngine";
 
@@ -33,7 +54,7 @@ public:
     {
         int license;
 
-        HAPI_GetSessionEnvInt(
+        HoudiniApi::GetSessionEnvInt(
             Util::theHAPISession.get(), HAPI_SESSIONENVINT_LICENSE, &license);
 
         MString version_string;
@@ -78,7 +99,7 @@ public:
 
     virtual MStatus doIt()
     {
-        HAPI_SaveHIPFile(
+        HoudiniApi::SaveHIPFile(
             Util::theHAPISession.get(), myHIPFilePath.asChar(), false);
 
         return MStatus::kSuccess;
@@ -95,9 +116,9 @@ public:
     {
         int major, minor, build;
 
-        HAPI_GetEnvInt(HAPI_ENVINT_VERSION_HOUDINI_MAJOR, &major);
-        HAPI_GetEnvInt(HAPI_ENVINT_VERSION_HOUDINI_MINOR, &minor);
-        HAPI_GetEnvInt(HAPI_ENVINT_VERSION_HOUDINI_BUILD, &build);
+        HoudiniApi::GetEnvInt(HAPI_ENVINT_VERSION_HOUDINI_MAJOR, &major);
+        HoudiniApi::GetEnvInt(HAPI_ENVINT_VERSION_HOUDINI_MINOR, &minor);
+        HoudiniApi::GetEnvInt(HAPI_ENVINT_VERSION_HOUDINI_BUILD, &build);
 
         MString version_string;
         version_string.format("^1s.^2s.^3s", MString() + major,
@@ -116,9 +137,9 @@ public:
     {
         int major, minor, api;
 
-        HAPI_GetEnvInt(HAPI_ENVINT_VERSION_HOUDINI_ENGINE_MAJOR, &major);
-        HAPI_GetEnvInt(HAPI_ENVINT_VERSION_HOUDINI_ENGINE_MINOR, &minor);
-        HAPI_GetEnvInt(HAPI_ENVINT_VERSION_HOUDINI_ENGINE_API, &api);
+        HoudiniApi::GetEnvInt(HAPI_ENVINT_VERSION_HOUDINI_ENGINE_MAJOR, &major);
+        HoudiniApi::GetEnvInt(HAPI_ENVINT_VERSION_HOUDINI_ENGINE_MINOR, &minor);
+        HoudiniApi::GetEnvInt(HAPI_ENVINT_VERSION_HOUDINI_ENGINE_API, &api);
 
         MString version_string;
         version_string.format("^1s.^2s (API: ^3s)", MString() + major,
@@ -187,6 +208,164 @@ public:
     }
 };
 
+class EngineSubCommandHapiTrace : public SubCommand
+{
+public:
+    EngineSubCommandHapiTrace(bool enable) : myEnable(enable) {}
+
+    virtual MStatus doIt()
+    {
+        if (myEnable)
+        {
+            HoudiniApiTracer::enable();
+        }
+        else
+        {
+            HoudiniApiTracer::disable();
+        }
+
+        MPxCommand::setResult(HoudiniApiTracer::isEnabled());
+
+        return MStatus::kSuccess;
+    }
+
+protected:
+    bool myEnable;
+};
+
+class EngineSubCommandHapiTraceSummary : public SubCommand
+{
+public:
+    virtual MStatus doIt()
+    {
+        MPxCommand::setResult(HoudiniApiTracer::summary());
+
+        return MStatus::kSuccess;
+    }
+};
+
+class EngineSubCommandHapiTraceWrite : public SubCommand
+{
+public:
+    EngineSubCommandHapiTraceWrite(const MString &filePath)
+        : myFilePath(filePath)
+    {
+    }
+
+    virtual MStatus doIt()
+    {
+        if (!HoudiniApiTracer::writeChromeTrace(myFilePath))
+        {
+            DISPLAY_ERROR("Error writing HAPI trace: ^1s", myFilePath);
+            return MStatus::kFailure;
+        }
+
+        MPxCommand::setResult(myFilePath);
+
+        return MStatus::kSuccess;
+    }
+
+protected:
+    MString myFilePath;
+};
+
+class EngineSubCommandHapiTraceReset : public SubCommand
+{
+public:
+    virtual MStatus doIt()
+    {
+        HoudiniApiTracer::reset();
+
+        return MStatus::kSuccess;
+    }
+};
+
+class EngineSubCommandStatusCheckStats : public SubCommand
+{
+public:
+    virtual MStatus doIt()
+    {
+        const Util::StatusCheckStats &stats = Util::statusCheckStats();
+
+        MString result;
+        result.format(
+            "cook waits: ^1s, polls: ^2s, status strings: ^3s, "
+            "total: ^4s s, polling: ^5s s, sleeping: ^6s s",
+            MString() + (double)stats.calls, MString() + (double)stats.polls,
+            MString() + (double)stats.statusStringFetches,
+            MString() + stats.totalSeconds, MString() + stats.pollSeconds,
+            MString() + stats.sleepSeconds);
+
+        MPxCommand::setResult(result);
+
+        return MStatus::kSuccess;
+    }
+};
+
+class EngineSubCommandStatusCheckStatsReset : public SubCommand
+{
+public:
+    virtual MStatus doIt()
+    {
+        Util::resetStatusCheckStats();
+
+        return MStatus::kSuccess;
+    }
+};
+
+class EngineSubCommandFrameCache : public SubCommand
+{
+public:
+    EngineSubCommandFrameCache(bool enable) : myEnable(enable) {}
+
+    virtual MStatus doIt()
+    {
+        if (myEnable)
+        {
+            const int size = MGlobal::optionVarIntValue(
+                "houdiniEngineFrameCacheSize");
+            const int cookAheadFrames = MGlobal::optionVarIntValue(
+                "houdiniEngineCookAheadFrames");
+
+            AssetFrameCache::enable(
+                (size_t)size * 1024 * 1024, cookAheadFrames);
+        }
+        else
+        {
+            AssetFrameCache::disable();
+        }
+
+        MPxCommand::setResult(AssetFrameCache::isEnabled());
+
+        return MStatus::kSuccess;
+    }
+
+protected:
+    bool myEnable;
+};
+
+class EngineSubCommandFrameCacheSummary : public SubCommand
+{
+public:
+    virtual MStatus doIt()
+    {
+        MPxCommand::setResult(AssetFrameCache::summary());
+
+        return MStatus::kSuccess;
+    }
+};
+
+class EngineSubCommandFrameCacheClear : public SubCommand
+{
+public:
+    virtual MStatus doIt()
+    {
+        AssetFrameCache::clear();
+
+        return MStatus::kSuccess;
+    }
+};
+
 void *
 EngineCommand::creator()
 {
@@ -225,6 +404,48 @@ EngineCommand::newSyntax()
     CHECK_MSTATUS(
         syntax.addFlag(kSaveHIPFlag, kSaveHIPFlagLong, MSyntax::kString));
 
+    // -hapiTrace turns the tracing of the HAPI calls on or off
+    // expected arguments: enable - whether the calls should be traced
+    CHECK_MSTATUS(
+        syntax.addFlag(kHapiTraceFlag, kHapiTraceFlagLong, MSyntax::kBoolean));
+
+    // -hapiTraceSummary returns a table of the traced calls, per function and
+    // per node
+    CHECK_MSTATUS(
+        syntax.addFlag(kHapiTraceSummaryFlag, kHapiTraceSummaryFlagLong));
+
+    // -hapiTraceWrite writes the traced calls as a Chrome trace file
+    // expected arguments: file_path - the name of the trace file to write
+    CHECK_MSTATUS(syntax.addFlag(
+        kHapiTraceWriteFlag, kHapiTraceWriteFlagLong, MSyntax::kString));
+
+    // -hapiTraceReset clears the traced calls
+    CHECK_MSTATUS(syntax.addFlag(kHapiTraceResetFlag, kHapiTraceResetFlagLong));
+
+    // -statusCheckStats returns the time spent waiting for cooks, and how much
+    // of it was spent polling the cook status
+    CHECK_MSTATUS(
+        syntax.addFlag(kStatusCheckStatsFlag, kStatusCheckStatsFlagLong));
+
+    // -statusCheckStatsReset clears the cook status polling statistics
+    CHECK_MSTATUS(syntax.addFlag(
+        kStatusCheckStatsResetFlag, kStatusCheckStatsResetFlagLong));
+
+    // -frameCache turns the cache of the cooked frames on or off, with the
+    // size and cook-ahead frames of the preferences
+    // expected arguments: enable - whether the frames should be cached
+    CHECK_MSTATUS(syntax.addFlag(
+        kFrameCacheFlag, kFrameCacheFlagLong, MSyntax::kBoolean));
+
+    // -frameCacheSummary returns the number of cached frames and bytes, and
+    // how often the frames were found in the cache
+    CHECK_MSTATUS(
+        syntax.addFlag(kFrameCacheSummaryFlag, kFrameCacheSummaryFlagLong));
+
+    // -frameCacheClear removes all the cached frames
+    CHECK_MSTATUS(
+        syntax.addFlag(kFrameCacheClearFlag, kFrameCacheClearFlagLong));
+
     return syntax;
 }
 
@@ -250,11 +471,34 @@ EngineCommand::parseArgs(const MArgList &args)
           argData.isFlagSet(kHoudiniEngineVersionFlag) ^
           argData.isFlagSet(kBuildHoudiniVersionFlag) ^
           argData.isFlagSet(kBuildHoudiniEngineVersionFlag) ^
-          argData.isFlagSet(kTempDirFlag) ^ argData.isFlagSet(kSaveHIPFlag)))
+          argData.isFlagSet(kTempDirFlag) ^ argData.isFlagSet(kSaveHIPFlag) ^
+          argData.isFlagSet(kHapiTraceFlag) ^
+          argData.isFlagSet(kHapiTraceSummaryFlag) ^
+          argData.isFlagSet(kHapiTraceWriteFlag) ^
+          argData.isFlagSet(kHapiTraceResetFlag) ^
+          argData.isFlagSet(kStatusCheckStatsFlag) ^
+          argData.isFlagSet(kStatusCheckStatsResetFlag) ^
+          argData.isFlagSet(kFrameCacheFlag) ^
+          argData.isFlagSet(kFrameCacheSummaryFlag) ^
+          argData.isFlagSet(kFrameCacheClearFlag)))
     {
-        displayError(
-            "Exactly one of these flags must be specified:\n" kSaveHIPFlagLong
-            "\n");
+        displayError("Exactly one of these flags must be specified:\n"
+                     kLicenseFlagLong "\n"
+                     kHoudiniVersionFlagLong "\n"
+                     kHoudiniEngineVersionFlagLong "\n"
+                     kBuildHoudiniVersionFlagLong "\n"
+                     kBuildHoudiniEngineVersionFlagLong "\n"
+                     kTempDirFlagLong "\n"
+                     kSaveHIPFlagLong "\n"
+                     kHapiTraceFlagLong "\n"
+                     kHapiTraceSummaryFlagLong "\n"
+                     kHapiTraceWriteFlagLong "\n"
+                     kHapiTraceResetFlagLong "\n"
+                     kStatusCheckStatsFlagLong "\n"
+                     kStatusCheckStatsResetFlagLong "\n"
+                     kFrameCacheFlagLong "\n"
+                     kFrameCacheSummaryFlagLong "\n"
+                     kFrameCacheClearFlagLong "\n");
         return MStatus::kInvalidParameter;
     }
 
@@ -303,6 +547,84 @@ EngineCommand::parseArgs(const MArgList &args)
         mySubCommand = new EngineSubCommandSaveHIPFile(hipFilePath);
     }
 
+    if (argData.isFlagSet(kHapiTraceFlag))
+    {
+        bool enable;
+        {
+            status = argData.getFlagArgument(kHapiTraceFlag, 0, enable);
+            if (!status)
+            {
+                displayError(
+                    "Invalid argument for \"" kHapiTraceFlagLong "\".");
+                return status;
+            }
+        }
+
+        mySubCommand = new EngineSubCommandHapiTrace(enable);
+    }
+
+    if (argData.isFlagSet(kHapiTraceSummaryFlag))
+    {
+        mySubCommand = new EngineSubCommandHapiTraceSummary();
+    }
+
+    if (argData.isFlagSet(kHapiTraceWriteFlag))
+    {
+        MString filePath;
+        {
+            status = argData.getFlagArgument(kHapiTraceWriteFlag, 0, filePath);
+            if (!status)
+            {
+                displayError(
+                    "Invalid argument for \"" kHapiTraceWriteFlagLong "\".");
+                return status;
+            }
+        }
+
+        mySubCommand = new EngineSubCommandHapiTraceWrite(filePath);
+    }
+
+    if (argData.isFlagSet(kHapiTraceResetFlag))
+    {
+        mySubCommand = new EngineSubCommandHapiTraceReset();
+    }
+
+    if (argData.isFlagSet(kStatusCheckStatsFlag))
+    {
+        mySubCommand = new EngineSubCommandStatusCheckStats();
+    }
+
+    if (argData.isFlagSet(kStatusCheckStatsResetFlag))
+    {
+        mySubCommand = new EngineSubCommandStatusCheckStatsReset();
+    }
+
+    if (argData.isFlagSet(kFrameCacheFlag))
+    {
+        bool enable;
+        {
+            status = argData.getFlagArgument(kFrameCacheFlag, 0, enable);
+            if (!status)
+            {
+                displayError(
+                    "Invalid argument for \"" kFrameCacheFlagLong "\".");
+                return status;
+            }
+        }
+
+        mySubCommand = new EngineSubCommandFrameCache(enable);
+    }
+
+    if (argData.isFlagSet(kFrameCacheSummaryFlag))
+    {
+        mySubCommand = new EngineSubCommandFrameCacheSummary();
+    }
+
+    if (argData.isFlagSet(kFrameCacheClearFlag))
+    {
+        mySubCommand = new EngineSubCommandFrameCacheClear();
+    }
+
     return MStatus::kSuccess;
 }
 
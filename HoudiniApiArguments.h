@@ -0,0 +1,1109 @@
+#ifndef __HoudiniApiArguments_h__
+#define __HoudiniApiArguments_h__
+
+#include <algorithm>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "HoudiniApi.h"
+#include "util.h"
+
+// Describes the HoudiniApi function table for the layers that wrap its entry
+// points, like HoudiniApiTracer, HoudiniApiRecorder and AssetFrameCache.
+
+// Every entry point of the HoudiniApi function table.
+#define HOUDINI_API_FUNCTIONS(X)                                               \
+    X(AddAttribute)                                                            \
+    X(AddGroup)                                                                \
+    X(AssetInfo_Create)                                                        \
+    X(AssetInfo_Init)                                                          \
+    X(AttributeInfo_Create)                                                    \
+    X(AttributeInfo_Init)                                                      \
+    X(BindCustomImplementation)                                                \
+    X(CancelPDGCook)                                                           \
+    X(CheckForSpecificErrors)                                                  \
+    X(Cleanup)                                                                 \
+    X(ClearConnectionError)                                                    \
+    X(CloseSession)                                                            \
+    X(CommitGeo)                                                               \
+    X(CommitWorkItems)                                                         \
+    X(CommitWorkitems)                                                         \
+    X(ComposeChildNodeList)                                                    \
+    X(ComposeNodeCookResult)                                                   \
+    X(ComposeObjectList)                                                       \
+    X(CompositorOptions_Create)                                                \
+    X(CompositorOptions_Init)                                                  \
+    X(ConnectNodeInput)                                                        \
+    X(ConvertMatrixToEuler)                                                    \
+    X(ConvertMatrixToQuat)                                                     \
+    X(ConvertTransform)                                                        \
+    X(ConvertTransformEulerToMatrix)                                           \
+    X(ConvertTransformQuatToMatrix)                                            \
+    X(CookNode)                                                                \
+    X(CookOptions_AreEqual)                                                    \
+    X(CookOptions_Create)                                                      \
+    X(CookOptions_Init)                                                        \
+    X(CookPDG)                                                                 \
+    X(CookPDGAllOutputs)                                                       \
+    X(CreateCustomSession)                                                     \
+    X(CreateHeightFieldInput)                                                  \
+    X(CreateHeightfieldInputVolumeNode)                                        \
+    X(CreateInProcessSession)                                                  \
+    X(CreateInputCurveNode)                                                    \
+    X(CreateInputNode)                                                         \
+    X(CreateNode)                                                              \
+    X(CreateThriftNamedPipeSession)                                            \
+    X(CreateThriftSharedMemorySession)                                         \
+    X(CreateThriftSocketSession)                                               \
+    X(CreateWorkItem)                                                          \
+    X(CreateWorkitem)                                                          \
+    X(CurveInfo_Create)                                                        \
+    X(CurveInfo_Init)                                                          \
+    X(DeleteAttribute)                                                         \
+    X(DeleteGroup)                                                             \
+    X(DeleteNode)                                                              \
+    X(DirtyPDGNode)                                                            \
+    X(DisconnectNodeInput)                                                     \
+    X(DisconnectNodeOutputsAt)                                                 \
+    X(ExtractImageToFile)                                                      \
+    X(ExtractImageToMemory)                                                    \
+    X(GeoInfo_Create)                                                          \
+    X(GeoInfo_GetGroupCountByType)                                             \
+    X(GeoInfo_Init)                                                            \
+    X(GetActiveCacheCount)                                                     \
+    X(GetActiveCacheNames)                                                     \
+    X(GetAssetDefinitionParmCounts)                                            \
+    X(GetAssetDefinitionParmInfos)                                             \
+    X(GetAssetDefinitionParmValues)                                            \
+    X(GetAssetInfo)                                                            \
+    X(GetAssetLibraryFilePath)                                                 \
+    X(GetAssetLibraryIds)                                                      \
+    X(GetAttributeDictionaryArrayData)                                         \
+    X(GetAttributeDictionaryArrayDataAsync)                                    \
+    X(GetAttributeDictionaryData)                                              \
+    X(GetAttributeDictionaryDataAsync)                                         \
+    X(GetAttributeFloat64ArrayData)                                            \
+    X(GetAttributeFloat64ArrayDataAsync)                                       \
+    X(GetAttributeFloat64Data)                                                 \
+    X(GetAttributeFloat64DataAsync)                                            \
+    X(GetAttributeFloatArrayData)                                              \
+    X(GetAttributeFloatArrayDataAsync)                                         \
+    X(GetAttributeFloatData)                                                   \
+    X(GetAttributeFloatDataAsync)                                              \
+    X(GetAttributeInfo)                                                        \
+    X(GetAttributeInt16ArrayData)                                              \
+    X(GetAttributeInt16ArrayDataAsync)                                         \
+    X(GetAttributeInt16Data)                                                   \
+    X(GetAttributeInt16DataAsync)                                              \
+    X(GetAttributeInt64ArrayData)                                              \
+    X(GetAttributeInt64ArrayDataAsync)                                         \
+    X(GetAttributeInt64Data)                                                   \
+    X(GetAttributeInt64DataAsync)                                              \
+    X(GetAttributeInt8ArrayData)                                               \
+    X(GetAttributeInt8ArrayDataAsync)                                          \
+    X(GetAttributeInt8Data)                                                    \
+    X(GetAttributeInt8DataAsync)                                               \
+    X(GetAttributeIntArrayData)                                                \
+    X(GetAttributeIntArrayDataAsync)                                           \
+    X(GetAttributeIntData)                                                     \
+    X(GetAttributeIntDataAsync)                                                \
+    X(GetAttributeNames)                                                       \
+    X(GetAttributeStringArrayData)                                             \
+    X(GetAttributeStringArrayDataAsync)                                        \
+    X(GetAttributeStringData)                                                  \
+    X(GetAttributeStringDataAsync)                                             \
+    X(GetAttributeUInt8ArrayData)                                              \
+    X(GetAttributeUInt8ArrayDataAsync)                                         \
+    X(GetAttributeUInt8Data)                                                   \
+    X(GetAttributeUInt8DataAsync)                                              \
+    X(GetAttributeWait)                                                        \
+    X(GetAvailableAssetCount)                                                  \
+    X(GetAvailableAssets)                                                      \
+    X(GetBoxInfo)                                                              \
+    X(GetCacheProperty)                                                        \
+    X(GetComposedChildNodeList)                                                \
+    X(GetComposedNodeCookResult)                                               \
+    X(GetComposedObjectList)                                                   \
+    X(GetComposedObjectTransforms)                                             \
+    X(GetCompositorOptions)                                                    \
+    X(GetConnectionError)                                                      \
+    X(GetConnectionErrorLength)                                                \
+    X(GetCookingCurrentCount)                                                  \
+    X(GetCookingTotalCount)                                                    \
+    X(GetCurveCounts)                                                          \
+    X(GetCurveInfo)                                                            \
+    X(GetCurveKnots)                                                           \
+    X(GetCurveOrders)                                                          \
+    X(GetDisplayGeoInfo)                                                       \
+    X(GetEdgeCountOfEdgeGroup)                                                 \
+    X(GetEnvInt)                                                               \
+    X(GetFaceCounts)                                                           \
+    X(GetFirstVolumeTile)                                                      \
+    X(GetGeoInfo)                                                              \
+    X(GetGeoSize)                                                              \
+    X(GetGroupCountOnPackedInstancePart)                                       \
+    X(GetGroupMembership)                                                      \
+    X(GetGroupMembershipOnPackedInstancePart)                                  \
+    X(GetGroupNames)                                                           \
+    X(GetGroupNamesOnPackedInstancePart)                                       \
+    X(GetHIPFileNodeCount)                                                     \
+    X(GetHIPFileNodeIds)                                                       \
+    X(GetHandleBindingInfo)                                                    \
+    X(GetHandleInfo)                                                           \
+    X(GetHeightFieldData)                                                      \
+    X(GetImageFilePath)                                                        \
+    X(GetImageInfo)                                                            \
+    X(GetImageMemoryBuffer)                                                    \
+    X(GetImagePlaneCount)                                                      \
+    X(GetImagePlanes)                                                          \
+    X(GetInputCurveInfo)                                                       \
+    X(GetInstanceTransformsOnPart)                                             \
+    X(GetInstancedObjectIds)                                                   \
+    X(GetInstancedPartIds)                                                     \
+    X(GetInstancerPartTransforms)                                              \
+    X(GetLoadedAssetLibraryCount)                                              \
+    X(GetManagerNodeId)                                                        \
+    X(GetMaterialInfo)                                                         \
+    X(GetMaterialNodeIdsOnFaces)                                               \
+    X(GetMessageNodeCount)                                                     \
+    X(GetMessageNodeIds)                                                       \
+    X(GetNextVolumeTile)                                                       \
+    X(GetNodeCookResult)                                                       \
+    X(GetNodeCookResultLength)                                                 \
+    X(GetNodeFromPath)                                                         \
+    X(GetNodeInfo)                                                             \
+    X(GetNodeInputName)                                                        \
+    X(GetNodeOutputName)                                                       \
+    X(GetNodePath)                                                             \
+    X(GetNumWorkItems)                                                         \
+    X(GetNumWorkitems)                                                         \
+    X(GetObjectInfo)                                                           \
+    X(GetObjectTransform)                                                      \
+    X(GetOutputGeoCount)                                                       \
+    X(GetOutputGeoInfos)                                                       \
+    X(GetOutputNodeId)                                                         \
+    X(GetPDGEvents)                                                            \
+    X(GetPDGGraphContextId)                                                    \
+    X(GetPDGGraphContexts)                                                     \
+    X(GetPDGGraphContextsCount)                                                \
+    X(GetPDGState)                                                             \
+    X(GetParameters)                                                           \
+    X(GetParmChoiceLists)                                                      \
+    X(GetParmExpression)                                                       \
+    X(GetParmFile)                                                             \
+    X(GetParmFloatValue)                                                       \
+    X(GetParmFloatValues)                                                      \
+    X(GetParmIdFromName)                                                       \
+    X(GetParmInfo)                                                             \
+    X(GetParmInfoFromName)                                                     \
+    X(GetParmIntValue)                                                         \
+    X(GetParmIntValues)                                                        \
+    X(GetParmNodeValue)                                                        \
+    X(GetParmStringValue)                                                      \
+    X(GetParmStringValues)                                                     \
+    X(GetParmTagName)                                                          \
+    X(GetParmTagValue)                                                         \
+    X(GetParmWithTag)                                                          \
+    X(GetPartInfo)                                                             \
+    X(GetPreset)                                                               \
+    X(GetPresetBufLength)                                                      \
+    X(GetPresetCount)                                                          \
+    X(GetPresetNames)                                                          \
+    X(GetServerEnvInt)                                                         \
+    X(GetServerEnvString)                                                      \
+    X(GetServerEnvVarCount)                                                    \
+    X(GetServerEnvVarList)                                                     \
+    X(GetSessionEnvInt)                                                        \
+    X(GetSessionSyncInfo)                                                      \
+    X(GetSphereInfo)                                                           \
+    X(GetStatus)                                                               \
+    X(GetStatusString)                                                         \
+    X(GetStatusStringBufLength)                                                \
+    X(GetString)                                                               \
+    X(GetStringBatch)                                                          \
+    X(GetStringBatchSize)                                                      \
+    X(GetStringBufLength)                                                      \
+    X(GetSupportedImageFileFormatCount)                                        \
+    X(GetSupportedImageFileFormats)                                            \
+    X(GetTime)                                                                 \
+    X(GetTimelineOptions)                                                      \
+    X(GetTotalCookCount)                                                       \
+    X(GetUseHoudiniTime)                                                       \
+    X(GetVertexList)                                                           \
+    X(GetViewport)                                                             \
+    X(GetVolumeBounds)                                                         \
+    X(GetVolumeInfo)                                                           \
+    X(GetVolumeTileFloatData)                                                  \
+    X(GetVolumeTileIntData)                                                    \
+    X(GetVolumeVisualInfo)                                                     \
+    X(GetVolumeVoxelFloatData)                                                 \
+    X(GetVolumeVoxelIntData)                                                   \
+    X(GetWorkItemAttributeSize)                                                \
+    X(GetWorkItemFloatAttribute)                                               \
+    X(GetWorkItemInfo)                                                         \
+    X(GetWorkItemIntAttribute)                                                 \
+    X(GetWorkItemOutputFiles)                                                  \
+    X(GetWorkItemStringAttribute)                                              \
+    X(GetWorkItems)                                                            \
+    X(GetWorkitemDataLength)                                                   \
+    X(GetWorkitemFloatData)                                                    \
+    X(GetWorkitemInfo)                                                         \
+    X(GetWorkitemIntData)                                                      \
+    X(GetWorkitemResultInfo)                                                   \
+    X(GetWorkitemStringData)                                                   \
+    X(GetWorkitems)                                                            \
+    X(HandleBindingInfo_Create)                                                \
+    X(HandleBindingInfo_Init)                                                  \
+    X(HandleInfo_Create)                                                       \
+    X(HandleInfo_Init)                                                         \
+    X(ImageFileFormat_Create)                                                  \
+    X(ImageFileFormat_Init)                                                    \
+    X(ImageInfo_Create)                                                        \
+    X(ImageInfo_Init)                                                          \
+    X(Initialize)                                                              \
+    X(InputCurveInfo_Create)                                                   \
+    X(InputCurveInfo_Init)                                                     \
+    X(InsertMultiparmInstance)                                                 \
+    X(Interrupt)                                                               \
+    X(IsInitialized)                                                           \
+    X(IsNodeValid)                                                             \
+    X(IsSessionValid)                                                          \
+    X(Keyframe_Create)                                                         \
+    X(Keyframe_Init)                                                           \
+    X(LoadAssetLibraryFromFile)                                                \
+    X(LoadAssetLibraryFromMemory)                                              \
+    X(LoadGeoFromFile)                                                         \
+    X(LoadGeoFromMemory)                                                       \
+    X(LoadHIPFile)                                                             \
+    X(LoadNodeFromFile)                                                        \
+    X(MaterialInfo_Create)                                                     \
+    X(MaterialInfo_Init)                                                       \
+    X(MergeHIPFile)                                                            \
+    X(NodeInfo_Create)                                                         \
+    X(NodeInfo_Init)                                                           \
+    X(ObjectInfo_Create)                                                       \
+    X(ObjectInfo_Init)                                                         \
+    X(ParmChoiceInfo_Create)                                                   \
+    X(ParmChoiceInfo_Init)                                                     \
+    X(ParmHasExpression)                                                       \
+    X(ParmHasTag)                                                              \
+    X(ParmInfo_Create)                                                         \
+    X(ParmInfo_GetFloatValueCount)                                             \
+    X(ParmInfo_GetIntValueCount)                                               \
+    X(ParmInfo_GetStringValueCount)                                            \
+    X(ParmInfo_Init)                                                           \
+    X(ParmInfo_IsFloat)                                                        \
+    X(ParmInfo_IsInt)                                                          \
+    X(ParmInfo_IsNode)                                                         \
+    X(ParmInfo_IsNonValue)                                                     \
+    X(ParmInfo_IsPath)                                                         \
+    X(ParmInfo_IsString)                                                       \
+    X(PartInfo_Create)                                                         \
+    X(PartInfo_GetAttributeCountByOwner)                                       \
+    X(PartInfo_GetElementCountByAttributeOwner)                                \
+    X(PartInfo_GetElementCountByGroupType)                                     \
+    X(PartInfo_Init)                                                           \
+    X(PausePDGCook)                                                            \
+    X(PythonThreadInterpreterLock)                                             \
+    X(QueryNodeInput)                                                          \
+    X(QueryNodeOutputConnectedCount)                                           \
+    X(QueryNodeOutputConnectedNodes)                                           \
+    X(RemoveCustomString)                                                      \
+    X(RemoveMultiparmInstance)                                                 \
+    X(RemoveParmExpression)                                                    \
+    X(RenameNode)                                                              \
+    X(RenderCOPToImage)                                                        \
+    X(RenderTextureToImage)                                                    \
+    X(ResetSimulation)                                                         \
+    X(RevertGeo)                                                               \
+    X(RevertParmToDefault)                                                     \
+    X(RevertParmToDefaults)                                                    \
+    X(SaveGeoToFile)                                                           \
+    X(SaveGeoToMemory)                                                         \
+    X(SaveHIPFile)                                                             \
+    X(SaveNodeToFile)                                                          \
+    X(SessionInfo_Create)                                                      \
+    X(SessionInfo_Init)                                                        \
+    X(SessionSyncInfo_Create)                                                  \
+    X(SetAnimCurve)                                                            \
+    X(SetAttributeDictionaryArrayData)                                         \
+    X(SetAttributeDictionaryData)                                              \
+    X(SetAttributeFloat64ArrayData)                                            \
+    X(SetAttributeFloat64Data)                                                 \
+    X(SetAttributeFloat64UniqueData)                                           \
+    X(SetAttributeFloatArrayData)                                              \
+    X(SetAttributeFloatData)                                                   \
+    X(SetAttributeFloatUniqueData)                                             \
+    X(SetAttributeIndexedStringData)                                           \
+    X(SetAttributeInt16ArrayData)                                              \
+    X(SetAttributeInt16Data)                                                   \
+    X(SetAttributeInt16UniqueData)                                             \
+    X(SetAttributeInt64ArrayData)                                              \
+    X(SetAttributeInt64Data)                                                   \
+    X(SetAttributeInt64UniqueData)                                             \
+    X(SetAttributeInt8ArrayData)                                               \
+    X(SetAttributeInt8Data)                                                    \
+    X(SetAttributeInt8UniqueData)                                              \
+    X(SetAttributeIntArrayData)                                                \
+    X(SetAttributeIntData)                                                     \
+    X(SetAttributeIntUniqueData)                                               \
+    X(SetAttributeStringArrayData)                                             \
+    X(SetAttributeStringData)                                                  \
+    X(SetAttributeStringUniqueData)                                            \
+    X(SetAttributeUInt8ArrayData)                                              \
+    X(SetAttributeUInt8Data)                                                   \
+    X(SetAttributeUInt8UniqueData)                                             \
+    X(SetCacheProperty)                                                        \
+    X(SetCompositorOptions)                                                    \
+    X(SetCurveCounts)                                                          \
+    X(SetCurveInfo)                                                            \
+    X(SetCurveKnots)                                                           \
+    X(SetCurveOrders)                                                          \
+    X(SetCustomString)                                                         \
+    X(SetFaceCounts)                                                           \
+    X(SetGroupMembership)                                                      \
+    X(SetHeightFieldData)                                                      \
+    X(SetImageInfo)                                                            \
+    X(SetInputCurveInfo)                                                       \
+    X(SetInputCurvePositions)                                                  \
+    X(SetInputCurvePositionsRotationsScales)                                   \
+    X(SetNodeDisplay)                                                          \
+    X(SetObjectTransform)                                                      \
+    X(SetParmExpression)                                                       \
+    X(SetParmFloatValue)                                                       \
+    X(SetParmFloatValues)                                                      \
+    X(SetParmIntValue)                                                         \
+    X(SetParmIntValues)                                                        \
+    X(SetParmNodeValue)                                                        \
+    X(SetParmStringValue)                                                      \
+    X(SetPartInfo)                                                             \
+    X(SetPreset)                                                               \
+    X(SetServerEnvInt)                                                         \
+    X(SetServerEnvString)                                                      \
+    X(SetSessionSync)                                                          \
+    X(SetSessionSyncInfo)                                                      \
+    X(SetTime)                                                                 \
+    X(SetTimelineOptions)                                                      \
+    X(SetTransformAnimCurve)                                                   \
+    X(SetUseHoudiniTime)                                                       \
+    X(SetVertexList)                                                           \
+    X(SetViewport)                                                             \
+    X(SetVolumeInfo)                                                           \
+    X(SetVolumeTileFloatData)                                                  \
+    X(SetVolumeTileIntData)                                                    \
+    X(SetVolumeVoxelFloatData)                                                 \
+    X(SetVolumeVoxelIntData)                                                   \
+    X(SetWorkItemFloatAttribute)                                               \
+    X(SetWorkItemIntAttribute)                                                 \
+    X(SetWorkItemStringAttribute)                                              \
+    X(SetWorkitemFloatData)                                                    \
+    X(SetWorkitemIntData)                                                      \
+    X(SetWorkitemStringData)                                                   \
+    X(Shutdown)                                                                \
+    X(StartThriftNamedPipeServer)                                              \
+    X(StartThriftSharedMemoryServer)                                           \
+    X(StartThriftSocketServer)                                                 \
+    X(ThriftServerOptions_Create)                                              \
+    X(ThriftServerOptions_Init)                                                \
+    X(TimelineOptions_Create)                                                  \
+    X(TimelineOptions_Init)                                                    \
+    X(TransformEuler_Create)                                                   \
+    X(TransformEuler_Init)                                                     \
+    X(Transform_Create)                                                        \
+    X(Transform_Init)                                                          \
+    X(Viewport_Create)                                                         \
+    X(VolumeInfo_Create)                                                       \
+    X(VolumeInfo_Init)                                                         \
+    X(VolumeTileInfo_Create)                                                   \
+    X(VolumeTileInfo_Init)
+// Pointer arguments that point to more than one element. ARRAY gives the index
+// of the argument holding the element count. ATTRIBUTE arrays have
+// attr_info->tupleSize values per element, and STRIDED ones are laid out with
+// the stride argument. FIXED arrays always have the same count. The data
+// arrays of the Async functions are only filled when the job completes, so
+// they are not described.
+#define HOUDINI_API_ARRAY_ARGUMENTS(ARRAY, ATTRIBUTE, STRIDED, FIXED)          \
+    FIXED(ConvertMatrixToEuler, 1, 16)                                         \
+    FIXED(ConvertMatrixToQuat, 1, 16)                                          \
+    FIXED(ConvertTransformEulerToMatrix, 2, 16)                                \
+    FIXED(ConvertTransformQuatToMatrix, 2, 16)                                 \
+    ARRAY(GetActiveCacheNames, 1, 2)                                           \
+    ARRAY(GetAssetDefinitionParmInfos, 3, 5)                                   \
+    ARRAY(GetAssetDefinitionParmValues, 3, 5)                                  \
+    ARRAY(GetAssetDefinitionParmValues, 6, 8)                                  \
+    ARRAY(GetAssetDefinitionParmValues, 10, 12)                                \
+    ARRAY(GetAssetDefinitionParmValues, 13, 15)                                \
+    ARRAY(GetAssetLibraryIds, 1, 3)                                            \
+    ARRAY(GetAttributeDictionaryArrayData, 5, 6)                               \
+    ARRAY(GetAttributeDictionaryArrayData, 7, 9)                               \
+    FIXED(GetAttributeDictionaryArrayDataAsync, 5, 0)                          \
+    FIXED(GetAttributeDictionaryArrayDataAsync, 7, 0)                          \
+    ATTRIBUTE(GetAttributeDictionaryData, 5, 7)                                \
+    FIXED(GetAttributeDictionaryDataAsync, 6, 0)                               \
+    ARRAY(GetAttributeFloat64ArrayData, 5, 6)                                  \
+    ARRAY(GetAttributeFloat64ArrayData, 7, 9)                                  \
+    FIXED(GetAttributeFloat64ArrayDataAsync, 5, 0)                             \
+    FIXED(GetAttributeFloat64ArrayDataAsync, 7, 0)                             \
+    STRIDED(GetAttributeFloat64Data, 6, 8, 5)                                  \
+    FIXED(GetAttributeFloat64DataAsync, 6, 0)                                  \
+    ARRAY(GetAttributeFloatArrayData, 5, 6)                                    \
+    ARRAY(GetAttributeFloatArrayData, 7, 9)                                    \
+    FIXED(GetAttributeFloatArrayDataAsync, 5, 0)                               \
+    FIXED(GetAttributeFloatArrayDataAsync, 7, 0)                               \
+    STRIDED(GetAttributeFloatData, 6, 8, 5)                                    \
+    FIXED(GetAttributeFloatDataAsync, 6, 0)                                    \
+    ARRAY(GetAttributeInt16ArrayData, 5, 6)                                    \
+    ARRAY(GetAttributeInt16ArrayData, 7, 9)                                    \
+    FIXED(GetAttributeInt16ArrayDataAsync, 5, 0)                               \
+    FIXED(GetAttributeInt16ArrayDataAsync, 7, 0)                               \
+    STRIDED(GetAttributeInt16Data, 6, 8, 5)                                    \
+    FIXED(GetAttributeInt16DataAsync, 6, 0)                                    \
+    ARRAY(GetAttributeInt64ArrayData, 5, 6)                                    \
+    ARRAY(GetAttributeInt64ArrayData, 7, 9)                                    \
+    FIXED(GetAttributeInt64ArrayDataAsync, 5, 0)                               \
+    FIXED(GetAttributeInt64ArrayDataAsync, 7, 0)                               \
+    STRIDED(GetAttributeInt64Data, 6, 8, 5)                                    \
+    FIXED(GetAttributeInt64DataAsync, 6, 0)                                    \
+    ARRAY(GetAttributeInt8ArrayData, 5, 6)                                     \
+    ARRAY(GetAttributeInt8ArrayData, 7, 9)                                     \
+    FIXED(GetAttributeInt8ArrayDataAsync, 5, 0)                                \
+    FIXED(GetAttributeInt8ArrayDataAsync, 7, 0)                                \
+    STRIDED(GetAttributeInt8Data, 6, 8, 5)                                     \
+    FIXED(GetAttributeInt8DataAsync, 6, 0)                                     \
+    ARRAY(GetAttributeIntArrayData, 5, 6)                                      \
+    ARRAY(GetAttributeIntArrayData, 7, 9)                                      \
+    FIXED(GetAttributeIntArrayDataAsync, 5, 0)                                 \
+    FIXED(GetAttributeIntArrayDataAsync, 7, 0)                                 \
+    STRIDED(GetAttributeIntData, 6, 8, 5)                                      \
+    FIXED(GetAttributeIntDataAsync, 6, 0)                                      \
+    ARRAY(GetAttributeNames, 4, 5)                                             \
+    ARRAY(GetAttributeStringArrayData, 5, 6)                                   \
+    ARRAY(GetAttributeStringArrayData, 7, 9)                                   \
+    FIXED(GetAttributeStringArrayDataAsync, 5, 0)                              \
+    FIXED(GetAttributeStringArrayDataAsync, 7, 0)                              \
+    ATTRIBUTE(GetAttributeStringData, 5, 7)                                    \
+    FIXED(GetAttributeStringDataAsync, 6, 0)                                   \
+    ARRAY(GetAttributeUInt8ArrayData, 5, 6)                                    \
+    ARRAY(GetAttributeUInt8ArrayData, 7, 9)                                    \
+    FIXED(GetAttributeUInt8ArrayDataAsync, 5, 0)                               \
+    FIXED(GetAttributeUInt8ArrayDataAsync, 7, 0)                               \
+    STRIDED(GetAttributeUInt8Data, 6, 8, 5)                                    \
+    FIXED(GetAttributeUInt8DataAsync, 6, 0)                                    \
+    ARRAY(GetAvailableAssets, 2, 3)                                            \
+    ARRAY(GetComposedChildNodeList, 2, 3)                                      \
+    ARRAY(GetComposedNodeCookResult, 1, 2)                                     \
+    ARRAY(GetComposedObjectList, 2, 4)                                         \
+    ARRAY(GetComposedObjectTransforms, 3, 5)                                   \
+    ARRAY(GetConnectionError, 0, 1)                                            \
+    ARRAY(GetCurveCounts, 3, 5)                                                \
+    ARRAY(GetCurveKnots, 3, 5)                                                 \
+    ARRAY(GetCurveOrders, 3, 5)                                                \
+    ARRAY(GetFaceCounts, 3, 5)                                                 \
+    ARRAY(GetGroupMembership, 6, 8)                                            \
+    ARRAY(GetGroupMembershipOnPackedInstancePart, 6, 8)                        \
+    ARRAY(GetGroupNames, 3, 4)                                                 \
+    ARRAY(GetGroupNamesOnPackedInstancePart, 4, 5)                             \
+    ARRAY(GetHIPFileNodeIds, 2, 3)                                             \
+    ARRAY(GetHandleBindingInfo, 3, 5)                                          \
+    ARRAY(GetHandleInfo, 2, 4)                                                 \
+    ARRAY(GetHeightFieldData, 3, 5)                                            \
+    ARRAY(GetImageMemoryBuffer, 2, 3)                                          \
+    ARRAY(GetImagePlanes, 2, 3)                                                \
+    ARRAY(GetInstanceTransformsOnPart, 4, 6)                                   \
+    ARRAY(GetInstancedObjectIds, 2, 4)                                         \
+    ARRAY(GetInstancedPartIds, 3, 5)                                           \
+    ARRAY(GetInstancerPartTransforms, 4, 6)                                    \
+    ARRAY(GetMaterialNodeIdsOnFaces, 4, 6)                                     \
+    ARRAY(GetMessageNodeIds, 2, 3)                                             \
+    ARRAY(GetNodeCookResult, 1, 2)                                             \
+    ARRAY(GetOutputGeoInfos, 2, 3)                                             \
+    ARRAY(GetPDGEvents, 2, 3)                                                  \
+    ARRAY(GetPDGGraphContexts, 1, 4)                                           \
+    ARRAY(GetPDGGraphContexts, 2, 4)                                           \
+    ARRAY(GetParameters, 2, 4)                                                 \
+    ARRAY(GetParmChoiceLists, 2, 4)                                            \
+    ARRAY(GetParmFloatValues, 2, 4)                                            \
+    ARRAY(GetParmIntValues, 2, 4)                                              \
+    ARRAY(GetParmStringValues, 3, 5)                                           \
+    ARRAY(GetPreset, 2, 3)                                                     \
+    ARRAY(GetPresetNames, 3, 4)                                                \
+    ARRAY(GetServerEnvVarList, 1, 3)                                           \
+    ARRAY(GetStatusString, 2, 3)                                               \
+    ARRAY(GetString, 2, 3)                                                     \
+    ARRAY(GetStringBatch, 1, 2)                                                \
+    ARRAY(GetStringBatchSize, 1, 2)                                            \
+    ARRAY(GetSupportedImageFileFormats, 1, 2)                                  \
+    ARRAY(GetVertexList, 3, 5)                                                 \
+    ARRAY(GetVolumeTileFloatData, 5, 6)                                        \
+    ARRAY(GetVolumeTileIntData, 5, 6)                                          \
+    ARRAY(GetVolumeVoxelFloatData, 6, 7)                                       \
+    ARRAY(GetVolumeVoxelIntData, 6, 7)                                         \
+    ARRAY(GetWorkItemFloatAttribute, 4, 5)                                     \
+    ARRAY(GetWorkItemIntAttribute, 4, 5)                                       \
+    ARRAY(GetWorkItemOutputFiles, 3, 4)                                        \
+    ARRAY(GetWorkItemStringAttribute, 4, 5)                                    \
+    ARRAY(GetWorkItems, 2, 3)                                                  \
+    ARRAY(GetWorkitemFloatData, 4, 5)                                          \
+    ARRAY(GetWorkitemIntData, 4, 5)                                            \
+    ARRAY(GetWorkitemResultInfo, 3, 4)                                         \
+    ARRAY(GetWorkitemStringData, 4, 5)                                         \
+    ARRAY(GetWorkitems, 2, 3)                                                  \
+    ARRAY(QueryNodeOutputConnectedNodes, 5, 7)                                 \
+    ARRAY(SaveGeoToMemory, 2, 3)                                               \
+    ARRAY(SetAnimCurve, 4, 5)                                                  \
+    ARRAY(SetAttributeDictionaryArrayData, 5, 6)                               \
+    ARRAY(SetAttributeDictionaryArrayData, 7, 9)                               \
+    ATTRIBUTE(SetAttributeDictionaryData, 5, 7)                                \
+    ARRAY(SetAttributeFloat64ArrayData, 5, 6)                                  \
+    ARRAY(SetAttributeFloat64ArrayData, 7, 9)                                  \
+    ATTRIBUTE(SetAttributeFloat64Data, 5, 7)                                   \
+    ARRAY(SetAttributeFloat64UniqueData, 5, 6)                                 \
+    ARRAY(SetAttributeFloatArrayData, 5, 6)                                    \
+    ARRAY(SetAttributeFloatArrayData, 7, 9)                                    \
+    ATTRIBUTE(SetAttributeFloatData, 5, 7)                                     \
+    ARRAY(SetAttributeFloatUniqueData, 5, 6)                                   \
+    ARRAY(SetAttributeIndexedStringData, 5, 6)                                 \
+    ARRAY(SetAttributeIndexedStringData, 7, 9)                                 \
+    ARRAY(SetAttributeInt16ArrayData, 5, 6)                                    \
+    ARRAY(SetAttributeInt16ArrayData, 7, 9)                                    \
+    ATTRIBUTE(SetAttributeInt16Data, 5, 7)                                     \
+    ARRAY(SetAttributeInt16UniqueData, 5, 6)                                   \
+    ARRAY(SetAttributeInt64ArrayData, 5, 6)                                    \
+    ARRAY(SetAttributeInt64ArrayData, 7, 9)                                    \
+    ATTRIBUTE(SetAttributeInt64Data, 5, 7)                                     \
+    ARRAY(SetAttributeInt64UniqueData, 5, 6)                                   \
+    ARRAY(SetAttributeInt8ArrayData, 5, 6)                                     \
+    ARRAY(SetAttributeInt8ArrayData, 7, 9)                                     \
+    ATTRIBUTE(SetAttributeInt8Data, 5, 7)                                      \
+    ARRAY(SetAttributeInt8UniqueData, 5, 6)                                    \
+    ARRAY(SetAttributeIntArrayData, 5, 6)                                      \
+    ARRAY(SetAttributeIntArrayData, 7, 9)                                      \
+    ATTRIBUTE(SetAttributeIntData, 5, 7)                                       \
+    ARRAY(SetAttributeIntUniqueData, 5, 6)                                     \
+    ARRAY(SetAttributeStringArrayData, 5, 6)                                   \
+    ARRAY(SetAttributeStringArrayData, 7, 9)                                   \
+    ATTRIBUTE(SetAttributeStringData, 5, 7)                                    \
+    ARRAY(SetAttributeUInt8ArrayData, 5, 6)                                    \
+    ARRAY(SetAttributeUInt8ArrayData, 7, 9)                                    \
+    ATTRIBUTE(SetAttributeUInt8Data, 5, 7)                                     \
+    ARRAY(SetAttributeUInt8UniqueData, 5, 6)                                   \
+    ARRAY(SetCurveCounts, 3, 5)                                                \
+    ARRAY(SetCurveKnots, 3, 5)                                                 \
+    ARRAY(SetCurveOrders, 3, 5)                                                \
+    ARRAY(SetFaceCounts, 3, 5)                                                 \
+    ARRAY(SetGroupMembership, 5, 7)                                            \
+    ARRAY(SetHeightFieldData, 4, 6)                                            \
+    ARRAY(SetInputCurvePositions, 3, 5)                                        \
+    ARRAY(SetInputCurvePositionsRotationsScales, 3, 5)                         \
+    ARRAY(SetInputCurvePositionsRotationsScales, 6, 8)                         \
+    ARRAY(SetInputCurvePositionsRotationsScales, 9, 11)                        \
+    ARRAY(SetParmFloatValues, 2, 4)                                            \
+    ARRAY(SetParmIntValues, 2, 4)                                              \
+    ARRAY(SetTransformAnimCurve, 3, 4)                                         \
+    ARRAY(SetVertexList, 3, 5)                                                 \
+    ARRAY(SetVolumeTileFloatData, 4, 5)                                        \
+    ARRAY(SetVolumeTileIntData, 4, 5)                                          \
+    ARRAY(SetVolumeVoxelFloatData, 6, 7)                                       \
+    ARRAY(SetVolumeVoxelIntData, 6, 7)                                         \
+    ARRAY(SetWorkItemFloatAttribute, 4, 5)                                     \
+    ARRAY(SetWorkItemIntAttribute, 4, 5)                                       \
+    ARRAY(SetWorkitemFloatData, 4, 5)                                          \
+    ARRAY(SetWorkitemIntData, 4, 5)
+
+namespace HoudiniApiArguments
+{
+// Number of elements pointed to by the argument at Index.
+template <typename FuncPtr, FuncPtr *Slot, size_t Index>
+struct ElementCount
+{
+    template <typename Tuple>
+    static int get(const Tuple &)
+    {
+        return 1;
+    }
+};
+
+inline int
+attributeElementCount(const HAPI_AttributeInfo *attrInfo,
+                      int stride,
+                      int length)
+{
+    if (!attrInfo || length <= 0)
+        return 0;
+
+    const int tupleSize = (std::max)(attrInfo->tupleSize, 1);
+    if (stride <= 0)
+        return length * tupleSize;
+
+    return (length - 1) * stride + tupleSize;
+}
+
+#define HOUDINI_API_ELEMENT_COUNT(name, index, count)                          \
+    template <>                                                                \
+    struct ElementCount<HoudiniApi::name##FuncPtr, &HoudiniApi::name, index>   \
+    {                                                                          \
+        template <typename Tuple>                                              \
+        static int get(const Tuple &args)                                      \
+        {                                                                      \
+            return count;                                                      \
+        }                                                                      \
+    };
+#define HOUDINI_API_ARRAY(name, index, lengthIndex)                            \
+    HOUDINI_API_ELEMENT_COUNT(name, index, std::get<lengthIndex>(args))
+#define HOUDINI_API_ATTRIBUTE(name, index, lengthIndex)                        \
+    HOUDINI_API_ELEMENT_COUNT(                                                 \
+        name, index,                                                           \
+        attributeElementCount(                                                 \
+            std::get<4>(args), -1, std::get<lengthIndex>(args)))
+#define HOUDINI_API_STRIDED(name, index, lengthIndex, strideIndex)             \
+    HOUDINI_API_ELEMENT_COUNT(                                                 \
+        name, index,                                                           \
+        attributeElementCount(std::get<4>(args), std::get<strideIndex>(args),  \
+                              std::get<lengthIndex>(args)))
+#define HOUDINI_API_FIXED(name, index, count)                                  \
+    HOUDINI_API_ELEMENT_COUNT(name, index, ((void)args, count))
+
+HOUDINI_API_ARRAY_ARGUMENTS(HOUDINI_API_ARRAY,
+                            HOUDINI_API_ATTRIBUTE,
+                            HOUDINI_API_STRIDED,
+                            HOUDINI_API_FIXED)
+
+#undef HOUDINI_API_ELEMENT_COUNT
+#undef HOUDINI_API_ARRAY
+#undef HOUDINI_API_ATTRIBUTE
+#undef HOUDINI_API_STRIDED
+#undef HOUDINI_API_FIXED
+
+template <typename FuncPtr,
+          FuncPtr *Slot,
+          typename Visitor,
+          typename Tuple,
+          size_t... Index>
+void
+visit(Visitor &visitor, const Tuple &args, std::index_sequence<Index...>)
+{
+    int expand[] = {
+        0, (visitor(std::get<Index>(args),
+                    ElementCount<FuncPtr, Slot, Index>::get(args)),
+            0)...};
+    (void)expand;
+}
+
+// Calls visitor(argument, elementCount) for each argument of a call.
+template <typename FuncPtr, FuncPtr *Slot, typename Visitor, typename... Args>
+void
+visit(Visitor &visitor, Args &... args)
+{
+    visit<FuncPtr, Slot>(visitor, std::forward_as_tuple(args...),
+                         std::index_sequence_for<Args...>());
+}
+
+class ByteWriter
+{
+public:
+    void clear() { myBytes.clear(); }
+
+    void write(const void *data, size_t size)
+    {
+        const char *bytes = static_cast<const char *>(data);
+        myBytes.insert(myBytes.end(), bytes, bytes + size);
+    }
+
+    template <typename T>
+    void write(const T &value)
+    {
+        write(&value, sizeof(T));
+    }
+
+    const char *data() const { return myBytes.data(); }
+    size_t size() const { return myBytes.size(); }
+    const std::vector<char> &bytes() const { return myBytes; }
+
+private:
+    std::vector<char> myBytes;
+};
+
+class ByteReader
+{
+public:
+    ByteReader(const std::vector<char> &bytes, size_t position)
+        : myBytes(bytes), myPosition(position)
+    {
+    }
+
+    // Returns NULL if there are not enough bytes left.
+    const char *skip(size_t size)
+    {
+        if (size > myBytes.size() - myPosition)
+            return NULL;
+
+        const char *data = myBytes.data() + myPosition;
+        myPosition += size;
+        return data;
+    }
+
+    bool read(void *data, size_t size)
+    {
+        const char *bytes = skip(size);
+        if (!bytes)
+            return false;
+
+        memcpy(data, bytes, size);
+        return true;
+    }
+
+    template <typename T>
+    bool read(T &value)
+    {
+        return read(&value, sizeof(T));
+    }
+
+    size_t position() const { return myPosition; }
+
+private:
+    const std::vector<char> &myBytes;
+    size_t myPosition;
+};
+
+template <typename T>
+struct IsOutput
+    : std::integral_constant<bool,
+                             !std::is_const<T>::value &&
+                                 !std::is_pointer<T>::value &&
+                                 !std::is_void<T>::value>
+{
+};
+
+template <typename T>
+struct IsHashedInput
+    : std::integral_constant<bool,
+                             std::is_const<T>::value &&
+                                 std::is_arithmetic<T>::value>
+{
+};
+
+// Serializes the input arguments of a call. Scalars and strings are written as
+// is. Arrays of numbers are hashed. Structs are skipped since their padding is
+// not initialized.
+class ArgumentWriter
+{
+public:
+    ArgumentWriter(ByteWriter &writer) : myWriter(writer) {}
+
+    template <typename T>
+    void operator()(const T &value, int)
+    {
+        static_assert(std::is_scalar<T>::value,
+                      "HAPI arguments are expected to be scalars");
+        myWriter.write(value);
+    }
+
+    template <typename T>
+    void operator()(T *const &data, int count)
+    {
+        writeArray(data, count, IsHashedInput<T>());
+    }
+
+    void operator()(const char *const &str, int)
+    {
+        if (!str)
+        {
+            myWriter.write(~0u);
+            return;
+        }
+
+        const unsigned int length = static_cast<unsigned int>(strlen(str));
+        myWriter.write(length);
+        myWriter.write(str, length);
+    }
+
+    void operator()(const char **const &strs, int count)
+    {
+        unsigned long long hash = Util::hashSeed;
+        for (int i = 0; strs && i < count; i++)
+        {
+            if (strs[i])
+                hash = Util::hashBytes(hash, strs[i], strlen(strs[i]) + 1);
+        }
+
+        myWriter.write(hash);
+    }
+
+private:
+    template <typename T>
+    void writeArray(const T *data, int count, std::true_type)
+    {
+        const size_t size = data && count > 0 ? count * sizeof(T) : 0;
+        myWriter.write(Util::hashBytes(Util::hashSeed, data, size));
+    }
+
+    template <typename T>
+    void writeArray(T *, int, std::false_type)
+    {
+    }
+
+private:
+    ByteWriter &myWriter;
+};
+
+// Writes the data of the output arguments after the call.
+class OutputWriter
+{
+public:
+    OutputWriter(ByteWriter &writer) : myWriter(writer) {}
+
+    template <typename T>
+    void operator()(const T &, int)
+    {
+    }
+
+    template <typename T>
+    void operator()(T *const &data, int count)
+    {
+        write(data, count, IsOutput<T>());
+    }
+
+private:
+    template <typename T>
+    void write(T *data, int count, std::true_type)
+    {
+        const unsigned int size = data && count > 0 ? count * sizeof(T) : 0;
+        myWriter.write(size);
+        myWriter.write(data, size);
+    }
+
+    template <typename T>
+    void write(T *, int, std::false_type)
+    {
+    }
+
+private:
+    ByteWriter &myWriter;
+};
+
+// Fills in the output arguments from the log.
+class OutputReader
+{
+public:
+    OutputReader(ByteReader &reader)
+        : myReader(reader), myIsValid(true), myIsMatching(true)
+    {
+    }
+
+    template <typename T>
+    void operator()(const T &, int)
+    {
+    }
+
+    template <typename T>
+    void operator()(T *const &data, int count)
+    {
+        read(data, count, IsOutput<T>());
+    }
+
+    bool isValid() const { return myIsValid; }
+    bool isMatching() const { return myIsMatching; }
+
+private:
+    template <typename T>
+    void read(T *data, int count, std::true_type)
+    {
+        unsigned int size = 0;
+        const char *bytes = NULL;
+        if (!myIsValid || !myReader.read(size) || !(bytes = myReader.skip(size)))
+        {
+            myIsValid = false;
+            return;
+        }
+
+        const size_t capacity = data && count > 0 ? count * sizeof(T) : 0;
+        if (size != capacity)
+        {
+            myIsMatching = false;
+        }
+
+        memcpy(data, bytes, std::min<size_t>(size, capacity));
+    }
+
+    template <typename T>
+    void read(T *, int, std::false_type)
+    {
+    }
+
+private:
+    ByteReader &myReader;
+    bool myIsValid;
+    bool myIsMatching;
+};
+
+template <typename R>
+inline R
+failureValue()
+{
+    return R();
+}
+
+template <>
+inline HAPI_Result
+failureValue<HAPI_Result>()
+{
+    return HAPI_RESULT_FAILURE;
+}
+
+// Holds the return value of a call, which is the failure value until the call
+// is made or read from the log.
+template <typename R>
+class ReturnValue
+{
+public:
+    ReturnValue() : myValue(failureValue<R>()) {}
+
+    template <typename Call>
+    void call(Call call)
+    {
+        myValue = call();
+    }
+
+    void write(ByteWriter &writer) const { writer.write(myValue); }
+    bool read(ByteReader &reader) { return reader.read(myValue); }
+
+    R get() const { return myValue; }
+
+private:
+    R myValue;
+};
+
+template <>
+class ReturnValue<void>
+{
+public:
+    template <typename Call>
+    void call(Call call)
+    {
+        call();
+    }
+
+    void write(ByteWriter &) const {}
+    bool read(ByteReader &) { return true; }
+
+    void get() const {}
+};
+
+// The layers that can wrap an entry of the function table, from the innermost
+// to the outermost. The order is fixed, so enabling and disabling the layers
+// in any sequence always leads to the same chain. The recorder is the closest
+// to Houdini Engine, so that a replay stands in for it. The frame cache answers
+// above it, and the tracer measures every call the plugin makes.
+enum Layer
+{
+    LayerRecorder,
+    LayerFrameCache,
+    LayerTracer
+};
+
+// The chain of layers installed in one slot of the function table. It is
+// rebuilt whenever a layer is added or removed, so that every layer calls the
+// next enabled one.
+template <typename FuncPtr, FuncPtr *Slot>
+class SlotChain
+{
+public:
+    static void add(Layer layer, FuncPtr call, FuncPtr *next)
+    {
+        updateBase();
+
+        typename std::vector<Entry>::iterator it = theEntries.begin();
+        while (it != theEntries.end() && it->layer < layer)
+            ++it;
+
+        if (it != theEntries.end() && it->layer == layer)
+            return;
+
+        Entry entry = {layer, call, next};
+        theEntries.insert(it, entry);
+
+        rebuild();
+    }
+
+    static void remove(Layer layer)
+    {
+        updateBase();
+
+        for (typename std::vector<Entry>::iterator it = theEntries.begin();
+             it != theEntries.end(); ++it)
+        {
+            if (it->layer == layer)
+            {
+                theEntries.erase(it);
+                break;
+            }
+        }
+
+        rebuild();
+    }
+
+private:
+    struct Entry
+    {
+        Layer layer;
+        FuncPtr call;
+        FuncPtr *next;
+    };
+
+    // The slot holds the original entry point when no layer is installed, and
+    // the outermost layer otherwise. Anything else means that the table was
+    // filled again, which becomes the new original.
+    static void updateBase()
+    {
+        if (theEntries.empty() || *Slot != theEntries.back().call)
+            theBase = *Slot;
+    }
+
+    static void rebuild()
+    {
+        FuncPtr entryPoint = theBase;
+        for (size_t i = 0; i < theEntries.size(); i++)
+        {
+            *theEntries[i].next = entryPoint;
+            entryPoint          = theEntries[i].call;
+        }
+
+        *Slot = entryPoint;
+    }
+
+    static std::vector<Entry> theEntries;
+    static FuncPtr theBase;
+};
+
+template <typename FuncPtr, FuncPtr *Slot>
+std::vector<typename SlotChain<FuncPtr, Slot>::Entry>
+    SlotChain<FuncPtr, Slot>::theEntries;
+
+template <typename FuncPtr, FuncPtr *Slot>
+FuncPtr SlotChain<FuncPtr, Slot>::theBase = NULL;
+
+// Base for the wrappers that replace an entry of the function table. Wrapper
+// provides the static call() that is installed in the slot, at the position of
+// TheLayer in the chain. theOriginal is the next entry point of the chain,
+// which is the original one when no layer is installed below.
+template <typename FuncPtr, FuncPtr *Slot, typename Wrapper, Layer TheLayer>
+struct SlotWrapper
+{
+    static void install()
+    {
+        SlotChain<FuncPtr, Slot>::add(TheLayer, &Wrapper::call, &theOriginal);
+    }
+
+    static void uninstall() { SlotChain<FuncPtr, Slot>::remove(TheLayer); }
+
+    static FuncPtr theOriginal;
+};
+
+template <typename FuncPtr, FuncPtr *Slot, typename Wrapper, Layer TheLayer>
+FuncPtr SlotWrapper<FuncPtr, Slot, Wrapper, TheLayer>::theOriginal = NULL;
+}
+
+#endif
@@ -0,0 +1,378 @@
+#include "HoudiniApiRecorder.h"
+
+#include <HAPI/HAPI_Version.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "HoudiniApiArguments.h"
+#include "util.h"
+
+namespace
+{
+using namespace HoudiniApiArguments;
+
+// Layout of the log:
+//   header:   magic, format version, HAPI version, count and names of the
+//             functions in the order of HOUDINI_API_FUNCTIONS
+//   per call: function index (uint16), size and bytes of the arguments
+//             (uint32 + bytes), return value, and for each output argument
+//             the size and bytes of the data that was written (uint32 + bytes)
+const char theMagic[8]            = "HAPIREC";
+const unsigned int theVersion     = 2;
+const unsigned int theApiVersion  = HAPI_VERSION_HOUDINI_ENGINE_MAJOR * 10000 +
+                                   HAPI_VERSION_HOUDINI_ENGINE_MINOR * 100 +
+                                   HAPI_VERSION_HOUDINI_ENGINE_API;
+const unsigned int theMaxWarnings = 10;
+
+#define HOUDINI_API_NAME(name) #name,
+const char *theFunctionNames[] = {HOUDINI_API_FUNCTIONS(HOUDINI_API_NAME)};
+#undef HOUDINI_API_NAME
+
+const int theFunctionCount = sizeof(theFunctionNames) /
+                             sizeof(theFunctionNames[0]);
+
+std::mutex theMutex;
+HoudiniApiRecorder::Mode theMode = HoudiniApiRecorder::ModeOff;
+
+std::ofstream theLogStream;
+
+std::vector<char> theLog;
+size_t theLogPosition = 0;
+// Index of each recorded function in HOUDINI_API_FUNCTIONS
+std::vector<int> theLogFunctions;
+bool theIsDiverged            = false;
+unsigned int theMismatchCount = 0;
+unsigned int theCallCount     = 0;
+
+// Reused by the calls, which are serialized by theMutex.
+ByteWriter theCallBuffer;
+ByteWriter theArgumentBuffer;
+
+void
+diverge(int functionIndex)
+{
+    theIsDiverged = true;
+
+    DISPLAY_ERROR("HAPI replay diverged from the log at call ^1s (^2s). The "
+                  "remaining calls will fail.",
+                  MString() + theCallCount,
+                  theFunctionNames[functionIndex]);
+}
+
+void
+mismatch(int functionIndex)
+{
+    theMismatchCount++;
+
+    if (theMismatchCount <= theMaxWarnings)
+    {
+        DISPLAY_WARNING("HAPI replay: the arguments of call ^1s (^2s) do not "
+                        "match the log.",
+                        MString() + theCallCount,
+                        theFunctionNames[functionIndex]);
+    }
+}
+
+template <typename FuncPtr, FuncPtr *Slot>
+struct RecordedFunction;
+
+template <typename R, typename... Args, R (**Slot)(Args...)>
+struct RecordedFunction<R (*)(Args...), Slot>
+    : public HoudiniApiArguments::SlotWrapper<
+          R (*)(Args...),
+          Slot,
+          RecordedFunction<R (*)(Args...), Slot>,
+          HoudiniApiArguments::LayerRecorder>
+{
+    typedef R (*FuncPtr)(Args...);
+    typedef HoudiniApiArguments::SlotWrapper<FuncPtr,
+                                             Slot,
+                                             RecordedFunction,
+                                             HoudiniApiArguments::LayerRecorder>
+        Base;
+
+    static R call(Args... args)
+    {
+        std::lock_guard<std::mutex> lock(theMutex);
+
+        theArgumentBuffer.clear();
+        ArgumentWriter argumentWriter(theArgumentBuffer);
+        HoudiniApiArguments::visit<FuncPtr, Slot>(argumentWriter, args...);
+
+        return theMode == HoudiniApiRecorder::ModeReplay ? replay(args...) :
+                                                           record(args...);
+    }
+
+    static R record(Args... args)
+    {
+        ReturnValue<R> result;
+        result.call([&]() { return Base::theOriginal(args...); });
+
+        theCallBuffer.clear();
+        theCallBuffer.write(static_cast<unsigned short>(theIndex));
+        theCallBuffer.write(
+            static_cast<unsigned int>(theArgumentBuffer.size()));
+        theCallBuffer.write(theArgumentBuffer.data(), theArgumentBuffer.size());
+        result.write(theCallBuffer);
+
+        OutputWriter outputWriter(theCallBuffer);
+        HoudiniApiArguments::visit<FuncPtr, Slot>(outputWriter, args...);
+
+        theLogStream.write(theCallBuffer.data(), theCallBuffer.size());
+        theCallCount++;
+
+        return result.get();
+    }
+
+    static R replay(Args... args)
+    {
+        ReturnValue<R> result;
+        if (theIsDiverged)
+        {
+            return result.get();
+        }
+
+        ByteReader reader(theLog, theLogPosition);
+
+        unsigned short index      = 0;
+        unsigned int argumentSize = 0;
+        const char *arguments     = NULL;
+        if (!reader.read(index) || index >= theLogFunctions.size() ||
+            theLogFunctions[index] != theIndex || !reader.read(argumentSize) ||
+            !(arguments = reader.skip(argumentSize)) || !result.read(reader))
+        {
+            diverge(theIndex);
+            return failureValue<R>();
+        }
+
+        OutputReader outputReader(reader);
+        HoudiniApiArguments::visit<FuncPtr, Slot>(outputReader, args...);
+        if (!outputReader.isValid())
+        {
+            diverge(theIndex);
+            return failureValue<R>();
+        }
+
+        if (argumentSize != theArgumentBuffer.size() ||
+            memcmp(arguments, theArgumentBuffer.data(), argumentSize) != 0 ||
+            !outputReader.isMatching())
+        {
+            mismatch(theIndex);
+        }
+
+        theLogPosition = reader.position();
+        theCallCount++;
+
+        return result.get();
+    }
+
+    static void install(int index)
+    {
+        theIndex = index;
+        Base::install();
+    }
+
+    static int theIndex;
+};
+
+template <typename R, typename... Args, R (**Slot)(Args...)>
+int RecordedFunction<R (*)(Args...), Slot>::theIndex = -1;
+
+#define HOUDINI_API_INSTALL(name)                                              \
+    RecordedFunction<HoudiniApi::name##FuncPtr, &HoudiniApi::name>::install(   \
+        index++);
+#define HOUDINI_API_UNINSTALL(name)                                            \
+    RecordedFunction<HoudiniApi::name##FuncPtr,                                \
+                     &HoudiniApi::name>::uninstall();
+
+void
+install()
+{
+    int index = 0;
+    HOUDINI_API_FUNCTIONS(HOUDINI_API_INSTALL)
+}
+
+void
+uninstall()
+{
+    HOUDINI_API_FUNCTIONS(HOUDINI_API_UNINSTALL)
+}
+
+bool
+readHeader(ByteReader &reader)
+{
+    char magic[sizeof(theMagic)];
+    unsigned int version       = 0;
+    unsigned int apiVersion    = 0;
+    unsigned int functionCount = 0;
+    if (!reader.read(magic) || memcmp(magic, theMagic, sizeof(theMagic)) ||
+        !reader.read(version) || version != theVersion ||
+        !reader.read(apiVersion) || !reader.read(functionCount))
+    {
+        return false;
+    }
+
+    if (apiVersion != theApiVersion)
+    {
+        DISPLAY_WARNING("The HAPI log was recorded with a different version of "
+                        "Houdini Engine.");
+    }
+
+    theLogFunctions.assign(functionCount, -1);
+    for (unsigned int i = 0; i < functionCount; i++)
+    {
+        unsigned short length = 0;
+        const char *name      = NULL;
+        if (!reader.read(length) || !(name = reader.skip(length)))
+        {
+            return false;
+        }
+
+        const std::string functionName(name, length);
+        for (int j = 0; j < theFunctionCount; j++)
+        {
+            if (functionName == theFunctionNames[j])
+            {
+                theLogFunctions[i] = j;
+                break;
+            }
+        }
+    }
+
+    return true;
+}
+
+void
+writeHeader(ByteWriter &writer)
+{
+    writer.write(theMagic);
+    writer.write(theVersion);
+    writer.write(theApiVersion);
+    writer.write(static_cast<unsigned int>(theFunctionCount));
+    for (int i = 0; i < theFunctionCount; i++)
+    {
+        const unsigned short length = static_cast<unsigned short>(
+            strlen(theFunctionNames[i]));
+        writer.write(length);
+        writer.write(theFunctionNames[i], length);
+    }
+}
+}
+
+bool
+HoudiniApiRecorder::startRecording(const MString &filePath)
+{
+    std::lock_guard<std::mutex> lock(theMutex);
+
+    if (theMode != ModeOff)
+    {
+        return false;
+    }
+
+    theLogStream.open(filePath.asChar(), std::ios::binary | std::ios::trunc);
+    if (!theLogStream)
+    {
+        DISPLAY_ERROR("Could not open the HAPI log for writing: ^1s", filePath);
+        return false;
+    }
+
+    theCallBuffer.clear();
+    writeHeader(theCallBuffer);
+    theLogStream.write(theCallBuffer.data(), theCallBuffer.size());
+
+    theCallCount = 0;
+    theMode      = ModeRecord;
+    install();
+
+    return true;
+}
+
+bool
+HoudiniApiRecorder::startReplay(const MString &filePath)
+{
+    std::lock_guard<std::mutex> lock(theMutex);
+
+    if (theMode != ModeOff)
+    {
+        return false;
+    }
+
+    std::ifstream stream(filePath.asChar(), std::ios::binary | std::ios::ate);
+    if (!stream)
+    {
+        DISPLAY_ERROR("Could not open the HAPI log for reading: ^1s", filePath);
+        return false;
+    }
+
+    // Read the whole log upfront, so that reading it does not show up when
+    // benchmarking.
+    theLog.resize(static_cast<size_t>(stream.tellg()));
+    stream.seekg(0);
+    stream.read(theLog.data(), theLog.size());
+
+    ByteReader reader(theLog, 0);
+    if (!stream || !readHeader(reader))
+    {
+        DISPLAY_ERROR("Invalid HAPI log: ^1s", filePath);
+        theLog.clear();
+        return false;
+    }
+
+    theLogPosition   = reader.position();
+    theIsDiverged    = false;
+    theMismatchCount = 0;
+    theCallCount     = 0;
+    theMode          = ModeReplay;
+    install();
+
+    return true;
+}
+
+void
+HoudiniApiRecorder::stop()
+{
+    std::lock_guard<std::mutex> lock(theMutex);
+
+    if (theMode == ModeOff)
+    {
+        return;
+    }
+
+    uninstall();
+
+    if (theMode == ModeRecord)
+    {
+        theLogStream.close();
+    }
+    else
+    {
+        DISPLAY_INFO("HAPI replay: ^1s calls replayed, ^2s mismatched, ^3s "
+                     "bytes of the log left.",
+                     MString() + theCallCount, MString() + theMismatchCount,
+                     MString() + static_cast<double>(
+                                     theLog.size() - theLogPosition));
+
+        std::vector<char>().swap(theLog);
+        theLogFunctions.clear();
+    }
+
+    theMode = ModeOff;
+}
+
+HoudiniApiRecorder::Mode
+HoudiniApiRecorder::mode()
+{
+    return theMode;
+}
+
+unsigned int
+HoudiniApiRecorder::mismatchCount()
+{
+    return theMismatchCount;
+}
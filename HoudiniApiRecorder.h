@@ -0,0 +1,39 @@
+#ifndef __HoudiniApiRecorder_h__
+#define __HoudiniApiRecorder_h__
+
+#include <maya/MString.h>
+
+// Record and replay layer over the HoudiniApi function table.
+//
+// When recording, every call is forwarded to libHAPIL and written to a binary
+// log along with its arguments, its return value and the buffers that it
+// filled in. When replaying, the calls are answered from such a log instead,
+// so that a recorded session can be run again without a Houdini installation,
+// license or server. The calls must be made in the same order as they were
+// recorded. The scalar and string arguments, and a hash of the array
+// arguments, are compared against the log to detect a divergence.
+class HoudiniApiRecorder
+{
+public:
+    enum Mode
+    {
+        ModeOff,
+        ModeRecord,
+        ModeReplay
+    };
+
+    // libHAPIL must be loaded before recording.
+    static bool startRecording(const MString &filePath);
+
+    // Replaces libHAPIL entirely. Nothing needs to be loaded before.
+    static bool startReplay(const MString &filePath);
+
+    static void stop();
+
+    static Mode mode();
+
+    // Number of calls whose arguments did not match the log when replaying.
+    static unsigned int mismatchCount();
+};
+
+#endif
@@ -0,0 +1,492 @@
+#include "HoudiniApiTracer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "HoudiniApiArguments.h"
+#include "util.h"
+
+namespace
+{
+typedef std::chrono::steady_clock Clock;
+
+struct CallStats
+{
+    CallStats() : count(0), nanoseconds(0), bytes(0) {}
+
+    unsigned long long count;
+    long long nanoseconds;
+    unsigned long long bytes;
+};
+
+struct TraceEvent
+{
+    int name;
+    int node;
+    int thread;
+    long long start;
+    long long duration;
+    size_t bytes;
+    bool isScope;
+};
+
+// Bound the memory used by the Chrome trace. The per function statistics keep
+// accumulating after the limit is reached.
+const size_t theMaxEvents = 1 << 20;
+
+std::mutex theMutex;
+std::atomic<bool> theIsEnabled(false);
+const Clock::time_point theEpoch = Clock::now();
+
+// Names of the traced functions and of the node scope labels
+std::vector<std::string> theNames;
+// Index 0 is used for the calls made outside of any node scope
+std::vector<std::string> theNodes(1, "<no node>");
+
+std::map<std::pair<int, int>, CallStats> theCallStats;
+std::map<std::pair<int, int>, CallStats> theScopeStats;
+std::vector<TraceEvent> theEvents;
+size_t theDroppedEventCount = 0;
+
+thread_local int theCurrentNode = 0;
+
+long long
+now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               Clock::now() - theEpoch)
+        .count();
+}
+
+int
+threadIndex()
+{
+    static std::atomic<int> theThreadCount(0);
+    thread_local int index = theThreadCount++;
+    return index;
+}
+
+// theMutex must be held
+int
+findOrAddName(std::vector<std::string> &names, const std::string &name)
+{
+    std::vector<std::string>::iterator iter = std::find(
+        names.begin(), names.end(), name);
+    if (iter != names.end())
+    {
+        return static_cast<int>(std::distance(names.begin(), iter));
+    }
+
+    names.push_back(name);
+    return static_cast<int>(names.size() - 1);
+}
+
+int
+registerName(const char *name)
+{
+    std::lock_guard<std::mutex> lock(theMutex);
+    return findOrAddName(theNames, name);
+}
+
+void
+record(int name,
+       int node,
+       long long start,
+       long long end,
+       size_t bytes,
+       bool isScope)
+{
+    std::lock_guard<std::mutex> lock(theMutex);
+
+    CallStats &stats = isScope ? theScopeStats[std::make_pair(name, node)] :
+                                 theCallStats[std::make_pair(name, node)];
+    stats.count++;
+    stats.nanoseconds += end - start;
+    stats.bytes += bytes;
+
+    if (theEvents.size() < theMaxEvents)
+    {
+        TraceEvent event = {
+            name, node, threadIndex(), start, end - start, bytes, isScope};
+        theEvents.push_back(event);
+    }
+    else
+    {
+        theDroppedEventCount++;
+    }
+}
+
+class CallScope
+{
+public:
+    CallScope(int name, size_t bytes)
+        : myName(name), myBytes(bytes), myStart(now())
+    {
+    }
+
+    ~CallScope()
+    {
+        record(myName, theCurrentNode, myStart, now(), myBytes, false);
+    }
+
+private:
+    int myName;
+    size_t myBytes;
+    long long myStart;
+};
+
+// Adds up the bytes of the data passed to or returned by a call. Only the
+// contents of pointer arguments are counted.
+class PayloadCounter
+{
+public:
+    PayloadCounter() : myBytes(0) {}
+
+    template <typename T>
+    void operator()(const T &, int)
+    {
+    }
+
+    template <typename T>
+    void operator()(T *const &data, int count)
+    {
+        if (data && count > 0)
+            myBytes += static_cast<size_t>(count) * sizeof(T);
+    }
+
+    void operator()(void *const &, int) {}
+
+    void operator()(const char *const &str, int)
+    {
+        if (str)
+            myBytes += strlen(str) + 1;
+    }
+
+    void operator()(char *const &str, int count)
+    {
+        if (str && count > 0)
+            myBytes += count;
+    }
+
+    void operator()(const char **const &strs, int count)
+    {
+        for (int i = 0; strs && i < count; i++)
+        {
+            if (strs[i])
+                myBytes += strlen(strs[i]) + 1;
+        }
+    }
+
+    size_t bytes() const { return myBytes; }
+
+private:
+    size_t myBytes;
+};
+
+// Wrapper that is swapped into a slot of the function table.
+template <typename FuncPtr, FuncPtr *Slot>
+struct TracedFunction;
+
+template <typename R, typename... Args, R (**Slot)(Args...)>
+struct TracedFunction<R (*)(Args...), Slot>
+    : public HoudiniApiArguments::SlotWrapper<
+          R (*)(Args...),
+          Slot,
+          TracedFunction<R (*)(Args...), Slot>,
+          HoudiniApiArguments::LayerTracer>
+{
+    typedef R (*FuncPtr)(Args...);
+    typedef HoudiniApiArguments::SlotWrapper<FuncPtr,
+                                             Slot,
+                                             TracedFunction,
+                                             HoudiniApiArguments::LayerTracer>
+        Base;
+
+    static R call(Args... args)
+    {
+        PayloadCounter payload;
+        HoudiniApiArguments::visit<FuncPtr, Slot>(payload, args...);
+
+        CallScope scope(theName, payload.bytes());
+        return Base::theOriginal(args...);
+    }
+
+    static void install(const char *name)
+    {
+        theName = registerName(name);
+        Base::install();
+    }
+
+    static int theName;
+};
+
+template <typename R, typename... Args, R (**Slot)(Args...)>
+int TracedFunction<R (*)(Args...), Slot>::theName = -1;
+
+#define HOUDINI_API_INSTALL(name)                                              \
+    TracedFunction<HoudiniApi::name##FuncPtr, &HoudiniApi::name>::install(     \
+        #name);
+#define HOUDINI_API_UNINSTALL(name)                                            \
+    TracedFunction<HoudiniApi::name##FuncPtr, &HoudiniApi::name>::uninstall();
+
+std::string
+escapeJSON(const std::string &str)
+{
+    std::string escaped;
+    escaped.reserve(str.size());
+    for (char c : str)
+    {
+        if (c == '"' || c == '\\')
+        {
+            escaped += '\\';
+            escaped += c;
+        }
+        else if (static_cast<unsigned char>(c) < 0x20)
+        {
+            escaped += ' ';
+        }
+        else
+        {
+            escaped += c;
+        }
+    }
+
+    return escaped;
+}
+
+struct SummaryRow
+{
+    std::string name;
+    CallStats stats;
+};
+
+bool
+compareSummaryRows(const SummaryRow &a, const SummaryRow &b)
+{
+    return a.stats.nanoseconds > b.stats.nanoseconds;
+}
+
+void
+appendSummaryRows(std::string &summary, std::vector<SummaryRow> &rows,
+                  size_t maxRows)
+{
+    std::sort(rows.begin(), rows.end(), compareSummaryRows);
+
+    char line[256];
+    for (size_t i = 0; i < rows.size() && i < maxRows; i++)
+    {
+        const CallStats &stats = rows[i].stats;
+        snprintf(line, sizeof(line), "  %-40s %10llu %12.3f %10.3f %12.3f\n",
+                 rows[i].name.c_str(), stats.count, stats.nanoseconds / 1e6,
+                 stats.nanoseconds / 1e3 / std::max(stats.count, 1ull),
+                 stats.bytes / (1024.0 * 1024.0));
+        summary += line;
+    }
+}
+}
+
+void
+HoudiniApiTracer::enable()
+{
+    if (theIsEnabled)
+        return;
+
+    HOUDINI_API_FUNCTIONS(HOUDINI_API_INSTALL)
+
+    theIsEnabled = true;
+}
+
+void
+HoudiniApiTracer::disable()
+{
+    if (!theIsEnabled)
+        return;
+
+    HOUDINI_API_FUNCTIONS(HOUDINI_API_UNINSTALL)
+
+    theIsEnabled = false;
+}
+
+bool
+HoudiniApiTracer::isEnabled()
+{
+    return theIsEnabled;
+}
+
+void
+HoudiniApiTracer::reset()
+{
+    std::lock_guard<std::mutex> lock(theMutex);
+
+    theCallStats.clear();
+    theScopeStats.clear();
+    theEvents.clear();
+    theDroppedEventCount = 0;
+}
+
+MString
+HoudiniApiTracer::summary()
+{
+    std::lock_guard<std::mutex> lock(theMutex);
+
+    const char *header = "  Name                                          Calls"
+                         "     Total ms     Avg us           MB\n";
+
+    std::string summary;
+    char line[256];
+
+    // totals per function, across all nodes
+    std::map<int, CallStats> functionStats;
+    CallStats totalStats;
+    for (const auto &entry : theCallStats)
+    {
+        CallStats &stats = functionStats[entry.first.first];
+        stats.count += entry.second.count;
+        stats.nanoseconds += entry.second.nanoseconds;
+        stats.bytes += entry.second.bytes;
+
+        totalStats.count += entry.second.count;
+        totalStats.nanoseconds += entry.second.nanoseconds;
+        totalStats.bytes += entry.second.bytes;
+    }
+
+    snprintf(line, sizeof(line),
+             "HAPI trace: %llu calls, %.3f ms, %.3f MB transferred\n",
+             totalStats.count, totalStats.nanoseconds / 1e6,
+             totalStats.bytes / (1024.0 * 1024.0));
+    summary += line;
+
+    summary += "\nPer function:\n";
+    summary += header;
+    {
+        std::vector<SummaryRow> rows;
+        for (const auto &entry : functionStats)
+        {
+            SummaryRow row = {theNames[entry.first], entry.second};
+            rows.push_back(row);
+        }
+        appendSummaryRows(summary, rows, rows.size());
+    }
+
+    // per node, the time spent in the node scopes next to the time spent in
+    // HAPI calls made from them
+    for (size_t node = 0; node < theNodes.size(); node++)
+    {
+        std::vector<SummaryRow> scopeRows;
+        for (const auto &entry : theScopeStats)
+        {
+            if (entry.first.second != static_cast<int>(node))
+                continue;
+
+            SummaryRow row = {theNames[entry.first.first], entry.second};
+            scopeRows.push_back(row);
+        }
+
+        std::vector<SummaryRow> callRows;
+        CallStats nodeStats;
+        for (const auto &entry : theCallStats)
+        {
+            if (entry.first.second != static_cast<int>(node))
+                continue;
+
+            SummaryRow row = {theNames[entry.first.first], entry.second};
+            callRows.push_back(row);
+
+            nodeStats.count += entry.second.count;
+            nodeStats.nanoseconds += entry.second.nanoseconds;
+            nodeStats.bytes += entry.second.bytes;
+        }
+
+        if (scopeRows.empty() && callRows.empty())
+            continue;
+
+        snprintf(line, sizeof(line),
+                 "\nNode %s: %llu HAPI calls, %.3f ms in HAPI, %.3f MB\n",
+                 theNodes[node].c_str(), nodeStats.count,
+                 nodeStats.nanoseconds / 1e6,
+                 nodeStats.bytes / (1024.0 * 1024.0));
+        summary += line;
+        summary += header;
+        appendSummaryRows(summary, scopeRows, scopeRows.size());
+        appendSummaryRows(summary, callRows, 10);
+    }
+
+    if (theDroppedEventCount)
+    {
+        snprintf(line, sizeof(line),
+                 "\n%llu events were not kept for the Chrome trace.\n",
+                 static_cast<unsigned long long>(theDroppedEventCount));
+        summary += line;
+    }
+
+    return MString(summary.c_str());
+}
+
+bool
+HoudiniApiTracer::writeChromeTrace(const MString &filePath)
+{
+    std::ofstream stream(filePath.asChar());
+    if (!stream)
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(theMutex);
+
+    stream << "{\"traceEvents\":[\n";
+    for (size_t i = 0; i < theEvents.size(); i++)
+    {
+        const TraceEvent &event = theEvents[i];
+
+        stream << (i ? ",\n" : "") << "{\"name\":\""
+               << escapeJSON(theNames[event.name]) << "\",\"cat\":\""
+               << (event.isScope ? "maya" : "hapi")
+               << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.thread
+               << ",\"ts\":" << event.start / 1e3
+               << ",\"dur\":" << event.duration / 1e3
+               << ",\"args\":{\"node\":\""
+               << escapeJSON(theNodes[event.node])
+               << "\",\"bytes\":" << event.bytes << "}}";
+    }
+    stream << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+    return static_cast<bool>(stream);
+}
+
+HoudiniApiTracer::NodeScope::NodeScope(const MObject &node, const char *label)
+    : myIsActive(theIsEnabled),
+      myPreviousNode(theCurrentNode),
+      myLabel(-1),
+      myStart(0)
+{
+    if (!myIsActive)
+        return;
+
+    const MString nodeName = Util::getNodeName(node);
+
+    {
+        std::lock_guard<std::mutex> lock(theMutex);
+        theCurrentNode = findOrAddName(theNodes, nodeName.asChar());
+        myLabel        = findOrAddName(theNames, label);
+    }
+
+    myStart = now();
+}
+
+HoudiniApiTracer::NodeScope::~NodeScope()
+{
+    if (!myIsActive)
+        return;
+
+    record(myLabel, theCurrentNode, myStart, now(), 0, true);
+
+    theCurrentNode = myPreviousNode;
+}
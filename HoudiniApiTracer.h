@@ -0,0 +1,48 @@
+#ifndef __HoudiniApiTracer_h__
+#define __HoudiniApiTracer_h__
+
+#include <maya/MObject.h>
+#include <maya/MString.h>
+
+// Optional profiling layer over the HoudiniApi function table. When enabled,
+// every entry point in the table is replaced by a wrapper that records the
+// call count, wall time and payload bytes of each HAPI function, attributed to
+// the Maya node that is currently computing. Disabling restores the original
+// entry points, so there is no overhead when tracing is off.
+class HoudiniApiTracer
+{
+public:
+    static void enable();
+    static void disable();
+    static bool isEnabled();
+
+    static void reset();
+
+    // Returns a table of the recorded calls, per function and per node.
+    static MString summary();
+
+    // Writes the recorded calls as a Chrome trace (chrome://tracing) file.
+    static bool writeChromeTrace(const MString &filePath);
+
+    // Attributes the HAPI calls made on this thread to a node for the lifetime
+    // of the scope. The scope itself is recorded as well, so that the time
+    // spent on the Maya side can be told apart from the time spent in HAPI.
+    class NodeScope
+    {
+    public:
+        NodeScope(const MObject &node, const char *label);
+        ~NodeScope();
+
+    private:
+        bool myIsActive;
+        int myPreviousNode;
+        int myLabel;
+        long long myStart;
+
+    private:
+        NodeScope(const NodeScope &);
+        NodeScope &operator=(const NodeScope &);
+    };
+};
+
+#endif
@@ -56,7 +56,7 @@ Inputs::compute(MDataBlock &dataBlock)
         MDataHandle inputNameHandle = inputHandle.child(AssetNode::inputName);
 
         HAPI_StringHandle nameSH;
-        HAPI_GetNodeInputName(Util::theHAPISession.get(), myNodeId, i, &nameSH);
+        HoudiniApi::GetNodeInputName(Util::theHAPISession.get(), myNodeId, i, &nameSH);
 
         inputNameHandle.set(Util::HAPIString(nameSH));
     }
@@ -89,6 +89,10 @@ Input::Input()
       myMatPerFace(0),
       myAllowFacetSet(0),
       myPreserveScale(false),
+      mySinglePrecision(false),
+      myQuantizeDeltas(false),
+      myIgnoreTransform(false),
+      myHasTransform(false),
       myGeometryNodeId(-1)
 {
 }
@@ -218,8 +222,33 @@ Input::setPreserveScale(bool preserveScale)
     myPreserveScale = preserveScale;
 }
 
+void
+Input::setSinglePrecision(bool singlePrecision)
+{
+    mySinglePrecision = singlePrecision;
+}
+
+void
+Input::setQuantizeDeltas(bool quantizeDeltas)
+{
+    myQuantizeDeltas = quantizeDeltas;
+}
+
+void
+Input::setIgnoreTransform(bool ignoreTransform)
+{
+    myIgnoreTransform = ignoreTransform;
+}
+
 void
 Input::setInputTransform(MDataHandle &dataHandle)
+{
+    updateTransform(dataHandle);
+    sendTransform();
+}
+
+void
+Input::updateTransform(MDataHandle &dataHandle)
 {
     MMatrix transformMatrix = dataHandle.asMatrix();
 
@@ -238,12 +267,21 @@ Input::setInputTransform(MDataHandle &dataHandle)
         transformMatrix.get(reinterpret_cast<float(*)[4]>(matrix));
     }
 
-    HAPI_TransformEuler transformEuler;
-    HAPI_ConvertMatrixToEuler(Util::theHAPISession.get(), matrix, HAPI_SRT,
-                              HAPI_XYZ, &transformEuler);
+    HoudiniApi::ConvertMatrixToEuler(Util::theHAPISession.get(), matrix, HAPI_SRT,
+                                     HAPI_XYZ, &myTransform);
+    myHasTransform = true;
+}
+
+void
+Input::sendTransform()
+{
+    if (!myHasTransform)
+    {
+        return;
+    }
 
-    CHECK_HAPI(HAPI_SetObjectTransform(
-        Util::theHAPISession.get(), transformNodeId(), &transformEuler));
+    CHECK_HAPI(HoudiniApi::SetObjectTransform(
+        Util::theHAPISession.get(), transformNodeId(), &myTransform));
 }
 void
 Input::setInputComponents(MDataBlock &dataBlock,
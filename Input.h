@@ -51,17 +51,31 @@ public:
 
     HAPI_NodeId transformNodeId() const { return myTransformNodeId; };
     HAPI_NodeId geometryNodeId() const { return myGeometryNodeId; };
+
+    // The node that is connected to the assets, which is the geometry node
+    // unless the geometry is processed further in Houdini.
+    virtual HAPI_NodeId outputNodeId() const { return geometryNodeId(); };
+
     void setUnlockNormals(bool unlockNormals);
     void setMatPerFace(bool matPerFace);
     void setAllowFacetSet(bool allowFacetSet);
     void setPreserveScale(bool preserveScale);
+    void setSinglePrecision(bool singlePrecision);
+    void setQuantizeDeltas(bool quantizeDeltas);
+    void setIgnoreTransform(bool ignoreTransform);
 
     void setInputName(HAPI_AttributeOwner owner, int count, const MPlug &plug);
 
-    void setInputTransform(MDataHandle &dataHandle);
+    virtual void setInputTransform(MDataHandle &dataHandle);
+
+    // Returns whether the geometry needs to be sent again even though it
+    // didn't change, e.g. after the transform changed.
+    virtual bool needsInputGeo() { return false; }
 
     virtual void setInputGeo(MDataBlock &dataBlock, const MPlug &plug) = 0;
 
+    // Reads the component list before setInputGeo(), which sends it with the
+    // geometry.
     virtual void setInputComponents(MDataBlock &dataBlock,
                                     const MPlug &geoPlug,
                                     const MPlug &compPlug,
@@ -72,10 +86,22 @@ protected:
     void setTransformNodeId(HAPI_NodeId nodeId) { myTransformNodeId = nodeId; };
     void setGeometryNodeId(HAPI_NodeId nodeId) { myGeometryNodeId = nodeId; };
 
+    // Converts the transform without sending it.
+    void updateTransform(MDataHandle &dataHandle);
+
+    // Sends the last transform again, e.g. when the input uses another node.
+    void sendTransform();
+
     bool myUnlockNormals;
     bool myMatPerFace;
     bool myAllowFacetSet;
     bool myPreserveScale;
+    bool mySinglePrecision;
+    bool myQuantizeDeltas;
+    bool myIgnoreTransform;
+
+    bool myHasTransform;
+    HAPI_TransformEuler myTransform;
 
 private:
     static void nameChangedCallback(MObject &node,
@@ -1,31 +1,220 @@
 #include "InputCurve.h"
 
-#include <sstream>
-
 #include <maya/MDataBlock.h>
+#include <maya/MDoubleArray.h>
 #include <maya/MFnNurbsCurve.h>
 #include <maya/MMatrix.h>
 #include <maya/MPointArray.h>
 
 #include <HAPI/HAPI.h>
 
+#include <cmath>
+
+#include "hapiutil.h"
 #include "util.h"
 
+InputCurvePacker::InputCurvePacker()
+{
+    myCurveInfo            = HoudiniApi::CurveInfo_Create();
+    myCurveInfo.curveType  = HAPI_CURVETYPE_NURBS;
+    myCurveInfo.isRational = false;
+}
+
+MStatus
+InputCurvePacker::addCurve(const MObject &curveObj,
+                           bool preserveScale,
+                           const MString &name)
+{
+    MFnNurbsCurve fnCurve(curveObj);
+
+    const bool isPeriodic = fnCurve.form() == MFnNurbsCurve::kPeriodic;
+    if (myCurveInfo.curveCount == 0)
+    {
+        myCurveInfo.isPeriodic = isPeriodic;
+    }
+    else if (isPeriodic != myCurveInfo.isPeriodic)
+    {
+        DISPLAY_ERROR(
+            MString("Curve has a non-matching periodicity, skipping"));
+        return MStatus::kSuccess;
+    }
+
+    const int order = fnCurve.degree() + 1;
+    if (myCurveInfo.curveCount == 0)
+    {
+        myCurveInfo.order = order;
+    }
+    else if (myCurveInfo.order == HAPI_CURVE_ORDER_VARYING)
+    {
+        myOrders.push_back(order);
+    }
+    else if (order != myCurveInfo.order)
+    {
+        myOrders.resize(myCurveInfo.curveCount, myCurveInfo.order);
+        myCurveInfo.order = HAPI_CURVE_ORDER_VARYING;
+        myOrders.push_back(order);
+    }
+
+    MPointArray cvArray;
+    CHECK_MSTATUS_AND_RETURN_IT(fnCurve.getCVs(cvArray, MSpace::kWorld));
+
+    unsigned int nCVs = cvArray.length();
+
+    // Maya provides fnCurve.degree() more cvs in its data definition
+    // than Houdini for periodic curves -- but they are conincident
+    // with the first ones. Houdini ignores them, so we don't
+    // output them.
+    if (myCurveInfo.isPeriodic && static_cast<int>(nCVs) > fnCurve.degree())
+    {
+        nCVs -= fnCurve.degree();
+    }
+
+    myCounts.push_back(nCVs);
+
+    for (unsigned int iCV = 0; iCV < nCVs; ++iCV, ++myCurveInfo.vertexCount)
+    {
+        MPoint &cv = cvArray[iCV];
+
+        if (preserveScale)
+        {
+            cv.x *= 0.01f;
+            cv.y *= 0.01f;
+            cv.z *= 0.01f;
+        }
+
+        myP.push_back((float)cv.x);
+        myP.push_back((float)cv.y);
+        myP.push_back((float)cv.z);
+
+        if (!myCurveInfo.isRational)
+        {
+            if (cv.w != 1.0)
+            {
+                myCurveInfo.isRational = true;
+                myPw.resize(myCurveInfo.vertexCount, 1.0f);
+                myPw.push_back((float)cv.w);
+            }
+        }
+        else
+        {
+            myPw.push_back((float)cv.w);
+        }
+    }
+
+    MDoubleArray knotsArray;
+    CHECK_MSTATUS_AND_RETURN_IT(fnCurve.getKnots(knotsArray));
+
+    if (knotsArray.length() > 0)
+    {
+        // Maya doesn't provide the first and last knots
+        myCurveInfo.knotCount += knotsArray.length() + 2;
+
+        myKnots.push_back(static_cast<float>(knotsArray[0]));
+
+        // Maya seems ok with having end knots of multiplicity > order
+        // (counting the 1st and last knots added above)
+        // so if we detect this, warn the user to rebuild their curves
+
+        if (fabs(knotsArray[0] - knotsArray[order - 1]) < .0001)
+        {
+            DISPLAY_WARNING("Curve ^1s has knots with higher multiplicity "
+                            "than the order of the curve."
+                            "You may need to rebuild the curve in order to "
+                            "see it in Houdini",
+                            name);
+        }
+
+        for (unsigned int iKnot = 0; iKnot < knotsArray.length(); ++iKnot)
+        {
+            myKnots.push_back(static_cast<float>(knotsArray[iKnot]));
+        }
+
+        myKnots.push_back(
+            static_cast<float>(knotsArray[knotsArray.length() - 1]));
+    }
+
+    ++myCurveInfo.curveCount;
+
+    myNames.push_back(name.asChar());
+
+    return MStatus::kSuccess;
+}
+
+void
+InputCurvePacker::setPart(HAPI_NodeId nodeId)
+{
+    myCurveInfo.hasKnots = myCurveInfo.knotCount > 0;
+
+    HAPI_PartInfo partInfo = HoudiniApi::PartInfo_Create();
+    partInfo.vertexCount = partInfo.pointCount = myCurveInfo.vertexCount;
+    partInfo.faceCount                         = myCurveInfo.curveCount;
+    partInfo.type                              = HAPI_PARTTYPE_CURVE;
+    CHECK_HAPI(HoudiniApi::SetPartInfo(
+        Util::theHAPISession.get(), nodeId, 0, &partInfo));
+
+    CHECK_HAPI(HoudiniApi::SetCurveInfo(
+        Util::theHAPISession.get(), nodeId, 0, &myCurveInfo));
+    CHECK_HAPI(HoudiniApi::SetCurveCounts(Util::theHAPISession.get(), nodeId,
+                                          0, &myCounts.front(), 0,
+                                          myCounts.size()));
+    if (myCurveInfo.order == HAPI_CURVE_ORDER_VARYING)
+    {
+        CHECK_HAPI(HoudiniApi::SetCurveOrders(Util::theHAPISession.get(),
+                                              nodeId, 0, &myOrders.front(), 0,
+                                              myOrders.size()));
+    }
+
+    HAPI_AttributeInfo attrInfo = HoudiniApi::AttributeInfo_Create();
+    attrInfo.count              = partInfo.pointCount;
+    attrInfo.tupleSize          = 3; // 3 floats per CV (x, y, z)
+    attrInfo.exists             = true;
+    attrInfo.owner              = HAPI_ATTROWNER_POINT;
+    attrInfo.storage            = HAPI_STORAGETYPE_FLOAT;
+
+    CHECK_HAPI(HoudiniApi::AddAttribute(
+        Util::theHAPISession.get(), nodeId, 0, "P", &attrInfo));
+
+    CHECK_HAPI(HoudiniApi::SetAttributeFloatData(
+        Util::theHAPISession.get(), nodeId, 0, "P", &attrInfo, &myP.front(),
+        0, static_cast<int>(myP.size() / 3)));
+
+    if (myCurveInfo.isRational)
+    {
+        attrInfo.tupleSize = 1;
+        CHECK_HAPI(HoudiniApi::AddAttribute(
+            Util::theHAPISession.get(), nodeId, 0, "Pw", &attrInfo));
+
+        CHECK_HAPI(HoudiniApi::SetAttributeFloatData(
+            Util::theHAPISession.get(), nodeId, 0, "Pw", &attrInfo,
+            &myPw.front(), 0, static_cast<int>(myPw.size())));
+    }
+
+    if (myCurveInfo.hasKnots)
+    {
+        CHECK_HAPI(HoudiniApi::SetCurveKnots(Util::theHAPISession.get(),
+                                             nodeId, 0, &myKnots.front(), 0,
+                                             static_cast<int>(myKnots.size())));
+    }
+
+    CHECK_HAPI(hapiSetPrimAttribute(nodeId, 0, 1, "name", myNames));
+}
+
 InputCurve::InputCurve() : Input()
 {
     Util::PythonInterpreterLock pythonInterpreterLock;
 
     HAPI_NodeId nodeId;
-    CHECK_HAPI(HAPI_CreateNode(
-        Util::theHAPISession.get(), -1, "Sop/curve", NULL, false, &nodeId));
+    CHECK_HAPI(HoudiniApi::CreateInputNode(
+        Util::theHAPISession.get(), -1, &nodeId, NULL));
     if (!Util::statusCheckLoop())
     {
         DISPLAY_ERROR(MString("Unexpected error when creating input curve."));
     }
 
-    HAPI_GetNodeInfo(Util::theHAPISession.get(), nodeId, &myCurveNodeInfo);
+    HAPI_NodeInfo nodeInfo;
+    HoudiniApi::GetNodeInfo(Util::theHAPISession.get(), nodeId, &nodeInfo);
 
-    setTransformNodeId(myCurveNodeInfo.parentId);
+    setTransformNodeId(nodeInfo.parentId);
     setGeometryNodeId(nodeId);
 }
 
@@ -33,7 +222,7 @@ InputCurve::~InputCurve()
 {
     if (!Util::theHAPISession.get())
         return;
-    HAPI_DeleteNode(Util::theHAPISession.get(), geometryNodeId());
+    HoudiniApi::DeleteNode(Util::theHAPISession.get(), geometryNodeId());
 }
 
 InputCurve::AssetInputType
@@ -53,99 +242,19 @@ InputCurve::setInputGeo(MDataBlock &dataBlock, const MPlug &plug)
         return;
     }
 
-    // find coords parm
-    std::vector<HAPI_ParmInfo> parms(myCurveNodeInfo.parmCount);
-    HAPI_GetParameters(Util::theHAPISession.get(), myCurveNodeInfo.id,
-                       &parms[0], 0, myCurveNodeInfo.parmCount);
-    int typeParmIndex   = Util::findParm(parms, "type");
-    int coordsParmIndex = Util::findParm(parms, "coords");
-    int orderParmIndex  = Util::findParm(parms, "order");
-    int closeParmIndex  = Util::findParm(parms, "close");
-    if (coordsParmIndex < 0 || coordsParmIndex < 0 || orderParmIndex < 0 ||
-        closeParmIndex < 0)
+    // Bezier curves are sent as the NURBS curves that they are in Maya, with
+    // their knots, instead of driving a curve SOP through its parameters.
+    InputCurvePacker packer;
+    CHECK_MSTATUS(packer.addCurve(
+        curveObj, myPreserveScale,
+        Util::getNodeName(Util::plugSource(plug).node())));
+    if (!packer.curveCount())
     {
         return;
     }
 
-    const HAPI_ParmInfo &typeParm   = parms[typeParmIndex];
-    const HAPI_ParmInfo &coordsParm = parms[coordsParmIndex];
-    const HAPI_ParmInfo &orderParm  = parms[orderParmIndex];
-    const HAPI_ParmInfo &closeParm  = parms[closeParmIndex];
-
-    MFnNurbsCurve curveFn(curveObj);
-
-    // type
-    {
-        const char *type = "nurbs";
-        if (curveObj.apiType() == MFn::kBezierCurveData)
-        {
-            type = "bezier";
-        }
-
-        HAPI_ParmChoiceInfo *choices =
-            new HAPI_ParmChoiceInfo[typeParm.choiceCount];
-        HAPI_GetParmChoiceLists(Util::theHAPISession.get(), myCurveNodeInfo.id,
-                                choices, typeParm.choiceIndex,
-                                typeParm.choiceCount);
-
-        int nurbsIdx = -1;
-        for (int i = 0; i < typeParm.choiceCount; i++)
-        {
-            if (Util::HAPIString(choices[i].valueSH) == type)
-            {
-                nurbsIdx = i;
-                break;
-            }
-        }
-
-        delete[] choices;
-
-        if (nurbsIdx < 0)
-        {
-            return;
-        }
-
-        HAPI_SetParmIntValues(Util::theHAPISession.get(), myCurveNodeInfo.id,
-                              &nurbsIdx, typeParm.intValuesIndex, 1);
-    }
-
-    // coords
-    {
-        MPointArray cvs;
-        curveFn.getCVs(cvs);
-
-        // Maya has curveFn.degree() more cvs in it's data definition
-        // than houdini for periodic curves--but they are conincident
-        // with the first ones. Houdini ignores them, so we don't
-        // output them.
-        int num_houdini_cvs = cvs.length();
-        if (curveFn.form() == MFnNurbsCurve::kPeriodic)
-            num_houdini_cvs -= curveFn.degree();
-
-        std::ostringstream coords;
-        for (unsigned int i = 0; i < (unsigned int)num_houdini_cvs; i++)
-        {
-            const MPoint &pt = cvs[i];
-
-            coords << pt.x << "," << pt.y << "," << pt.z << " ";
-        }
-        HAPI_SetParmStringValue(Util::theHAPISession.get(), myCurveNodeInfo.id,
-                                coords.str().c_str(), coordsParm.id,
-                                coordsParm.stringValuesIndex);
-    }
+    packer.setPart(geometryNodeId());
 
-    // order
-    {
-        int order = curveFn.degree() + 1;
-
-        HAPI_SetParmIntValues(Util::theHAPISession.get(), myCurveNodeInfo.id,
-                              &order, orderParm.intValuesIndex, 1);
-    }
-
-    // periodicity
-    {
-        int close = curveFn.form() == MFnNurbsCurve::kPeriodic;
-        HAPI_SetParmIntValues(Util::theHAPISession.get(), myCurveNodeInfo.id,
-                              &close, closeParm.intValuesIndex, 1);
-    }
+    // Commit it
+    HoudiniApi::CommitGeo(Util::theHAPISession.get(), geometryNodeId());
 }
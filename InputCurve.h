@@ -5,6 +5,43 @@
 
 #include <HAPI/HAPI_Common.h>
 
+#include <maya/MObject.h>
+#include <maya/MStatus.h>
+#include <maya/MString.h>
+
+#include <string>
+#include <vector>
+
+// Packs NURBS and Bezier curves into a single curve part, which is sent to an
+// input node in one batch.
+class InputCurvePacker
+{
+public:
+    InputCurvePacker();
+
+    // Adds a curve to the part. Curves whose periodicity doesn't match the
+    // first curve are skipped.
+    MStatus addCurve(const MObject &curveObj,
+                     bool preserveScale,
+                     const MString &name);
+
+    int curveCount() const { return myCurveInfo.curveCount; }
+
+    // Sets the part, its curves and their attributes on the input node. The
+    // geometry still needs to be committed.
+    void setPart(HAPI_NodeId nodeId);
+
+private:
+    HAPI_CurveInfo myCurveInfo;
+
+    std::vector<float> myP;
+    std::vector<float> myPw;
+    std::vector<int> myCounts;
+    std::vector<float> myKnots;
+    std::vector<int> myOrders;
+    std::vector<std::string> myNames;
+};
+
 class InputCurve : public Input
 {
 public:
@@ -14,9 +51,6 @@ public:
     virtual AssetInputType assetInputType() const;
 
     virtual void setInputGeo(MDataBlock &dataBlock, const MPlug &plug);
-
-protected:
-    HAPI_NodeInfo myCurveNodeInfo;
 };
 
 #endif
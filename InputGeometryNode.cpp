@@ -5,7 +5,13 @@
 #include <maya/MFnMatrixAttribute.h>
 #include <maya/MFnNumericAttribute.h>
 #include <maya/MFnTypedAttribute.h>
+#if MAYA_API_VERSION >= 201600
+    #include <maya/MEvaluationNode.h>
+    #include <maya/MEvaluationNodeIterator.h>
+#endif
+#include <maya/MPlugArray.h>
 
+#include "HoudiniApiTracer.h"
 #include "Input.h"
 #include "MayaTypeID.h"
 
@@ -21,6 +27,8 @@ MObject InputGeometryNode::unlockNormals;
 MObject InputGeometryNode::materialPerFace;
 MObject InputGeometryNode::allowFacetSet;
 MObject InputGeometryNode::preserveScale;
+MObject InputGeometryNode::singlePrecision;
+MObject InputGeometryNode::quantizeDeltas;
 MObject InputGeometryNode::ignoreTransform;
 MObject InputGeometryNode::objectShadingGroup;
 MObject InputGeometryNode::outputNodeId;
@@ -97,6 +105,23 @@ InputGeometryNode::initialize()
     nAttr.setStorable(true);
     addAttribute(InputGeometryNode::preserveScale);
 
+    // converts the per-particle attributes to 32 bit floats before they are
+    // sent, which halves their size
+    InputGeometryNode::singlePrecision = nAttr.create(
+        "singlePrecision", "singlePrecision", MFnNumericData::kBoolean, false);
+    nAttr.setCached(false);
+    nAttr.setStorable(true);
+    addAttribute(InputGeometryNode::singlePrecision);
+
+    // sends the points of deforming meshes as 16 bit deltas from rest points,
+    // which are added back by a wrangle in Houdini. This is 6 bytes per point
+    // instead of 12, plus the rest points whenever the deltas get too large.
+    InputGeometryNode::quantizeDeltas = nAttr.create(
+        "quantizeDeltas", "quantizeDeltas", MFnNumericData::kBoolean, false);
+    nAttr.setCached(false);
+    nAttr.setStorable(true);
+    addAttribute(InputGeometryNode::quantizeDeltas);
+
     InputGeometryNode::ignoreTransform = nAttr.create(
         "ignoreTransform", "ignoreTransform", MFnNumericData::kBoolean, false);
     nAttr.setCached(false);
@@ -133,6 +158,10 @@ InputGeometryNode::initialize()
         InputGeometryNode::allowFacetSet, InputGeometryNode::outputNodeId);
     attributeAffects(
         InputGeometryNode::preserveScale, InputGeometryNode::outputNodeId);
+    attributeAffects(
+        InputGeometryNode::singlePrecision, InputGeometryNode::outputNodeId);
+    attributeAffects(
+        InputGeometryNode::quantizeDeltas, InputGeometryNode::outputNodeId);
     attributeAffects(
         InputGeometryNode::ignoreTransform, InputGeometryNode::outputNodeId);
     attributeAffects(
@@ -144,6 +173,9 @@ InputGeometryNode::initialize()
 MStatus
 InputGeometryNode::compute(const MPlug &plug, MDataBlock &dataBlock)
 {
+    HoudiniApiTracer::NodeScope traceScope(
+        thisMObject(), "InputGeometryNode::compute");
+
     if (plug == InputGeometryNode::outputNodeId)
     {
         MDataHandle outputNodeIdHandle =
@@ -166,6 +198,7 @@ InputGeometryNode::compute(const MPlug &plug, MDataBlock &dataBlock)
         MPlug ignoreTransformPlug(
             thisMObject(), InputGeometryNode::ignoreTransform);
         bool ignoreTransform = ignoreTransformPlug.asBool();
+        myInput->setIgnoreTransform(ignoreTransform);
 
         if (!ignoreTransform)
         {
@@ -188,18 +221,45 @@ InputGeometryNode::compute(const MPlug &plug, MDataBlock &dataBlock)
         myInput->setUnlockNormals(unlockNormals);
         myInput->setMatPerFace(matPerFace);
         myInput->setAllowFacetSet(allowFacetSet);
-        myInput->setInputGeo(dataBlock, geometryPlug);
 
-        // set input component list
-        MPlug complistPlug(thisMObject(), InputGeometryNode::inputComponents);
-        MPlug primGroupPlug(
-            thisMObject(), InputGeometryNode::primComponentGroup);
-        MPlug pointGroupPlug(
-            thisMObject(), InputGeometryNode::pointComponentGroup);
-        myInput->setInputComponents(dataBlock, geometryPlug, complistPlug,
-                                    primGroupPlug, pointGroupPlug);
+        MPlug singlePrecisionPlug(
+            thisMObject(), InputGeometryNode::singlePrecision);
+        myInput->setSinglePrecision(singlePrecisionPlug.asBool());
+
+        MPlug quantizeDeltasPlug(
+            thisMObject(), InputGeometryNode::quantizeDeltas);
+        myInput->setQuantizeDeltas(quantizeDeltasPlug.asBool());
+
+        // The dirty state is not tracked for the other contexts, e.g. when
+        // the asset is computed at another time.
+        bool isNormalContext = true;
+#if MAYA_API_VERSION >= 201800
+        isNormalContext = dataBlock.context().isNormal();
+#endif
+        bool needToMarshalGeometry = myNeedToMarshalGeometry ||
+                                     myInput->needsInputGeo() ||
+                                     !isNormalContext;
+        if (needToMarshalGeometry)
+        {
+            // The component list is read first, so that it's sent and
+            // committed with the geometry.
+            MPlug complistPlug(
+                thisMObject(), InputGeometryNode::inputComponents);
+            MPlug primGroupPlug(
+                thisMObject(), InputGeometryNode::primComponentGroup);
+            MPlug pointGroupPlug(
+                thisMObject(), InputGeometryNode::pointComponentGroup);
+            myInput->setInputComponents(dataBlock, geometryPlug, complistPlug,
+                                        primGroupPlug, pointGroupPlug);
+
+            myInput->setInputGeo(dataBlock, geometryPlug);
+
+            // After another context, the input node holds the geometry of
+            // that context, so the next normal compute sends it again.
+            myNeedToMarshalGeometry = !isNormalContext;
+        }
 
-        outputNodeIdHandle.setInt(myInput->geometryNodeId());
+        outputNodeIdHandle.setInt(myInput->outputNodeId());
 
         return MStatus::kSuccess;
     }
@@ -207,18 +267,62 @@ InputGeometryNode::compute(const MPlug &plug, MDataBlock &dataBlock)
     return MPxNode::compute(plug, dataBlock);
 }
 
-InputGeometryNode::InputGeometryNode() : myInput(NULL) {}
+InputGeometryNode::InputGeometryNode()
+    : myInput(NULL), myNeedToMarshalGeometry(true)
+{
+}
 
 InputGeometryNode::~InputGeometryNode()
 {
     clearInput();
 }
 
+MStatus
+InputGeometryNode::setDependentsDirty(const MPlug &plugBeingDirtied,
+                                      MPlugArray &affectedPlugs)
+{
+    if (affectsGeometry(plugBeingDirtied))
+    {
+        myNeedToMarshalGeometry = true;
+    }
+
+    return MPxNode::setDependentsDirty(plugBeingDirtied, affectedPlugs);
+}
+
+#if MAYA_API_VERSION >= 201600
+MStatus
+InputGeometryNode::preEvaluation(const MDGContext &context,
+                                 const MEvaluationNode &evaluationNode)
+{
+    for (MEvaluationNodeIterator nodeIt = evaluationNode.iterator();
+         !nodeIt.isDone(); nodeIt.next())
+    {
+        if (affectsGeometry(nodeIt.plug()))
+        {
+            myNeedToMarshalGeometry = true;
+        }
+    }
+
+    return MStatus::kSuccess;
+}
+#endif
+
 void
 InputGeometryNode::clearInput()
 {
     delete myInput;
     myInput = NULL;
+
+    // a new input needs all of the geometry
+    myNeedToMarshalGeometry = true;
+}
+
+bool
+InputGeometryNode::affectsGeometry(const MPlug &plug)
+{
+    return plug != InputGeometryNode::inputTransform &&
+           plug != InputGeometryNode::ignoreTransform &&
+           plug != InputGeometryNode::outputNodeId;
 }
 
 bool
@@ -24,6 +24,8 @@ public:
     static MObject materialPerFace;
     static MObject allowFacetSet;
     static MObject preserveScale;
+    static MObject singlePrecision;
+    static MObject quantizeDeltas;
     static MObject ignoreTransform;
     static MObject objectShadingGroup;
 
@@ -35,12 +37,27 @@ public:
 
     virtual MStatus compute(const MPlug &plug, MDataBlock &dataBlock);
 
+    virtual MStatus setDependentsDirty(const MPlug &plugBeingDirtied,
+                                       MPlugArray &affectedPlugs);
+
+#if MAYA_API_VERSION >= 201600
+    virtual MStatus preEvaluation(const MDGContext &context,
+                                  const MEvaluationNode &evaluationNode);
+#endif
+
 private:
     void clearInput();
     bool checkInput(MDataBlock &dataBlock);
 
+    static bool affectsGeometry(const MPlug &plug);
+
 private:
     Input *myInput;
+
+    // Whether anything other than the transform changed since the geometry
+    // was last sent. When only the transform changed, e.g. when the object
+    // is moved, the geometry is not sent again.
+    bool myNeedToMarshalGeometry;
 };
 
 #endif
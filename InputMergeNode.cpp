@@ -1,8 +1,15 @@
 #include "InputMergeNode.h"
 
 #include <maya/MFnMatrixAttribute.h>
+#include <maya/MFnMesh.h>
 #include <maya/MFnNumericAttribute.h>
+#include <maya/MFnTypedAttribute.h>
+#include <maya/MIntArray.h>
+#include <maya/MMatrix.h>
 
+#include <algorithm>
+
+#include "HoudiniApiTracer.h"
 #include "MayaTypeID.h"
 #include "hapiutil.h"
 #include "util.h"
@@ -14,6 +21,32 @@ MObject InputMergeNode::inputTransform;
 MObject InputMergeNode::inputNode;
 MObject InputMergeNode::outputNodeId;
 MObject InputMergeNode::packBeforeMerge;
+MObject InputMergeNode::combineInputs;
+MObject InputMergeNode::inputGeometry;
+MObject InputMergeNode::inputMatrix;
+MObject InputMergeNode::preserveScale;
+
+namespace
+{
+// A mesh of an input, which is combined with the others
+struct CombinedMesh
+{
+    MObject meshData;
+
+    const float *points;
+    int pointCount;
+    std::vector<int> faceCounts;
+    std::vector<int> vertexList;
+
+    double matrix[4][4];
+    double scale;
+    MString name;
+
+    size_t pointOffset;
+    size_t faceOffset;
+    size_t vertexOffset;
+};
+}
 
 void *
 InputMergeNode::creator()
@@ -26,6 +59,7 @@ InputMergeNode::initialize()
 {
     MFnMatrixAttribute mAttr;
     MFnNumericAttribute nAttr;
+    MFnTypedAttribute tAttr;
 
     InputMergeNode::inputTransform = mAttr.create(
         "inputTransform", "inputTransform");
@@ -50,21 +84,70 @@ InputMergeNode::initialize()
     nAttr.setStorable(true);
     addAttribute(InputMergeNode::packBeforeMerge);
 
+    // combines the meshes that are connected to inputGeometry into a single
+    // input node, instead of sending an input node per mesh
+    InputMergeNode::combineInputs = nAttr.create(
+        "combineInputs", "combineInputs", MFnNumericData::kBoolean, false);
+    nAttr.setCached(false);
+    nAttr.setStorable(true);
+    addAttribute(InputMergeNode::combineInputs);
+
+    // The meshes are connected here next to their inputNode, so that the
+    // merge doesn't pull their input geometry nodes when they're combined.
+    // An unconnected matrix is the identity.
+    InputMergeNode::inputGeometry = tAttr.create(
+        "inputGeometry", "inputGeometry", MFnData::kMesh);
+    tAttr.setArray(true);
+    tAttr.setCached(false);
+    tAttr.setStorable(false);
+    tAttr.setDisconnectBehavior(MFnAttribute::kDelete);
+    addAttribute(InputMergeNode::inputGeometry);
+
+    InputMergeNode::inputMatrix = mAttr.create("inputMatrix", "inputMatrix");
+    mAttr.setArray(true);
+    mAttr.setCached(false);
+    mAttr.setStorable(false);
+    mAttr.setDisconnectBehavior(MFnAttribute::kDelete);
+    addAttribute(InputMergeNode::inputMatrix);
+
+    InputMergeNode::preserveScale = nAttr.create(
+        "preserveScale", "preserveScale", MFnNumericData::kBoolean, false);
+    nAttr.setCached(false);
+    nAttr.setStorable(true);
+    addAttribute(InputMergeNode::preserveScale);
+
     attributeAffects(
         InputMergeNode::inputTransform, InputMergeNode::outputNodeId);
     attributeAffects(InputMergeNode::inputNode, InputMergeNode::outputNodeId);
     attributeAffects(InputMergeNode::packBeforeMerge, InputMergeNode::outputNodeId);
+    attributeAffects(
+        InputMergeNode::combineInputs, InputMergeNode::outputNodeId);
+    attributeAffects(
+        InputMergeNode::inputGeometry, InputMergeNode::outputNodeId);
+    attributeAffects(
+        InputMergeNode::inputMatrix, InputMergeNode::outputNodeId);
+    attributeAffects(
+        InputMergeNode::preserveScale, InputMergeNode::outputNodeId);
 
     return MStatus::kSuccess;
 }
 
-InputMergeNode::InputMergeNode() : myGeometryNodeId(-1) {}
+InputMergeNode::InputMergeNode()
+    : myGeometryNodeId(-1), myCombinedNodeId(-1), myInputCount(0)
+{
+}
 
 InputMergeNode::~InputMergeNode()
 {
     if (!Util::theHAPISession.get())
         return;
 
+    if (myCombinedNodeId >= 0)
+    {
+        CHECK_HAPI(HoudiniApi::DeleteNode(
+            Util::theHAPISession.get(), myCombinedNodeId));
+    }
+
     // the merge is a sop, so it will have a parent geo
     // and an objectMerge to remove as well
     HAPI_NodeInfo node_info;
@@ -79,6 +162,9 @@ InputMergeNode::~InputMergeNode()
 MStatus
 InputMergeNode::compute(const MPlug &plug, MDataBlock &dataBlock)
 {
+    HoudiniApiTracer::NodeScope traceScope(
+        thisMObject(), "InputMergeNode::compute");
+
     if (myGeometryNodeId == -1)
     {
         Util::PythonInterpreterLock pythonInterpreterLock;
@@ -108,21 +194,44 @@ InputMergeNode::compute(const MPlug &plug, MDataBlock &dataBlock)
 
     if (plug == InputMergeNode::outputNodeId)
     {
-        MArrayDataHandle inputNodeArrayHandle =
-            dataBlock.inputArrayValue(InputMergeNode::inputNode);
-
-        const unsigned int mergeCount = inputNodeArrayHandle.elementCount();
+        std::vector<HAPI_NodeId> inputNodeIds;
 
-        for (unsigned int i = 0; i < mergeCount; i++)
+        MPlug combineInputsPlug(thisMObject(), InputMergeNode::combineInputs);
+        if (combineInputsPlug.asBool())
         {
-            inputNodeArrayHandle.jumpToElement(i);
-            MDataHandle inputNodeHandle = inputNodeArrayHandle.inputValue();
+            combineMeshes(dataBlock, inputNodeIds);
+        }
+        else
+        {
+            MArrayDataHandle inputNodeArrayHandle =
+                dataBlock.inputArrayValue(InputMergeNode::inputNode);
+
+            const unsigned int mergeCount = inputNodeArrayHandle.elementCount();
+
+            for (unsigned int i = 0; i < mergeCount; i++)
+            {
+                inputNodeArrayHandle.jumpToElement(i);
+                MDataHandle inputNodeHandle = inputNodeArrayHandle.inputValue();
 
-            HAPI_NodeId inputNode = inputNodeHandle.asInt();
+                inputNodeIds.push_back(inputNodeHandle.asInt());
+            }
+        }
+
+        for (size_t i = 0; i < inputNodeIds.size(); i++)
+        {
+            CHECK_HAPI(HoudiniApi::ConnectNodeInput(Util::theHAPISession.get(),
+                                                    myGeometryNodeId, i,
+                                                    inputNodeIds[i], 0));
+        }
 
-            CHECK_HAPI(HoudiniApi::ConnectNodeInput(
-                Util::theHAPISession.get(), myGeometryNodeId, i, inputNode, 0));
+        // disconnect the inputs that are no longer used, e.g. the meshes that
+        // are now combined
+        for (int i = inputNodeIds.size(); i < myInputCount; i++)
+        {
+            HoudiniApi::DisconnectNodeInput(
+                Util::theHAPISession.get(), myGeometryNodeId, i);
         }
+        myInputCount = inputNodeIds.size();
 
         // Get the object merges connected to this merge node
         HAPI_NodeInfo mergeNodeInfo;
@@ -155,3 +264,201 @@ InputMergeNode::compute(const MPlug &plug, MDataBlock &dataBlock)
     return MPxNode::compute(plug, dataBlock);
 }
 
+void
+InputMergeNode::combineMeshes(MDataBlock &dataBlock,
+                              std::vector<HAPI_NodeId> &inputNodeIds)
+{
+    MPlug inputGeometryArrayPlug(thisMObject(), InputMergeNode::inputGeometry);
+    MArrayDataHandle inputGeometryArrayHandle =
+        dataBlock.inputArrayValue(InputMergeNode::inputGeometry);
+    MArrayDataHandle inputMatrixArrayHandle =
+        dataBlock.inputArrayValue(InputMergeNode::inputMatrix);
+
+    MPlug preserveScalePlug(thisMObject(), InputMergeNode::preserveScale);
+    const double scale = preserveScalePlug.asBool() ? 0.01 : 1.0;
+
+    // Gather the meshes from the data block. The Maya API is only used on
+    // this thread.
+    std::vector<CombinedMesh> meshes;
+    std::vector<unsigned int> meshIndices;
+    size_t pointCount  = 0;
+    size_t faceCount   = 0;
+    size_t vertexCount = 0;
+    for (unsigned int i = 0; i < inputGeometryArrayHandle.elementCount(); i++)
+    {
+        inputGeometryArrayHandle.jumpToArrayElement(i);
+        const unsigned int index = inputGeometryArrayHandle.elementIndex();
+
+        MObject meshData = inputGeometryArrayHandle.inputValue().data();
+        if (meshData.isNull() || !meshData.hasFn(MFn::kMeshData))
+        {
+            continue;
+        }
+        meshIndices.push_back(index);
+
+        meshes.push_back(CombinedMesh());
+        CombinedMesh &mesh = meshes.back();
+
+        MFnMesh meshFn(meshData);
+        mesh.meshData   = meshData;
+        mesh.points     = meshFn.getRawPoints(NULL);
+        mesh.pointCount = meshFn.numVertices();
+        {
+            MIntArray faceCounts;
+            MIntArray vertexList;
+            meshFn.getVertices(faceCounts, vertexList);
+
+            mesh.faceCounts.resize(faceCounts.length());
+            mesh.vertexList.resize(vertexList.length());
+            if (faceCounts.length())
+            {
+                faceCounts.get(&mesh.faceCounts[0]);
+            }
+            if (vertexList.length())
+            {
+                vertexList.get(&mesh.vertexList[0]);
+            }
+        }
+
+        MMatrix matrix;
+        if (inputMatrixArrayHandle.jumpToElement(index))
+        {
+            matrix = inputMatrixArrayHandle.inputValue().asMatrix();
+        }
+        matrix.get(mesh.matrix);
+        mesh.scale = scale;
+
+        MPlug geometryPlug =
+            inputGeometryArrayPlug.elementByLogicalIndex(index);
+        mesh.name = Util::getNodeName(Util::plugSource(geometryPlug).node());
+
+        mesh.pointOffset  = pointCount;
+        mesh.faceOffset   = faceCount;
+        mesh.vertexOffset = vertexCount;
+        pointCount += mesh.pointCount;
+        faceCount += mesh.faceCounts.size();
+        vertexCount += mesh.vertexList.size();
+    }
+
+    std::sort(meshIndices.begin(), meshIndices.end());
+
+    // Only the inputs that aren't combined are pulled, and sent through their
+    // own input node.
+    MPlug inputNodeArrayPlug(thisMObject(), InputMergeNode::inputNode);
+    MIntArray inputNodeIndices;
+    inputNodeArrayPlug.getExistingArrayAttributeIndices(inputNodeIndices);
+    for (unsigned int i = 0; i < inputNodeIndices.length(); i++)
+    {
+        const unsigned int index = inputNodeIndices[i];
+        if (std::binary_search(meshIndices.begin(), meshIndices.end(), index))
+        {
+            continue;
+        }
+
+        MDataHandle inputNodeHandle = dataBlock.inputValue(
+            inputNodeArrayPlug.elementByLogicalIndex(index));
+        inputNodeIds.push_back(inputNodeHandle.asInt());
+    }
+
+    if (meshes.empty())
+    {
+        return;
+    }
+
+    if (myCombinedNodeId < 0)
+    {
+        CHECK_HAPI(HoudiniApi::CreateInputNode(Util::theHAPISession.get(), -1,
+                                               &myCombinedNodeId, NULL));
+        if (!Util::statusCheckLoop())
+        {
+            DISPLAY_ERROR(
+                MString("Unexpected error when creating combined input."));
+        }
+    }
+
+    std::vector<float> points(pointCount * 3);
+    std::vector<int> faceCounts(faceCount);
+    std::vector<int> vertexList(vertexCount);
+    std::vector<const char *> names(faceCount);
+
+    std::vector<const char *> meshNames(meshes.size());
+    for (size_t i = 0; i < meshes.size(); i++)
+    {
+        meshNames[i] = meshes[i].name.asChar();
+    }
+
+    // Transform and pack the meshes on worker threads. The transforms are
+    // baked into the points, since the meshes share one input node.
+    Util::parallelFor(meshes.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t iMesh = begin; iMesh < end; iMesh++)
+        {
+            const CombinedMesh &mesh = meshes[iMesh];
+            const double(*m)[4]      = mesh.matrix;
+
+            float *dstPoints = &points[mesh.pointOffset * 3];
+            for (int i = 0; i < mesh.pointCount; i++)
+            {
+                const float *p = mesh.points + i * 3;
+                for (int j = 0; j < 3; j++)
+                {
+                    dstPoints[i * 3 + j] = static_cast<float>(
+                        (p[0] * m[0][j] + p[1] * m[1][j] + p[2] * m[2][j] +
+                         m[3][j]) *
+                        mesh.scale);
+                }
+            }
+
+            // reverse the winding order, and offset the points
+            size_t srcVertex = 0;
+            size_t dstVertex = mesh.vertexOffset;
+            for (size_t i = 0; i < mesh.faceCounts.size(); i++)
+            {
+                const int faceVertexCount = mesh.faceCounts[i];
+                faceCounts[mesh.faceOffset + i] = faceVertexCount;
+                names[mesh.faceOffset + i]      = meshNames[iMesh];
+
+                for (int j = faceVertexCount - 1; j >= 0; j--)
+                {
+                    vertexList[dstVertex++] = mesh.vertexList[srcVertex + j] +
+                                              mesh.pointOffset;
+                }
+                srcVertex += faceVertexCount;
+            }
+        }
+    });
+
+    HAPI_PartInfo partInfo;
+    HoudiniApi::PartInfo_Init(&partInfo);
+    partInfo.id          = 0;
+    partInfo.faceCount   = faceCount;
+    partInfo.vertexCount = vertexCount;
+    partInfo.pointCount  = pointCount;
+
+    CHECK_HAPI(HoudiniApi::SetPartInfo(
+        Util::theHAPISession.get(), myCombinedNodeId, 0, &partInfo));
+    // the meshes may have no faces, or no points at all
+    if (faceCount > 0)
+    {
+        CHECK_HAPI(HoudiniApi::SetFaceCounts(
+            Util::theHAPISession.get(), myCombinedNodeId, 0,
+            faceCounts.data(), 0, partInfo.faceCount));
+        CHECK_HAPI(
+            hapiSetPrimAttribute(myCombinedNodeId, 0, 1, "name", names));
+    }
+    if (vertexCount > 0)
+    {
+        CHECK_HAPI(HoudiniApi::SetVertexList(
+            Util::theHAPISession.get(), myCombinedNodeId, 0,
+            vertexList.data(), 0, partInfo.vertexCount));
+    }
+    if (pointCount > 0)
+    {
+        CHECK_HAPI(
+            hapiSetPointAttribute(myCombinedNodeId, 0, 3, "P", points));
+    }
+
+    CHECK_HAPI(
+        HoudiniApi::CommitGeo(Util::theHAPISession.get(), myCombinedNodeId));
+
+    inputNodeIds.insert(inputNodeIds.begin(), myCombinedNodeId);
+}
@@ -5,6 +5,8 @@
 
 #include <HAPI/HAPI_Common.h>
 
+#include <vector>
+
 class InputMergeNode : public MPxNode
 {
 public:
@@ -21,6 +23,13 @@ public:
     static MObject outputNodeId;
 
     static MObject packBeforeMerge;
+    static MObject combineInputs;
+
+    // The meshes and matrices of the inputs that are combined, at the same
+    // indices as their inputNode, and the scale option for the combined mesh.
+    static MObject inputGeometry;
+    static MObject inputMatrix;
+    static MObject preserveScale;
 
 public:
     InputMergeNode();
@@ -32,8 +41,19 @@ private:
     void clearInput();
     bool checkInput(MDataBlock &dataBlock);
 
+    // Combines the meshes that are connected to inputGeometry into a single
+    // part, and returns the node ids of the inputs that aren't meshes.
+    void combineMeshes(MDataBlock &dataBlock,
+                       std::vector<HAPI_NodeId> &inputNodeIds);
+
 private:
     HAPI_NodeId myGeometryNodeId;
+
+    // input node that holds the combined meshes
+    HAPI_NodeId myCombinedNodeId;
+
+    // number of inputs connected to the merge
+    int myInputCount;
 };
 
 #endif
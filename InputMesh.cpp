@@ -10,21 +10,180 @@
 #include <maya/MFnMesh.h>
 #include <maya/MFnSingleIndexedComponent.h>
 #include <maya/MIntArray.h>
-#include <maya/MItMeshPolygon.h>
 #include <maya/MMatrix.h>
+#include <maya/MObjectHandle.h>
 #include <maya/MPlug.h>
 #include <maya/MPlugArray.h>
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <mutex>
+#include <unordered_set>
+
 #include "hapiutil.h"
 #include "types.h"
 #include "util.h"
 
-InputMesh::InputMesh() : Input()
+struct SharedInputNode
+{
+    HAPI_NodeId nodeId;
+    HAPI_NodeId parentId;
+    int refCount;
+    bool isPublished;
+    unsigned long long contentHash;
+};
+
+namespace
+{
+template <typename T>
+unsigned long long
+hashValue(unsigned long long hash, const T &value)
+{
+    return Util::hashBytes(hash, &value, sizeof(T));
+}
+
+template <typename T>
+unsigned long long
+hashVector(unsigned long long hash, const std::vector<T> &values)
+{
+    return Util::hashBytes(
+        hash, values.empty() ? NULL : &values[0], values.size() * sizeof(T));
+}
+
+// Hashes a Maya array, e.g. MIntArray or MFloatArray, of T.
+template <typename T, typename MArray>
+unsigned long long
+hashArray(unsigned long long hash, const MArray &array)
+{
+    std::vector<T> values(array.length());
+    if (!values.empty())
+    {
+        array.get(&values[0]);
+    }
+
+    return hashVector(hash, values);
+}
+
+unsigned long long
+hashString(unsigned long long hash, const MString &str)
+{
+    return Util::hashBytes(hash, str.asChar(), strlen(str.asChar()) + 1);
+}
+
+unsigned long long
+hashStrings(unsigned long long hash, const MStringArray &strs)
+{
+    hash = hashValue(hash, strs.length());
+    for (unsigned int i = 0; i < strs.length(); i++)
+    {
+        hash = hashString(hash, strs[i]);
+    }
+
+    return hash;
+}
+
+// Key of the edge between two points, regardless of their order.
+unsigned long long
+edgeKey(int point0, int point1)
+{
+    const unsigned int low  = (std::min)(point0, point1);
+    const unsigned int high = (std::max)(point0, point1);
+    return (static_cast<unsigned long long>(low) << 32) | high;
+}
+
+// The deltas of the points from the rest points are quantized to 16 bits.
+// Once the step of the deltas would be larger than this, the points are sent
+// as the new rest points instead.
+const float theMaxDeltaStep      = 1.0e-4f;
+const float theMaxQuantizedDelta = 32767.0f;
+
+const char *theDeltaAttributeNames[] = {
+    "maya_delta_x", "maya_delta_y", "maya_delta_z"};
+
+// The delta attributes are removed, so that the asset only gets P.
+const char *theDeltaSnippet =
+    "@P += set(i@maya_delta_x, i@maya_delta_y, i@maya_delta_z) *\n"
+    "      detail(0, \"maya_delta_scale\");\n"
+    "if (@ptnum == 0)\n"
+    "{\n"
+    "    removepointattrib(geoself(), \"maya_delta_x\");\n"
+    "    removepointattrib(geoself(), \"maya_delta_y\");\n"
+    "    removepointattrib(geoself(), \"maya_delta_z\");\n"
+    "    removedetailattrib(geoself(), \"maya_delta_scale\");\n"
+    "}\n";
+
+// Beyond this number of runs, a group membership is sent as a whole.
+const size_t theMaxGroupRuns = 32;
+
+// Appends the elements of a component, which are fetched in one call.
+void
+appendElements(const MObject &compObj, std::vector<int> &elements)
+{
+    MIntArray componentElements;
+    MFnSingleIndexedComponent(compObj).getElements(componentElements);
+
+    const size_t offset = elements.size();
+    elements.resize(offset + componentElements.length());
+    if (componentElements.length())
+    {
+        componentElements.get(&elements[offset]);
+    }
+}
+
+// Encodes the elements of a group as runs of consecutive elements, i.e. pairs
+// of start and length. Elements that are out of range are skipped.
+void
+encodeRuns(std::vector<int> &elements,
+           int elementCount,
+           std::vector<int> &runs)
+{
+    std::sort(elements.begin(), elements.end());
+
+    runs.clear();
+    for (size_t i = 0; i < elements.size(); i++)
+    {
+        const int element = elements[i];
+        if (element < 0 || element >= elementCount)
+        {
+            continue;
+        }
+
+        if (!runs.empty() && runs[runs.size() - 2] + runs.back() >= element)
+        {
+            // extend the last run, unless the element is a duplicate
+            if (runs[runs.size() - 2] + runs.back() == element)
+            {
+                runs.back()++;
+            }
+            continue;
+        }
+
+        runs.push_back(element);
+        runs.push_back(1);
+    }
+}
+
+// Input nodes are shared by the mesh inputs that marshal the same content,
+// e.g. when several assets read the same Maya mesh. The content is sent to
+// the node of one input, and the others use that node as long as their
+// content stays the same. A node is deleted once it's no longer used.
+std::mutex theSharedInputNodesMutex;
+std::unordered_map<unsigned long long, SharedInputNode *> theSharedInputNodes;
+
+// Number of the mesh inputs that read each source. Only the inputs of the
+// same source can have the same content, so an input that is the only one
+// of its source doesn't hash its content.
+std::unordered_map<unsigned long long, int> theInputSourceCounts;
+
+SharedInputNode *
+createNode()
 {
     Util::PythonInterpreterLock pythonInterpreterLock;
 
-    HAPI_NodeId nodeId;
-    CHECK_HAPI(HoudiniApi::CreateInputNode(Util::theHAPISession.get(), -1, &nodeId, NULL));
+    HAPI_NodeId nodeId = -1;
+    CHECK_HAPI(HoudiniApi::CreateInputNode(
+        Util::theHAPISession.get(), -1, &nodeId, NULL));
     if (!Util::statusCheckLoop())
     {
         DISPLAY_ERROR(MString("Unexpected error when creating input mesh."));
@@ -33,15 +192,197 @@ InputMesh::InputMesh() : Input()
     HAPI_NodeInfo nodeInfo;
     HoudiniApi::GetNodeInfo(Util::theHAPISession.get(), nodeId, &nodeInfo);
 
-    setTransformNodeId(nodeInfo.parentId);
-    setGeometryNodeId(nodeId);
+    SharedInputNode *node = new SharedInputNode;
+    node->nodeId          = nodeId;
+    node->parentId        = nodeInfo.parentId;
+    node->refCount        = 1;
+    node->isPublished     = false;
+    node->contentHash     = 0;
+
+    return node;
 }
 
-InputMesh::~InputMesh()
+// Returns whether other inputs use the node too.
+bool
+isNodeShared(const SharedInputNode *node)
+{
+    std::lock_guard<std::mutex> lock(theSharedInputNodesMutex);
+
+    return node->refCount > 1;
+}
+
+void
+unregisterSourceLocked(unsigned long long sourceKey)
+{
+    std::unordered_map<unsigned long long, int>::iterator iter =
+        theInputSourceCounts.find(sourceKey);
+    if (iter != theInputSourceCounts.end() && --iter->second <= 0)
+    {
+        theInputSourceCounts.erase(iter);
+    }
+}
+
+void
+unregisterSource(unsigned long long sourceKey)
+{
+    std::lock_guard<std::mutex> lock(theSharedInputNodesMutex);
+
+    unregisterSourceLocked(sourceKey);
+}
+
+// Moves an input from one source to another, and returns whether other
+// inputs read the new source.
+bool
+registerSource(unsigned long long oldSourceKey,
+               bool hadSourceKey,
+               unsigned long long sourceKey)
 {
-    if (!Util::theHAPISession.get())
+    std::lock_guard<std::mutex> lock(theSharedInputNodesMutex);
+
+    if (!hadSourceKey || oldSourceKey != sourceKey)
+    {
+        if (hadSourceKey)
+        {
+            unregisterSourceLocked(oldSourceKey);
+        }
+        theInputSourceCounts[sourceKey]++;
+    }
+
+    return theInputSourceCounts[sourceKey] > 1;
+}
+
+void
+unpublishNode(SharedInputNode *node)
+{
+    std::lock_guard<std::mutex> lock(theSharedInputNodesMutex);
+
+    if (!node->isPublished)
+    {
         return;
-    CHECK_HAPI(HoudiniApi::DeleteNode(Util::theHAPISession.get(), geometryNodeId()));
+    }
+
+    theSharedInputNodes.erase(node->contentHash);
+    node->isPublished = false;
+}
+
+void
+publishNode(SharedInputNode *node, unsigned long long contentHash)
+{
+    std::lock_guard<std::mutex> lock(theSharedInputNodesMutex);
+
+    if (node->isPublished)
+    {
+        if (node->contentHash == contentHash)
+        {
+            return;
+        }
+
+        theSharedInputNodes.erase(node->contentHash);
+    }
+
+    // another node may already have the same content
+    node->isPublished = theSharedInputNodes
+                            .insert(std::make_pair(contentHash, node))
+                            .second;
+    node->contentHash = contentHash;
+}
+
+SharedInputNode *
+findNode(unsigned long long contentHash)
+{
+    std::lock_guard<std::mutex> lock(theSharedInputNodesMutex);
+
+    std::unordered_map<unsigned long long, SharedInputNode *>::iterator iter =
+        theSharedInputNodes.find(contentHash);
+    if (iter == theSharedInputNodes.end())
+    {
+        return NULL;
+    }
+
+    iter->second->refCount++;
+    return iter->second;
+}
+
+void
+releaseNode(SharedInputNode *node)
+{
+    {
+        std::lock_guard<std::mutex> lock(theSharedInputNodesMutex);
+
+        if (--node->refCount > 0)
+        {
+            return;
+        }
+
+        if (node->isPublished)
+        {
+            theSharedInputNodes.erase(node->contentHash);
+        }
+    }
+
+    if (Util::theHAPISession.get())
+    {
+        CHECK_HAPI(HoudiniApi::DeleteNode(
+            Util::theHAPISession.get(), node->nodeId));
+    }
+
+    delete node;
+}
+
+void
+deleteVertexAttribute(HAPI_NodeId nodeId,
+                      const MString &name,
+                      HAPI_StorageType storage,
+                      int tupleSize)
+{
+    HAPI_AttributeInfo attributeInfo;
+    attributeInfo.exists    = true;
+    attributeInfo.owner     = HAPI_ATTROWNER_VERTEX;
+    attributeInfo.storage   = storage;
+    attributeInfo.count     = 1;
+    attributeInfo.tupleSize = tupleSize;
+
+    HoudiniApi::DeleteAttribute(Util::theHAPISession.get(), nodeId, 0,
+                                name.asChar(), &attributeInfo);
+}
+}
+
+InputMesh::InputMesh()
+    : Input(),
+      myUVSetCount(0),
+      myNode(NULL),
+      mySharedNode(NULL),
+      myHasComponents(false),
+      myContentTransformKey(0),
+      myDeltaNodeId(-1),
+      myGroupRunsUnknown(false),
+      mySourceKey(0),
+      myHasSourceKey(false),
+      myHasDeltaAttributes(false)
+{
+    myNode = createNode();
+
+    setTransformNodeId(myNode->parentId);
+    setGeometryNodeId(myNode->nodeId);
+}
+
+InputMesh::~InputMesh()
+{
+    detachSharedNode();
+
+    if (myHasSourceKey)
+    {
+        unregisterSource(mySourceKey);
+    }
+
+    if (myDeltaNodeId >= 0 && Util::theHAPISession.get())
+    {
+        CHECK_HAPI(HoudiniApi::DeleteNode(
+            Util::theHAPISession.get(), myDeltaNodeId));
+    }
+
+    // the node is kept while other inputs use it
+    releaseNode(myNode);
 }
 
 Input::AssetInputType
@@ -50,6 +391,52 @@ InputMesh::assetInputType() const
     return Input::AssetInputType_Mesh;
 }
 
+HAPI_NodeId
+InputMesh::outputNodeId() const
+{
+    // the node is only shared without the deltas
+    if (myQuantizeDeltas && myDeltaNodeId >= 0 && !mySharedNode)
+    {
+        return myDeltaNodeId;
+    }
+
+    return geometryNodeId();
+}
+
+void
+InputMesh::setInputTransform(MDataHandle &dataHandle)
+{
+    updateTransform(dataHandle);
+
+    // The object of a node has the transform of every input that uses it, so
+    // another transform is only sent once this input has a node of its own.
+    if (transformKey() != myContentTransformKey &&
+        (mySharedNode || isNodeShared(myNode)))
+    {
+        return;
+    }
+
+    sendTransform();
+}
+
+bool
+InputMesh::needsInputGeo()
+{
+    if (transformKey() == myContentTransformKey)
+    {
+        return false;
+    }
+
+    if (mySharedNode || isNodeShared(myNode))
+    {
+        return true;
+    }
+
+    // other inputs no longer get the node for the previous transform
+    unpublishNode(myNode);
+    return false;
+}
+
 void
 InputMesh::setInputComponents(MDataBlock &dataBlock,
                               const MPlug &geoPlug,
@@ -67,213 +454,768 @@ InputMesh::setInputComponents(MDataBlock &dataBlock,
     MObject meshObj        = meshHandle.asMesh();
     MFnMesh meshFn(meshObj);
 
-    unsigned i;
-    int j;
-    MIntArray faceIds;
-    MIntArray vertIds;
-    MIntArray edgeIds;
-    for (i = 0; i < compListFn.length(); i++)
+    std::vector<int> faceIds;
+    std::vector<int> vertIds;
+    for (unsigned int i = 0; i < compListFn.length(); i++)
     {
         MObject comp = compListFn[i];
         if (comp.apiType() == MFn::kMeshPolygonComponent)
         {
-            MFnSingleIndexedComponent siComp(comp);
-            for (j = 0; j < siComp.elementCount(); j++)
-                faceIds.append(siComp.element(j));
+            appendElements(comp, faceIds);
         }
         if (comp.apiType() == MFn::kMeshVertComponent)
         {
-            MFnSingleIndexedComponent siComp(comp);
-            for (j = 0; j < siComp.elementCount(); j++)
-                vertIds.append(siComp.element(j));
+            appendElements(comp, vertIds);
         }
 
         if (comp.apiType() == MFn::kMeshEdgeComponent)
         {
             // should convert the edge component to a point group in some
             // meaningful way
-            MFnSingleIndexedComponent siComp(comp);
-            for (j = 0; j < siComp.elementCount(); j++)
-                edgeIds.append(siComp.element(j));
         }
         if (comp.apiType() == MFn::kMeshVtxFaceComponent)
         {
-            // unfortunately, setAttr doesn't support vertexFace components
-            // for a componentList attr: may need a command to set these
-            // MFnDoubleIndexedComponent doComp( comp );
+            // unfortunately, setAttr doesn't support vertexFace components
+            // for a componentList attr: may need a command to set these
+            // MFnDoubleIndexedComponent doComp( comp );
+        }
+    }
+
+    // The components are sent by setInputGeo(), which commits them with the
+    // rest of the geometry.
+    encodeRuns(faceIds, meshFn.numPolygons(), myFaceRuns);
+    encodeRuns(vertIds, meshFn.numVertices(), myVertRuns);
+    myPrimComponentGroup  = primGroupPlug.asString();
+    myPointComponentGroup = pointGroupPlug.asString();
+
+    // The component groups are only for this input, so it sends its own
+    // content to a node that no other input uses.
+    myHasComponents = !myFaceRuns.empty() || !myVertRuns.empty();
+}
+
+void
+InputMesh::processComponents(const MFnMesh &meshFn)
+{
+    unsigned long long componentsHash = Util::hashSeed;
+    componentsHash = hashVector(componentsHash, myFaceRuns);
+    componentsHash = hashVector(componentsHash, myVertRuns);
+    componentsHash = hashString(componentsHash, myPrimComponentGroup);
+    componentsHash = hashString(componentsHash, myPointComponentGroup);
+    if (!isChannelChanged("components", componentsHash))
+    {
+        return;
+    }
+
+    MStringArray primComponentGroupNames;
+    MStringArray pointComponentGroupNames;
+
+    if (!myFaceRuns.empty())
+    {
+        MString primGroupName = myPrimComponentGroup;
+        if (primGroupName == "")
+        {
+            primGroupName = "inputPrimitiveComponent";
+        }
+        primComponentGroupNames.append(primGroupName);
+
+        setGroupMembership(HAPI_GROUPTYPE_PRIM, primGroupName, myFaceRuns,
+                           meshFn.numPolygons());
+    }
+    if (!myVertRuns.empty())
+    {
+        MString pointGroupName = myPointComponentGroup;
+        if (pointGroupName == "")
+        {
+            pointGroupName = "inputPointComponent";
+        }
+        pointComponentGroupNames.append(pointGroupName);
+
+        setGroupMembership(HAPI_GROUPTYPE_POINT, pointGroupName, myVertRuns,
+                           meshFn.numVertices());
+    }
+
+    deleteStaleGroups(HAPI_GROUPTYPE_PRIM, myPrimComponentGroupNames,
+                      primComponentGroupNames, myPrimGroupNames);
+    deleteStaleGroups(HAPI_GROUPTYPE_POINT, myPointComponentGroupNames,
+                      pointComponentGroupNames, myPointGroupNames);
+}
+
+void
+InputMesh::setInputGeo(MDataBlock &dataBlock, const MPlug &plug)
+{
+    MDataHandle dataHandle = dataBlock.inputValue(plug);
+
+    // extract mesh data from Maya
+    MObject meshObj = dataHandle.asMesh();
+
+    MFnMesh meshFn(meshObj);
+
+    // get face data
+    std::vector<int> vertexCount;
+    std::vector<int> vertexList;
+    {
+        MIntArray mayaVertexCount;
+        MIntArray mayaVertexList;
+        meshFn.getVertices(mayaVertexCount, mayaVertexList);
+
+        vertexCount.resize(mayaVertexCount.length());
+        mayaVertexCount.get(&vertexCount[0]);
+
+        vertexList.resize(mayaVertexList.length());
+        mayaVertexList.get(&vertexList[0]);
+    }
+    Util::reverseWindingOrder(vertexList, vertexCount);
+
+    // Use the node of another input that already has the same content. The
+    // component groups are only for this input, so its node isn't shared
+    // when it has some. The content is only hashed when another input reads
+    // the same source, since no other input can have the same content.
+    const unsigned long long newSourceKey = sourceKey(plug);
+    const bool hasOtherInputs =
+        registerSource(mySourceKey, myHasSourceKey, newSourceKey);
+    mySourceKey    = newSourceKey;
+    myHasSourceKey = true;
+
+    const bool isShareable = !myHasComponents && !myQuantizeDeltas &&
+                             hasOtherInputs;
+    unsigned long long contentHash = 0;
+    if (isShareable)
+    {
+        contentHash = hashContent(meshFn, vertexCount, vertexList);
+        if (attachSharedNode(contentHash))
+        {
+            return;
+        }
+    }
+
+    detachSharedNode();
+    separateNode();
+
+    // Only the channels that changed since the last time are sent, e.g. a
+    // deformation only sends P. The input node keeps the other attributes
+    // and groups as long as the topology doesn't change.
+    unsigned long long topologyHash = Util::hashSeed;
+    topologyHash = hashValue(topologyHash, meshFn.numVertices());
+    topologyHash = hashVector(topologyHash, vertexCount);
+    topologyHash = hashVector(topologyHash, vertexList);
+
+    // set up part info
+    HAPI_PartInfo partInfo;
+    HoudiniApi::PartInfo_Init(&partInfo);
+    partInfo.id          = 0;
+    partInfo.faceCount   = vertexCount.size();
+    partInfo.vertexCount = vertexList.size();
+    partInfo.pointCount  = meshFn.numVertices();
+
+    if (isChannelChanged("topology", topologyHash))
+    {
+        // Everything is sent again for the new topology
+        myChannelHashes.clear();
+        myChannelHashes["topology"] = topologyHash;
+        myGroupRuns.clear();
+        myGroupRunsUnknown = true;
+        myRestPointBuffer.clear();
+
+        // Set the data
+        HoudiniApi::SetPartInfo(
+            Util::theHAPISession.get(), geometryNodeId(), 0, &partInfo);
+        HoudiniApi::SetFaceCounts(Util::theHAPISession.get(), geometryNodeId(),
+                                  0, &vertexCount[0], 0, partInfo.faceCount);
+        HoudiniApi::SetVertexList(Util::theHAPISession.get(), geometryNodeId(),
+                                  0, &vertexList[0], 0, partInfo.vertexCount);
+    }
+
+    // Set position attributes.
+    if (myQuantizeDeltas)
+    {
+        processPointDeltas(meshFn);
+    }
+    else
+    {
+        removePointDeltas();
+        processPoints(meshFn);
+    }
+
+    // HACK: For some reason if processSets is called after processUVs, the part
+    //       size and the membership in Maya can get out of sync when custom
+    //       sets are utilized, which results in a crash.
+    processSets(plug, meshFn);
+
+    // the groups of the input components, after the sets that they may
+    // replace
+    processComponents(meshFn);
+
+    // normals
+    processNormals(meshFn, vertexCount, vertexList);
+
+    // UVs
+    processUVs(meshFn, vertexCount, vertexList);
+
+    // Colors and Alphas
+    processColorSets(meshFn, vertexCount, vertexList);
+
+    {
+        MObject sourceNodeObj = Util::plugSource(plug).node();
+
+        unsigned long long nameHash = Util::hashSeed;
+        nameHash = hashValue(nameHash, MObjectHandle(sourceNodeObj).hashCode());
+        nameHash = hashString(nameHash, Util::getNodeName(sourceNodeObj));
+        nameHash = hashValue(nameHash, partInfo.faceCount);
+        if (isChannelChanged("name", nameHash))
+        {
+            setInputName(HAPI_ATTROWNER_PRIM, partInfo.faceCount, plug);
+        }
+    }
+
+    // Commit it
+    HoudiniApi::CommitGeo(Util::theHAPISession.get(), geometryNodeId());
+
+    if (!isShareable)
+    {
+        unpublishNode(myNode);
+    }
+    else
+    {
+        publishNode(myNode, contentHash);
+        myContentTransformKey = transformKey();
+    }
+}
+
+unsigned long long
+InputMesh::sourceKey(const MPlug &plug) const
+{
+    // the source, which also determines the name and the sets
+    const MPlug sourcePlug      = Util::plugSource(plug);
+    const MObject sourceNodeObj = sourcePlug.node();
+    unsigned long long hash     = Util::hashSeed;
+    hash = hashValue(hash, MObjectHandle(sourceNodeObj).hashCode());
+    hash = hashString(hash, Util::getNodeName(sourceNodeObj));
+    hash = hashString(hash, sourcePlug.partialName());
+
+    hash = hashValue(hash, myUnlockNormals);
+    hash = hashValue(hash, myMatPerFace);
+    hash = hashValue(hash, myAllowFacetSet);
+    hash = hashValue(hash, myPreserveScale);
+
+    return hash;
+}
+
+unsigned long long
+InputMesh::hashContent(const MFnMesh &meshFn,
+                       const std::vector<int> &vertexCount,
+                       const std::vector<int> &vertexList) const
+{
+    unsigned long long hash = mySourceKey;
+    hash = hashValue(hash, transformKey());
+
+    hash = hashValue(hash, meshFn.numVertices());
+    hash = hashVector(hash, vertexCount);
+    hash = hashVector(hash, vertexList);
+    hash = Util::hashBytes(hash, meshFn.getRawPoints(NULL),
+                           meshFn.numVertices() * 3 * sizeof(float));
+
+    MIntArray counts;
+    MIntArray ids;
+    meshFn.getNormalIds(counts, ids);
+    hash = hashArray<int>(hash, ids);
+    hash = Util::hashBytes(hash, meshFn.getRawNormals(NULL),
+                           meshFn.numNormals() * 3 * sizeof(float));
+
+    MStringArray uvSetNames;
+    meshFn.getUVSetNames(uvSetNames);
+    hash = hashString(hash, meshFn.currentUVSetName());
+    hash = hashStrings(hash, uvSetNames);
+    for (unsigned int i = 0; i < uvSetNames.length(); i++)
+    {
+        MFloatArray uArray;
+        MFloatArray vArray;
+        meshFn.getAssignedUVs(counts, ids, &uvSetNames[i]);
+        meshFn.getUVs(uArray, vArray, &uvSetNames[i]);
+        hash = hashArray<int>(hash, counts);
+        hash = hashArray<int>(hash, ids);
+        hash = hashArray<float>(hash, uArray);
+        hash = hashArray<float>(hash, vArray);
+    }
+
+    MStringArray colorSetNames;
+    meshFn.getColorSetNames(colorSetNames);
+    hash = hashString(hash, meshFn.currentColorSetName());
+    hash = hashStrings(hash, colorSetNames);
+    std::vector<float> colorBuffer;
+    for (unsigned int i = 0; i < colorSetNames.length(); i++)
+    {
+        MColorArray colors;
+        meshFn.getFaceVertexColors(colors, &colorSetNames[i]);
+        colorBuffer.resize(colors.length() * 4);
+        if (colors.length())
+        {
+            colors.get(reinterpret_cast<float(*)[4]>(&colorBuffer[0]));
+        }
+        hash = hashValue(
+            hash,
+            static_cast<int>(meshFn.getColorRepresentation(colorSetNames[i])));
+        hash = hashVector(hash, colorBuffer);
+    }
+
+    return hash;
+}
+
+unsigned long long
+InputMesh::transformKey() const
+{
+    unsigned long long key = Util::hashSeed;
+    key = hashValue(key, myIgnoreTransform);
+    key = hashValue(key, myHasTransform);
+    if (myHasTransform)
+    {
+        key = hashValue(key, myTransform.position);
+        key = hashValue(key, myTransform.rotationEuler);
+        key = hashValue(key, myTransform.scale);
+        key = hashValue(key, myTransform.shear);
+        key = hashValue(key, static_cast<int>(myTransform.rotationOrder));
+        key = hashValue(key, static_cast<int>(myTransform.rstOrder));
+    }
+
+    return key;
+}
+
+bool
+InputMesh::attachSharedNode(unsigned long long contentHash)
+{
+    if (mySharedNode && mySharedNode->isPublished &&
+        mySharedNode->contentHash == contentHash)
+    {
+        return true;
+    }
+
+    // this input's own node may already have the content
+    if (myNode->isPublished && myNode->contentHash == contentHash)
+    {
+        return false;
+    }
+
+    SharedInputNode *node = findNode(contentHash);
+    if (!node)
+    {
+        return false;
+    }
+
+    detachSharedNode();
+    mySharedNode          = node;
+    myContentTransformKey = transformKey();
+
+    setTransformNodeId(mySharedNode->parentId);
+    setGeometryNodeId(mySharedNode->nodeId);
+
+    return true;
+}
+
+void
+InputMesh::detachSharedNode()
+{
+    if (!mySharedNode)
+    {
+        return;
+    }
+
+    releaseNode(mySharedNode);
+    mySharedNode = NULL;
+
+    setTransformNodeId(myNode->parentId);
+    setGeometryNodeId(myNode->nodeId);
+    sendTransform();
+}
+
+bool
+InputMesh::separateNode()
+{
+    if (!isNodeShared(myNode))
+    {
+        return false;
+    }
+
+    // The other inputs keep the node with its current content.
+    releaseNode(myNode);
+    myNode = createNode();
+
+    setTransformNodeId(myNode->parentId);
+    setGeometryNodeId(myNode->nodeId);
+    sendTransform();
+
+    // the wrangle reads the previous node
+    if (myDeltaNodeId >= 0)
+    {
+        CHECK_HAPI(HoudiniApi::DeleteNode(
+            Util::theHAPISession.get(), myDeltaNodeId));
+        myDeltaNodeId = -1;
+    }
+
+    // nothing has been sent to the new node yet
+    myChannelHashes.clear();
+    myGroupRuns.clear();
+    myGroupRunsUnknown = false;
+    myRestPointBuffer.clear();
+    myUVSetCount = 0;
+    myCdAttributeNames.clear();
+    myAlphaAttributeNames.clear();
+    myPointGroupNames.clear();
+    myPrimGroupNames.clear();
+    myPointComponentGroupNames.clear();
+    myPrimComponentGroupNames.clear();
+    myHasDeltaAttributes = false;
+
+    return true;
+}
+
+bool
+InputMesh::isChannelChanged(const char *channel, unsigned long long hash)
+{
+    std::unordered_map<std::string, unsigned long long>::iterator iter =
+        myChannelHashes.find(channel);
+    if (iter != myChannelHashes.end() && iter->second == hash)
+    {
+        return false;
+    }
+
+    myChannelHashes[channel] = hash;
+    return true;
+}
+
+void
+InputMesh::deleteStaleGroups(HAPI_GroupType groupType,
+                             MStringArray &sentGroupNames,
+                             const MStringArray &groupNames,
+                             const MStringArray &otherGroupNames)
+{
+    for (unsigned int i = 0; i < sentGroupNames.length(); i++)
+    {
+        const MString &groupName = sentGroupNames[i];
+        if (groupNames.indexOf(groupName) >= 0 ||
+            otherGroupNames.indexOf(groupName) >= 0)
+        {
+            continue;
         }
+
+        CHECK_HAPI(HoudiniApi::DeleteGroup(Util::theHAPISession.get(),
+                                           geometryNodeId(), 0, groupType,
+                                           groupName.asChar()));
+        myGroupRuns.erase(groupRunsKey(groupType, groupName));
     }
-    std::vector<int> groupMembership;
 
-    if (faceIds.length() > 0)
+    sentGroupNames = groupNames;
+}
+
+std::string
+InputMesh::groupRunsKey(HAPI_GroupType groupType, const MString &groupName)
+{
+    return (groupType == HAPI_GROUPTYPE_POINT ? "point:" : "prim:") +
+           std::string(groupName.asChar());
+}
+
+void
+InputMesh::setGroupMembership(HAPI_GroupType groupType,
+                              const MString &groupName,
+                              const std::vector<int> &runs,
+                              int elementCount)
+{
+    const std::string key = groupRunsKey(groupType, groupName);
+
+    // The runs that were sent to the group are unknown, so the whole
+    // membership has to be sent.
+    const bool isUnknown = myGroupRunsUnknown && !myGroupRuns.count(key);
+
+    std::vector<int> &sentRuns = myGroupRuns[key];
+    if (!isUnknown && sentRuns == runs)
     {
-        int numFaces             = meshFn.numPolygons();
-        HAPI_GroupType groupType = HAPI_GROUPTYPE_PRIM;
+        return;
+    }
 
-        groupMembership.resize(numFaces);
-        std::fill(groupMembership.begin(), groupMembership.end(), 0);
+    CHECK_HAPI(HoudiniApi::AddGroup(Util::theHAPISession.get(),
+                                    geometryNodeId(), 0, groupType,
+                                    groupName.asChar()));
 
-        for (i = 0; i < faceIds.length(); i++)
+    // Selections are usually a few runs of elements on a large mesh, so only
+    // the runs are sent: zeros for the runs that were sent before, then ones
+    // for the new runs. With many runs, the whole membership is sent at once.
+    if (isUnknown || (sentRuns.size() + runs.size()) / 2 > theMaxGroupRuns)
+    {
+        myGroupBuffer.assign(elementCount, 0);
+        for (size_t i = 0; i < runs.size(); i += 2)
         {
-            groupMembership[faceIds[i]] = 1;
+            std::fill(myGroupBuffer.begin() + runs[i],
+                      myGroupBuffer.begin() + runs[i] + runs[i + 1], 1);
         }
-        MString primGroupName = primGroupPlug.asString();
-        if (primGroupName == "")
+
+        if (elementCount > 0)
         {
-            primGroupName = "inputPrimitiveComponent";
+            CHECK_HAPI(HoudiniApi::SetGroupMembership(
+                Util::theHAPISession.get(), geometryNodeId(), 0, groupType,
+                groupName.asChar(), &myGroupBuffer[0], 0, elementCount));
         }
 
-        CHECK_HAPI(HoudiniApi::AddGroup(Util::theHAPISession.get(), geometryNodeId(),
-                                 0, groupType, primGroupName.asChar()));
-
-        CHECK_HAPI(HoudiniApi::SetGroupMembership(
-            Util::theHAPISession.get(), geometryNodeId(), 0, groupType,
-            primGroupName.asChar(), &groupMembership[0], 0,
-            groupMembership.size()));
+        sentRuns = runs;
+        return;
     }
-    if (vertIds.length() > 0)
+
+    for (int membership = 0; membership < 2; membership++)
     {
-        int numVerts             = meshFn.numVertices();
-        HAPI_GroupType groupType = HAPI_GROUPTYPE_POINT;
+        const std::vector<int> &membershipRuns = membership ? runs : sentRuns;
+        for (size_t i = 0; i < membershipRuns.size(); i += 2)
+        {
+            // the element count may have changed since the runs were sent
+            const int start  = membershipRuns[i];
+            const int length = (std::min)(membershipRuns[i + 1],
+                                          elementCount - start);
+            if (length <= 0)
+            {
+                continue;
+            }
 
-        groupMembership.resize(numVerts);
-        std::fill(groupMembership.begin(), groupMembership.end(), 0);
+            myGroupBuffer.assign(length, membership);
+            CHECK_HAPI(HoudiniApi::SetGroupMembership(
+                Util::theHAPISession.get(), geometryNodeId(), 0, groupType,
+                groupName.asChar(), &myGroupBuffer[0], start, length));
+        }
+    }
+
+    sentRuns = runs;
+}
 
-        for (i = 0; i < vertIds.length(); i++)
+void
+InputMesh::eraseChannels(const char *prefix)
+{
+    const size_t length = strlen(prefix);
+    for (std::unordered_map<std::string, unsigned long long>::iterator iter =
+             myChannelHashes.begin();
+         iter != myChannelHashes.end();)
+    {
+        if (iter->first.compare(0, length, prefix) == 0)
         {
-            groupMembership[vertIds[i]] = 1;
+            iter = myChannelHashes.erase(iter);
         }
-
-        MString pointGroupName = pointGroupPlug.asString();
-        if (pointGroupName == "")
+        else
         {
-            pointGroupName = "inputPointComponent";
+            iter++;
         }
-        CHECK_HAPI(HoudiniApi::AddGroup(Util::theHAPISession.get(), geometryNodeId(),
-                                 0, groupType, pointGroupName.asChar()));
-
-        CHECK_HAPI(HoudiniApi::SetGroupMembership(
-            Util::theHAPISession.get(), geometryNodeId(), 0, groupType,
-            pointGroupName.asChar(), &groupMembership[0], 0,
-            groupMembership.size()));
     }
-    HoudiniApi::CommitGeo(Util::theHAPISession.get(), geometryNodeId());
 }
 
-void
-InputMesh::setInputGeo(MDataBlock &dataBlock, const MPlug &plug)
+bool
+InputMesh::processPoints(const MFnMesh &meshFn)
 {
-    MDataHandle dataHandle = dataBlock.inputValue(plug);
-
-    // extract mesh data from Maya
-    MObject meshObj = dataHandle.asMesh();
+    const float *rawPoints  = meshFn.getRawPoints(NULL);
+    const size_t floatCount = meshFn.numVertices() * 3;
+
+    unsigned long long pointsHash = Util::hashSeed;
+    pointsHash = hashValue(pointsHash, myPreserveScale);
+    pointsHash = hashValue(pointsHash, myQuantizeDeltas);
+    pointsHash = Util::hashBytes(
+        pointsHash, rawPoints, floatCount * sizeof(float));
+    if (!isChannelChanged("P", pointsHash))
+    {
+        return true;
+    }
 
-    MFnMesh meshFn(meshObj);
+    if (myPreserveScale)
+    {
+        // a flat loop over the components, which the compiler vectorizes
+        myPointBuffer.resize(floatCount);
+        float *scaledPoints = myPointBuffer.data();
+        for (size_t i = 0; i < floatCount; i++)
+        {
+            scaledPoints[i] = rawPoints[i] * 0.01f;
+        }
 
-    // get face data
-    std::vector<int> vertexCount;
-    std::vector<int> vertexList;
+        // send scaled points to houdini
+        CHECK_HAPI(hapiSetPointAttribute(
+            geometryNodeId(), 0, 3, "P", myPointBuffer));
+    }
+    else
     {
-        MIntArray mayaVertexCount;
-        MIntArray mayaVertexList;
-        meshFn.getVertices(mayaVertexCount, mayaVertexList);
+        CHECK_HAPI(hapiSetPointAttribute(
+            geometryNodeId(), 0, 3, "P", rawArray(rawPoints, floatCount)));
+    }
 
-        vertexCount.resize(mayaVertexCount.length());
-        mayaVertexCount.get(&vertexCount[0]);
+    return true;
+}
 
-        vertexList.resize(mayaVertexList.length());
-        mayaVertexList.get(&vertexList[0]);
+bool
+InputMesh::processPointDeltas(const MFnMesh &meshFn)
+{
+    const float *rawPoints  = meshFn.getRawPoints(NULL);
+    const int pointCount    = meshFn.numVertices();
+    const size_t floatCount = pointCount * 3;
+
+    unsigned long long pointsHash = Util::hashSeed;
+    pointsHash = hashValue(pointsHash, myPreserveScale);
+    pointsHash = hashValue(pointsHash, myQuantizeDeltas);
+    pointsHash = Util::hashBytes(
+        pointsHash, rawPoints, floatCount * sizeof(float));
+    if (!isChannelChanged("P", pointsHash))
+    {
+        return true;
     }
-    Util::reverseWindingOrder(vertexList, vertexCount);
 
-    // set up part info
-    HAPI_PartInfo partInfo;
-    HoudiniApi::PartInfo_Init(&partInfo);
-    partInfo.id          = 0;
-    partInfo.faceCount   = vertexCount.size();
-    partInfo.vertexCount = vertexList.size();
-    partInfo.pointCount  = meshFn.numVertices();
+    if (myDeltaNodeId < 0)
+    {
+        CHECK_HAPI_AND_RETURN(
+            HoudiniApi::CreateNode(Util::theHAPISession.get(),
+                                   myNode->parentId, "attribwrangle",
+                                   "maya_point_deltas", false,
+                                   &myDeltaNodeId),
+            false);
+        CHECK_HAPI(HoudiniApi::ConnectNodeInput(Util::theHAPISession.get(),
+                                                myDeltaNodeId, 0,
+                                                myNode->nodeId, 0));
+
+        HAPI_ParmId snippetParmId = -1;
+        CHECK_HAPI(HoudiniApi::GetParmIdFromName(Util::theHAPISession.get(),
+                                                 myDeltaNodeId, "snippet",
+                                                 &snippetParmId));
+        CHECK_HAPI(HoudiniApi::SetParmStringValue(Util::theHAPISession.get(),
+                                                  myDeltaNodeId,
+                                                  theDeltaSnippet,
+                                                  snippetParmId, 0));
+    }
 
-    // Set the data
-    HoudiniApi::SetPartInfo(
-        Util::theHAPISession.get(), geometryNodeId(), 0, &partInfo);
-    HoudiniApi::SetFaceCounts(Util::theHAPISession.get(), geometryNodeId(), 0,
-                       &vertexCount[0], 0, partInfo.faceCount);
-    HoudiniApi::SetVertexList(Util::theHAPISession.get(), geometryNodeId(), 0,
-                       &vertexList[0], 0, partInfo.vertexCount);
+    const float scale = myPreserveScale ? 0.01f : 1.0f;
+    myPointBuffer.resize(floatCount);
+    float *points = myPointBuffer.data();
+    for (size_t i = 0; i < floatCount; i++)
+    {
+        points[i] = rawPoints[i] * scale;
+    }
 
-    // Set position attributes.
-    processPoints(meshFn);
+    // the largest delta determines the step of the quantized deltas
+    const bool hasRestPoints = myRestPointBuffer.size() == floatCount;
+    float maxDelta           = 0.0f;
+    if (hasRestPoints)
+    {
+        const float *restPoints = myRestPointBuffer.data();
+        for (size_t i = 0; i < floatCount; i++)
+        {
+            maxDelta = (std::max)(maxDelta,
+                                  std::fabs(points[i] - restPoints[i]));
+        }
+    }
+    float deltaStep = maxDelta / theMaxQuantizedDelta;
 
-    // HACK: For some reason if processSets is called after processUVs, the part
-    //       size and the membership in Maya can get out of sync when custom
-    //       sets are utilized, which results in a crash.
-    processSets(plug, meshFn);
+    if (!hasRestPoints || deltaStep > theMaxDeltaStep)
+    {
+        // The points become the new rest points. The deltas that were sent
+        // before are cancelled by their scale.
+        myRestPointBuffer.swap(myPointBuffer);
+        CHECK_HAPI(hapiSetPointAttribute(
+            geometryNodeId(), 0, 3, "P", myRestPointBuffer));
 
-    // normals
-    processNormals(meshObj, meshFn, vertexCount);
+        deltaStep = 0.0f;
+        CHECK_HAPI(hapiSetDetailAttribute(
+            geometryNodeId(), 0, "maya_delta_scale", deltaStep));
+        myHasDeltaAttributes = true;
 
-    // UVs
-    processUVs(meshFn, vertexCount, vertexList);
+        return true;
+    }
 
-    // Colors and Alphas
-    processColorSets(meshFn, vertexCount, vertexList);
+    // The components are stored one after the other, so that each of them is
+    // sent as one attribute.
+    myDeltaBuffer.resize(floatCount);
+    const float *restPoints = myRestPointBuffer.data();
+    const float deltaScale  = deltaStep > 0.0f ? 1.0f / deltaStep : 0.0f;
+    for (int i = 0; i < pointCount; i++)
+    {
+        for (int j = 0; j < 3; j++)
+        {
+            const float delta = (points[i * 3 + j] - restPoints[i * 3 + j]) *
+                                deltaScale;
+            myDeltaBuffer[j * pointCount + i] = static_cast<HAPI_Int16>(
+                std::floor(delta + 0.5f));
+        }
+    }
+
+    HAPI_AttributeInfo attrInfo = HoudiniApi::AttributeInfo_Create();
+    attrInfo.exists             = true;
+    attrInfo.owner              = HAPI_ATTROWNER_POINT;
+    attrInfo.storage            = HAPI_STORAGETYPE_INT16;
+    attrInfo.count              = pointCount;
+    attrInfo.tupleSize          = 1;
+    for (int j = 0; j < 3 && pointCount > 0; j++)
+    {
+        CHECK_HAPI(HoudiniApi::AddAttribute(Util::theHAPISession.get(),
+                                            geometryNodeId(), 0,
+                                            theDeltaAttributeNames[j],
+                                            &attrInfo));
+        CHECK_HAPI(HoudiniApi::SetAttributeInt16Data(
+            Util::theHAPISession.get(), geometryNodeId(), 0,
+            theDeltaAttributeNames[j], &attrInfo,
+            &myDeltaBuffer[j * pointCount], 0, pointCount));
+    }
 
-    setInputName(HAPI_ATTROWNER_PRIM, partInfo.faceCount, plug);
+    CHECK_HAPI(hapiSetDetailAttribute(
+        geometryNodeId(), 0, "maya_delta_scale", deltaStep));
+    myHasDeltaAttributes = true;
 
-    // Commit it
-    HoudiniApi::CommitGeo(Util::theHAPISession.get(), geometryNodeId());
+    return true;
 }
 
-bool
-InputMesh::processPoints(const MFnMesh &meshFn)
+void
+InputMesh::removePointDeltas()
 {
-    const float *rawPoints = meshFn.getRawPoints(NULL);
+    myRestPointBuffer.clear();
 
-    if (myPreserveScale)
+    // the assets are connected to the input node again through
+    // outputNodeId()
+    if (myDeltaNodeId >= 0)
     {
-        float *scaledPoints = new float[meshFn.numVertices() * 3];
-
-        for (int i = 0; i < meshFn.numVertices(); i++)
-        {
-            //     float *scaledPoint = scaledPoints[i + 3];
-
-            scaledPoints[(i * 3) + 0] = rawPoints[(i * 3) + 0] * 0.01f;
-            scaledPoints[(i * 3) + 1] = rawPoints[(i * 3) + 1] * 0.01f;
-            scaledPoints[(i * 3) + 2] = rawPoints[(i * 3) + 2] * 0.01f;
-        }
-
-        // send scaled points to houdini
-        CHECK_HAPI(hapiSetPointAttribute(
-            geometryNodeId(), 0, 3, "P",
-            rawArray(scaledPoints, meshFn.numVertices() * 3)));
+        CHECK_HAPI(HoudiniApi::DeleteNode(
+            Util::theHAPISession.get(), myDeltaNodeId));
+        myDeltaNodeId = -1;
+    }
 
-        delete[] scaledPoints;
+    if (!myHasDeltaAttributes)
+    {
+        return;
     }
-    else
+
+    HAPI_AttributeInfo attributeInfo;
+    attributeInfo.exists    = true;
+    attributeInfo.owner     = HAPI_ATTROWNER_POINT;
+    attributeInfo.storage   = HAPI_STORAGETYPE_INT16;
+    attributeInfo.count     = 1;
+    attributeInfo.tupleSize = 1;
+    for (int j = 0; j < 3; j++)
     {
-        CHECK_HAPI(hapiSetPointAttribute(
-            geometryNodeId(), 0, 3, "P",
-            rawArray(meshFn.getRawPoints(NULL), meshFn.numVertices() * 3)));
+        HoudiniApi::DeleteAttribute(Util::theHAPISession.get(),
+                                    geometryNodeId(), 0,
+                                    theDeltaAttributeNames[j], &attributeInfo);
     }
 
-    return true;
+    attributeInfo.owner   = HAPI_ATTROWNER_DETAIL;
+    attributeInfo.storage = HAPI_STORAGETYPE_FLOAT;
+    HoudiniApi::DeleteAttribute(Util::theHAPISession.get(), geometryNodeId(),
+                                0, "maya_delta_scale", &attributeInfo);
+
+    myHasDeltaAttributes = false;
 }
 
 bool
-InputMesh::processNormals(const MObject &meshObj,
-                          const MFnMesh &meshFn,
-                          std::vector<int> vertexCount)
+InputMesh::processNormals(const MFnMesh &meshFn,
+                          const std::vector<int> &vertexCount,
+                          const std::vector<int> &vertexList)
 {
     // get normal IDs
     MIntArray normalCounts;
-    MIntArray normalIds;
-    meshFn.getNormalIds(normalCounts, normalIds);
+    MIntArray mayaNormalIds;
+    meshFn.getNormalIds(normalCounts, mayaNormalIds);
 
-    if (myUnlockNormals || !normalIds.length())
+    if (myUnlockNormals || !mayaNormalIds.length())
     {
         // if there are no normals being set on the input
         // delete any left over from the previous input
+        if (!isChannelChanged("N", 0))
+        {
+            return false;
+        }
+
         HAPI_AttributeInfo attributeInfo;
         attributeInfo.exists    = true;
         attributeInfo.owner     = HAPI_ATTROWNER_VERTEX;
@@ -292,65 +1234,102 @@ InputMesh::processNormals(const MObject &meshObj,
         return false;
     }
 
+    std::vector<int> &normalIds = myNormalIdBuffer;
+    normalIds.resize(mayaNormalIds.length());
+    mayaNormalIds.get(&normalIds[0]);
+
     // reverse winding order
     Util::reverseWindingOrder(normalIds, vertexCount);
 
     // get normal values
     const float *rawNormals = meshFn.getRawNormals(NULL);
+    const int numNormals    = meshFn.numNormals();
 
-    // build the per-vertex normals
-    std::vector<int> lockedNormals(normalIds.length());
-    std::vector<float> vertexNormals(normalIds.length() * 3);
-    for (unsigned int i = 0; i < normalIds.length(); ++i)
+    // The locks are queried once per normal, rather than once per vertex.
+    std::vector<int> &normalLocks = myNormalLockBuffer;
+    normalLocks.resize(numNormals);
+    for (int i = 0; i < numNormals; i++)
     {
-        if (meshFn.isNormalLocked(normalIds[i]))
+        normalLocks[i] = meshFn.isNormalLocked(i);
+    }
+
+    unsigned long long normalsHash = Util::hashSeed;
+    normalsHash = hashVector(normalsHash, normalIds);
+    normalsHash = hashVector(normalsHash, normalLocks);
+    normalsHash = Util::hashBytes(
+        normalsHash, rawNormals, numNormals * 3 * sizeof(float));
+    if (isChannelChanged("N", normalsHash))
+    {
+        // build the per-vertex normals and locks
+        std::vector<float> &vertexNormals = myNormalBuffer;
+        std::vector<int> &lockedNormals   = myLockedNormalBuffer;
+        vertexNormals.resize(normalIds.size() * 3);
+        lockedNormals.resize(normalIds.size());
+        for (size_t i = 0; i < normalIds.size(); ++i)
         {
-            lockedNormals[i] = 1;
+            const float *normal = rawNormals + normalIds[i] * 3;
+
+            vertexNormals[i * 3 + 0] = normal[0];
+            vertexNormals[i * 3 + 1] = normal[1];
+            vertexNormals[i * 3 + 2] = normal[2];
+            lockedNormals[i]         = normalLocks[normalIds[i]];
         }
 
-        vertexNormals[i * 3 + 0] = (rawNormals[normalIds[i] * 3 + 0]);
-        vertexNormals[i * 3 + 1] = (rawNormals[normalIds[i] * 3 + 1]);
-        vertexNormals[i * 3 + 2] = (rawNormals[normalIds[i] * 3 + 2]);
+        // add and set it to HAPI
+        CHECK_HAPI(hapiSetVertexAttribute(
+            geometryNodeId(), 0, 1, "maya_locked_normal", lockedNormals));
+        CHECK_HAPI(hapiSetVertexAttribute(
+            geometryNodeId(), 0, 3, "N", vertexNormals));
     }
 
-    // add and set it to HAPI
-    CHECK_HAPI(hapiSetVertexAttribute(
-        geometryNodeId(), 0, 1, "maya_locked_normal", lockedNormals));
-    CHECK_HAPI(
-        hapiSetVertexAttribute(geometryNodeId(), 0, 3, "N", vertexNormals));
-
     // hard/soft edges
+    std::vector<char> smoothEdges(meshFn.numEdges());
+    for (int i = 0; i < meshFn.numEdges(); i++)
     {
-        std::vector<int> hardEdges(meshFn.numFaceVertices());
+        smoothEdges[i] = meshFn.isEdgeSmooth(i);
+    }
 
-        int polygonVertexOffset = 0;
-        for (MItMeshPolygon itMeshPolygon(meshObj); !itMeshPolygon.isDone();
-             itMeshPolygon.next())
+    if (isChannelChanged(
+            "maya_hard_edge", hashVector(Util::hashSeed, smoothEdges)))
+    {
+        // the points of the hard edges, lowest first
+        std::unordered_set<unsigned long long> hardEdgePoints;
+        for (int i = 0; i < meshFn.numEdges(); i++)
         {
-            MIntArray edges;
-            itMeshPolygon.getEdges(edges);
-            int numVertices = edges.length();
+            if (smoothEdges[i])
+            {
+                continue;
+            }
+
+            int2 points;
+            meshFn.getEdgeVertices(i, points);
+            hardEdgePoints.insert(edgeKey(points[0], points[1]));
+        }
 
-            for (int i = 0; i < numVertices; i++)
+        // In the Houdini winding order, the hard edge flag of a vertex is for
+        // the edge to the next vertex of the polygon.
+        std::vector<int> &hardEdges = myHardEdgeBuffer;
+        hardEdges.assign(vertexList.size(), 0);
+        if (!hardEdgePoints.empty())
+        {
+            size_t polygonVertexOffset = 0;
+            for (size_t i = 0; i < vertexCount.size(); i++)
             {
-                if (!meshFn.isEdgeSmooth(edges[i]))
+                const int *polygonVertices = &vertexList[polygonVertexOffset];
+                const int numVertices      = vertexCount[i];
+                for (int j = 0; j < numVertices; j++)
                 {
-                    // first vertex in the Houdini winding order
-                    int polygonVertexIndex = polygonVertexOffset +
-                                             (i + 1) % numVertices;
-                    hardEdges[polygonVertexIndex] = 1;
-                }
-                else
-                {
-                    // default is already 0
+                    const unsigned long long key = edgeKey(
+                        polygonVertices[j],
+                        polygonVertices[(j + 1) % numVertices]);
+                    if (hardEdgePoints.count(key))
+                    {
+                        hardEdges[polygonVertexOffset + j] = 1;
+                    }
                 }
+                polygonVertexOffset += numVertices;
             }
-            polygonVertexOffset += edges.length();
         }
-        assert(polygonVertexOffset == meshFn.numFaceVertices());
-
-        // reverse winding order
-        Util::reverseWindingOrder(hardEdges, vertexCount);
 
         CHECK_HAPI(hapiSetVertexAttribute(
             geometryNodeId(), 0, 1, "maya_hard_edge", hardEdges));
@@ -361,8 +1340,8 @@ InputMesh::processNormals(const MObject &meshObj,
 
 bool
 InputMesh::processUVs(const MFnMesh &meshFn,
-                      std::vector<int> vertexCount,
-                      std::vector<int> vertexList)
+                      const std::vector<int> &vertexCount,
+                      const std::vector<int> &vertexList)
 {
     MString currentUVSetName = meshFn.currentUVSetName();
 
@@ -372,6 +1351,16 @@ InputMesh::processUVs(const MFnMesh &meshFn,
     MStringArray mappedUVAttributeNames;
     mappedUVAttributeNames.setLength(uvSetNames.length());
 
+    // When the UV sets change, all of them are sent again.
+    unsigned long long uvSetsHash = Util::hashSeed;
+    uvSetsHash = hashString(uvSetsHash, currentUVSetName);
+    uvSetsHash = hashStrings(uvSetsHash, uvSetNames);
+    const bool uvSetsChanged = isChannelChanged("uvSets", uvSetsHash);
+    if (uvSetsChanged)
+    {
+        eraseChannels("uvSet:");
+    }
+
     for (unsigned int uvSetIndex = 0; uvSetIndex < uvSetNames.length();
          uvSetIndex++)
     {
@@ -389,14 +1378,24 @@ InputMesh::processUVs(const MFnMesh &meshFn,
         MIntArray uvIds;
         meshFn.getAssignedUVs(uvCounts, uvIds, &uvSetName);
 
-        // reverse winding order
-        Util::reverseWindingOrder(uvIds, uvCounts);
-
         // get UV values
         MFloatArray uArray;
         MFloatArray vArray;
         meshFn.getUVs(uArray, vArray, &uvSetName);
 
+        unsigned long long uvHash = Util::hashSeed;
+        uvHash = hashArray<int>(uvHash, uvCounts);
+        uvHash = hashArray<int>(uvHash, uvIds);
+        uvHash = hashArray<float>(uvHash, uArray);
+        uvHash = hashArray<float>(uvHash, vArray);
+        if (!isChannelChanged(("uvSet:" + uvAttributeName).asChar(), uvHash))
+        {
+            continue;
+        }
+
+        // reverse winding order
+        Util::reverseWindingOrder(uvIds, uvCounts);
+
         // build the per-vertex UVs
         std::vector<float> vertexUVs;
         std::vector<int> vertexUVNumbers;
@@ -437,65 +1436,23 @@ InputMesh::processUVs(const MFnMesh &meshFn,
                                           uvNumberAttributeName.asChar(),
                                           vertexUVNumbers));
     }
-#if MAYA_API_VERSION > 201600
-    // now remove any TEXTURE type parms that no longer correspond
-    // to uvsets on the input
-    // This seems more complicated but less of a performance hit  than deleting
-    // and recreating all the attributes every time we pull on the inputs.
-
-    HoudiniApi::CommitGeo(Util::theHAPISession.get(), geometryNodeId());
-    HAPI_CookOptions cook_options = HoudiniApi::CookOptions_Create();
-    // cook the input geo so that the group counts are updated on the geoInfo
-    HoudiniApi::CookNode(Util::theHAPISession.get(), geometryNodeId(), &cook_options);
+    if (!uvSetsChanged)
+    {
+        return true;
+    }
 
-    HAPI_PartInfo partInfo;
-    CHECK_HAPI(HoudiniApi::GetPartInfo(
-        Util::theHAPISession.get(), geometryNodeId(), 0, &partInfo));
-
-    // on the inputs, we know that UV parms are called uv[0-9]*
-    // and that uvNumbers have the corresponding names
-    // so we just check the names and don't bother checking the types
-
-    int attributeCount = partInfo.attributeCounts[HAPI_ATTROWNER_VERTEX];
-    if (attributeCount > 0)
-    {
-        std::vector<HAPI_StringHandle> attributeNames(attributeCount);
-        HoudiniApi::GetAttributeNames(Util::theHAPISession.get(), geometryNodeId(), 0,
-                               HAPI_ATTROWNER_VERTEX, &attributeNames[0],
-                               attributeCount);
-        for (int j = 0; j < attributeCount; j++)
-        {
-            MString attrMStrName      = Util::HAPIString(attributeNames[j]);
-            const char *attributeName = attrMStrName.asChar();
-            if (!strncmp(attributeName, "uv", 2) &&
-                strncmp(attributeName, "uvNumber", 8))
-            {
-                if (mappedUVAttributeNames.indexOf(attrMStrName) < 0)
-                {
-                    HAPI_AttributeInfo attributeInfo;
-                    attributeInfo.exists    = true;
-                    attributeInfo.owner     = HAPI_ATTROWNER_VERTEX;
-                    attributeInfo.storage   = HAPI_STORAGETYPE_FLOAT;
-                    attributeInfo.count     = 1;
-                    attributeInfo.tupleSize = 3;
-
-                    HoudiniApi::DeleteAttribute(Util::theHAPISession.get(),
-                                         geometryNodeId(), 0, attributeName,
-                                         &attributeInfo);
-                    char vertNumName[16] = "uvNumber";
-                    strcat(vertNumName, attributeName + 2);
-
-                    attributeInfo.storage   = HAPI_STORAGETYPE_INT;
-                    attributeInfo.count     = 1;
-                    attributeInfo.tupleSize = 1;
-                    HoudiniApi::DeleteAttribute(Util::theHAPISession.get(),
-                                         geometryNodeId(), 0, vertNumName,
-                                         &attributeInfo);
-                }
-            }
-        }
+    // now remove the UV sets that are no longer on the input
+    for (unsigned int uvSetIndex = uvSetNames.length();
+         uvSetIndex < myUVSetCount; uvSetIndex++)
+    {
+        deleteVertexAttribute(geometryNodeId(),
+                              Util::getAttrLayerName("uv", uvSetIndex),
+                              HAPI_STORAGETYPE_FLOAT, 3);
+        deleteVertexAttribute(geometryNodeId(),
+                              Util::getAttrLayerName("uvNumber", uvSetIndex),
+                              HAPI_STORAGETYPE_INT, 1);
     }
-#endif
+    myUVSetCount = uvSetNames.length();
 
     // update the attribute mappiing parms
 
@@ -513,8 +1470,8 @@ InputMesh::processUVs(const MFnMesh &meshFn,
 
 bool
 InputMesh::processColorSets(const MFnMesh &meshFn,
-                            std::vector<int> vertexCount,
-                            std::vector<int> vertexList)
+                            const std::vector<int> &vertexCount,
+                            const std::vector<int> &vertexList)
 {
     MStringArray currentColorSetName(1, meshFn.currentColorSetName());
 
@@ -528,6 +1485,22 @@ InputMesh::processColorSets(const MFnMesh &meshFn,
     mappedAlphaNames.setLength(colorSetNames.length());
     colorReps.setLength(colorSetNames.length());
 
+    // When the color sets change, all of them are sent again.
+    unsigned long long colorSetsHash = Util::hashSeed;
+    colorSetsHash = hashStrings(colorSetsHash, currentColorSetName);
+    colorSetsHash = hashStrings(colorSetsHash, colorSetNames);
+    for (unsigned int i = 0; i < colorSetNames.length(); i++)
+    {
+        colorSetsHash = hashValue(
+            colorSetsHash,
+            static_cast<int>(meshFn.getColorRepresentation(colorSetNames[i])));
+    }
+    const bool colorSetsChanged = isChannelChanged("colorSets", colorSetsHash);
+    if (colorSetsChanged)
+    {
+        eraseChannels("colorSet:");
+    }
+
     MColor defaultUnsetColor;
     MColorArray colors;
     std::vector<float> buffer;
@@ -561,14 +1534,32 @@ InputMesh::processColorSets(const MFnMesh &meshFn,
         CHECK_MSTATUS(const_cast<MFnMesh &>(meshFn).getFaceVertexColors(
             colors, &colorSetName, &defaultUnsetColor));
 
+        if (hasColor)
+        {
+            mappedCdNames[i] = Util::getAttrLayerName("Cd", i);
+        }
+        if (hasAlpha)
+        {
+            mappedAlphaNames[i] = Util::getAttrLayerName("Alpha", i);
+        }
+
+        buffer.resize(colors.length() * 4);
+        if (colors.length())
+        {
+            colors.get(reinterpret_cast<float(*)[4]>(&buffer[0]));
+        }
+        if (!isChannelChanged(("colorSet:" + colorSetName).asChar(),
+                              hashVector(Util::hashSeed, buffer)))
+        {
+            continue;
+        }
+
         // reverse winding order
         Util::reverseWindingOrder(colors, vertexCount);
 
         if (hasColor)
         {
-            const MString colorAttributeName = Util::getAttrLayerName("Cd", i);
-
-            mappedCdNames[i] = colorAttributeName;
+            const MString &colorAttributeName = mappedCdNames[i];
 
             buffer =
                 Util::reshapeArray<3, 0, 3, 0, 4, std::vector<float>>(colors);
@@ -580,10 +1571,7 @@ InputMesh::processColorSets(const MFnMesh &meshFn,
 
         if (hasAlpha)
         {
-            const MString alphaAttributeName = Util::getAttrLayerName(
-                "Alpha", i);
-
-            mappedAlphaNames[i] = alphaAttributeName;
+            const MString &alphaAttributeName = mappedAlphaNames[i];
 
             buffer =
                 Util::reshapeArray<1, 0, 1, 3, 4, std::vector<float>>(colors);
@@ -593,71 +1581,33 @@ InputMesh::processColorSets(const MFnMesh &meshFn,
                 geometryNodeId(), 0, 1, alphaAttributeName.asChar(), buffer));
         }
     }
-#if MAYA_API_VERSION > 201600
-    // now remove any color and type parms that are no longer mapped
-    // This seems more complicated but less of a performance hit  than deleting
-    // and recreating all the attributes every time we pull on the inputs. need
-    // to commit to update the parms and cook to update the parm counts
-
-    HoudiniApi::CommitGeo(Util::theHAPISession.get(), geometryNodeId());
-    HAPI_CookOptions cook_options = HoudiniApi::CookOptions_Create();
-    // cook the input geo so that the group counts are updated on the geoInfo
-    HoudiniApi::CookNode(Util::theHAPISession.get(), geometryNodeId(), &cook_options);
-
-    HAPI_PartInfo partInfo;
-    CHECK_HAPI(HoudiniApi::GetPartInfo(
-        Util::theHAPISession.get(), geometryNodeId(), 0, &partInfo));
 
-    // on the inputs, we know that color parms are called Cd[0-9]*
-    // and that mapped Alpha are called Alpha[0-9]
-    // so we just check the names and don't bother checking the types
+    if (!colorSetsChanged)
+    {
+        return true;
+    }
 
-    int attributeCount = partInfo.attributeCounts[HAPI_ATTROWNER_VERTEX];
-    if (attributeCount > 0)
+    // now remove the color sets that are no longer on the input
+    for (unsigned int i = 0; i < myCdAttributeNames.length(); i++)
     {
-        std::vector<HAPI_StringHandle> attributeNames(attributeCount);
-        HoudiniApi::GetAttributeNames(Util::theHAPISession.get(), geometryNodeId(), 0,
-                               HAPI_ATTROWNER_VERTEX, &attributeNames[0],
-                               attributeCount);
-        for (int j = 0; j < attributeCount; j++)
+        if (myCdAttributeNames[i].length() &&
+            mappedCdNames.indexOf(myCdAttributeNames[i]) < 0)
         {
-            MString attrMStrName      = Util::HAPIString(attributeNames[j]);
-            const char *attributeName = attrMStrName.asChar();
-            if (!strncmp(attributeName, "Cd", 2))
-            {
-                if (mappedCdNames.indexOf(attrMStrName) < 0)
-                {
-                    HAPI_AttributeInfo attributeInfo;
-                    attributeInfo.exists    = true;
-                    attributeInfo.owner     = HAPI_ATTROWNER_VERTEX;
-                    attributeInfo.storage   = HAPI_STORAGETYPE_FLOAT;
-                    attributeInfo.count     = 1;
-                    attributeInfo.tupleSize = 3;
-
-                    HoudiniApi::DeleteAttribute(Util::theHAPISession.get(),
-                                         geometryNodeId(), 0, attributeName,
-                                         &attributeInfo);
-                }
-            }
-            if (!strncmp(attributeName, "Alpha", 2))
-            {
-                if (mappedAlphaNames.indexOf(attrMStrName) < 0)
-                {
-                    HAPI_AttributeInfo attributeInfo;
-                    attributeInfo.exists    = true;
-                    attributeInfo.owner     = HAPI_ATTROWNER_VERTEX;
-                    attributeInfo.storage   = HAPI_STORAGETYPE_FLOAT;
-                    attributeInfo.count     = 1;
-                    attributeInfo.tupleSize = 1;
-
-                    HoudiniApi::DeleteAttribute(Util::theHAPISession.get(),
-                                         geometryNodeId(), 0, attributeName,
-                                         &attributeInfo);
-                }
-            }
+            deleteVertexAttribute(geometryNodeId(), myCdAttributeNames[i],
+                                  HAPI_STORAGETYPE_FLOAT, 3);
+        }
+    }
+    for (unsigned int i = 0; i < myAlphaAttributeNames.length(); i++)
+    {
+        if (myAlphaAttributeNames[i].length() &&
+            mappedAlphaNames.indexOf(myAlphaAttributeNames[i]) < 0)
+        {
+            deleteVertexAttribute(geometryNodeId(), myAlphaAttributeNames[i],
+                                  HAPI_STORAGETYPE_FLOAT, 1);
         }
     }
-#endif
+    myCdAttributeNames    = mappedCdNames;
+    myAlphaAttributeNames = mappedAlphaNames;
 
     CHECK_HAPI(hapiSetDetailAttribute(
         geometryNodeId(), 0, "maya_colorset_current", currentColorSetName));
@@ -700,14 +1650,22 @@ InputMesh::processSets(const MPlug &plug, const MFnMesh &meshFn)
 
     MObjectArray sets;
     MObjectArray comps;
-    std::vector<std::string> setNamesUsed;
     // XXX: instance number
     srcNodeFn.getConnectedSetsAndMembers(0, sets, comps, false);
 
     MStringArray sgNames;
     MObjectArray sgCompObjs;
 
-    std::vector<int> groupMembership;
+    // The groups are only sent when one of the sets changed
+    struct Group
+    {
+        MString name;
+        HAPI_GroupType type;
+        int elementCount;
+        std::vector<int> runs;
+    };
+    std::vector<Group> groups;
+
     for (int setIndex = 0; setIndex < (int)sets.length(); setIndex++)
     {
         const MObject &setObj  = sets[setIndex];
@@ -747,25 +1705,25 @@ InputMesh::processSets(const MPlug &plug, const MFnMesh &meshFn)
         // to allow them if required
         if (!myAllowFacetSet && setFn.findPlug("facetsOnlySet", true).asBool())
         {
-            // if facet sets are not allowed they might have been before
-            // delete the group for the facet set in case it exists already
-
-            MString setName = setFn.name();
-            setName         = Util::sanitizeStringForNodeName(setName);
-            CHECK_HAPI(HoudiniApi::DeleteGroup(Util::theHAPISession.get(),
-                                        geometryNodeId(), 0,
-                                        HAPI_GROUPTYPE_PRIM, setName.asChar()));
+            // if facet sets are not allowed they might have been before,
+            // in which case the group is deleted below
             continue;
         }
 
         HAPI_GroupType groupType;
+        int elementCount;
+        std::vector<int> runs;
 
         if (compObj.isNull())
         {
-            groupType = HAPI_GROUPTYPE_PRIM;
-            groupMembership.resize(meshFn.numPolygons());
+            groupType    = HAPI_GROUPTYPE_PRIM;
+            elementCount = meshFn.numPolygons();
 
-            std::fill(groupMembership.begin(), groupMembership.end(), 1);
+            if (elementCount > 0)
+            {
+                runs.push_back(0);
+                runs.push_back(elementCount);
+            }
         }
         else
         {
@@ -775,90 +1733,70 @@ InputMesh::processSets(const MPlug &plug, const MFnMesh &meshFn)
             switch (componentFn.componentType())
             {
             case MFn::kMeshPolygonComponent:
-                groupType = HAPI_GROUPTYPE_PRIM;
-                groupMembership.resize(meshFn.numPolygons());
+                groupType    = HAPI_GROUPTYPE_PRIM;
+                elementCount = meshFn.numPolygons();
                 break;
             case MFn::kMeshVertComponent:
-                groupType = HAPI_GROUPTYPE_POINT;
-                groupMembership.resize(meshFn.numVertices());
+                groupType    = HAPI_GROUPTYPE_POINT;
+                elementCount = meshFn.numVertices();
                 break;
             default:
                 continue;
                 break;
             }
 
-            std::fill(groupMembership.begin(), groupMembership.end(), 0);
-            for (int i = 0; i < componentFn.elementCount(); i++)
-            {
-                groupMembership[componentFn.element(i)] = 1;
-            }
+            std::vector<int> elements;
+            appendElements(compObj, elements);
+            encodeRuns(elements, elementCount, runs);
         }
 
         MString setName = setFn.name();
         // If the set is in a namespace, the name will contain a colon.
-        setName                = Util::sanitizeStringForNodeName(setName);
-        std::string setNameStr = setName.asChar();
-        Util::markItemNameUsed(setNameStr, setNamesUsed);
+        setName = Util::sanitizeStringForNodeName(setName);
 
-        CHECK_HAPI(HoudiniApi::AddGroup(Util::theHAPISession.get(), geometryNodeId(),
-                                 0, groupType, setName.asChar()));
+        groups.push_back(Group());
+        groups.back().name = setName;
+        groups.back().type = groupType;
+        groups.back().elementCount = elementCount;
+        groups.back().runs.swap(runs);
+    }
 
-        CHECK_HAPI(HoudiniApi::SetGroupMembership(
-            Util::theHAPISession.get(), geometryNodeId(), 0, groupType,
-            setName.asChar(), &groupMembership[0], 0, groupMembership.size()));
+    unsigned long long setsHash = Util::hashSeed;
+    setsHash = hashValue(setsHash, groups.size());
+    for (size_t i = 0; i < groups.size(); i++)
+    {
+        setsHash = hashString(setsHash, groups[i].name);
+        setsHash = hashValue(setsHash, groups[i].type);
+        setsHash = hashValue(setsHash, groups[i].elementCount);
+        setsHash = hashVector(setsHash, groups[i].runs);
+    }
+    if (!isChannelChanged("sets", setsHash))
+    {
+        processShadingGroups(meshFn, sgNames, sgCompObjs);
+        return true;
     }
-    // now remove any groups that no longer correspond to sets on the input
 
-    // Commit it (even though we only care about pre-existing groups to delete
-    // if we don't commit the geo the first time through, bad stuff happens
-    HoudiniApi::CommitGeo(Util::theHAPISession.get(), geometryNodeId());
+    for (size_t i = 0; i < groups.size(); i++)
+    {
+        const Group &group = groups[i];
 
-    HAPI_CookOptions cook_options = HoudiniApi::CookOptions_Create();
-    // cook the input geo so that the group counts are updated on the geoInfo
-    HoudiniApi::CookNode(Util::theHAPISession.get(), geometryNodeId(), &cook_options);
-    HAPI_PartInfo partInfo;
-    HAPI_GeoInfo geoInfo;
-    CHECK_HAPI(HoudiniApi::GetGeoInfo(
-        Util::theHAPISession.get(), geometryNodeId(), &geoInfo));
-    CHECK_HAPI(HoudiniApi::GetPartInfo(
-        Util::theHAPISession.get(), geometryNodeId(), 0, &partInfo));
-
-    if (geoInfo.pointGroupCount > 0)
-    {
-        std::vector<HAPI_StringHandle> groupNames(geoInfo.pointGroupCount);
-        HoudiniApi::GetGroupNames(Util::theHAPISession.get(), geometryNodeId(),
-                           HAPI_GROUPTYPE_POINT, &groupNames[0],
-                           geoInfo.pointGroupCount);
-        for (int j = 0; j < geoInfo.pointGroupCount; j++)
-        {
-            MString groupName        = Util::HAPIString(groupNames[j]);
-            std::string groupNameStr = groupName.asChar();
-            if (!Util::isItemNameUsed(groupNameStr, setNamesUsed))
-            {
-                CHECK_HAPI(HoudiniApi::DeleteGroup(
-                    Util::theHAPISession.get(), geometryNodeId(), 0,
-                    HAPI_GROUPTYPE_POINT, groupName.asChar()));
-            }
-        }
+        setGroupMembership(group.type, group.name, group.runs,
+                           group.elementCount);
     }
-    if (geoInfo.primitiveGroupCount > 0)
+
+    // now remove any groups that no longer correspond to sets on the input
+    MStringArray pointGroupNames;
+    MStringArray primGroupNames;
+    for (size_t i = 0; i < groups.size(); i++)
     {
-        std::vector<HAPI_StringHandle> groupNames(geoInfo.primitiveGroupCount);
-        HoudiniApi::GetGroupNames(Util::theHAPISession.get(), geometryNodeId(),
-                           HAPI_GROUPTYPE_PRIM, &groupNames[0],
-                           geoInfo.primitiveGroupCount);
-        for (int j = 0; j < geoInfo.primitiveGroupCount; j++)
-        {
-            MString groupName        = Util::HAPIString(groupNames[j]);
-            std::string groupNameStr = groupName.asChar();
-            if (!Util::isItemNameUsed(groupNameStr, setNamesUsed))
-            {
-                CHECK_HAPI(HoudiniApi::DeleteGroup(
-                    Util::theHAPISession.get(), geometryNodeId(), 0,
-                    HAPI_GROUPTYPE_PRIM, groupName.asChar()));
-            }
-        }
+        (groups[i].type == HAPI_GROUPTYPE_POINT ? pointGroupNames :
+                                                  primGroupNames)
+            .append(groups[i].name);
     }
+    deleteStaleGroups(HAPI_GROUPTYPE_POINT, myPointGroupNames,
+                      pointGroupNames, myPointComponentGroupNames);
+    deleteStaleGroups(HAPI_GROUPTYPE_PRIM, myPrimGroupNames, primGroupNames,
+                      myPrimComponentGroupNames);
 
     processShadingGroups(meshFn, sgNames, sgCompObjs);
 
@@ -878,6 +1816,27 @@ InputMesh::processShadingGroups(const MFnMesh &meshFn,
     // promote the shading group info to primitive attributes so that
     // it will survive the merge.
 
+    unsigned long long sgHash = Util::hashSeed;
+    sgHash = hashValue(sgHash, myMatPerFace);
+    sgHash = hashValue(sgHash, meshFn.numPolygons());
+    sgHash = hashStrings(sgHash, sgNames);
+    for (unsigned int i = 0; i < sgCompObjs.length(); i++)
+    {
+        if (sgCompObjs[i].isNull())
+        {
+            continue;
+        }
+
+        MIntArray elements;
+        MFnSingleIndexedComponent(sgCompObjs[i]).getElements(elements);
+        sgHash = hashValue(sgHash, i);
+        sgHash = hashArray<int>(sgHash, elements);
+    }
+    if (!isChannelChanged("maya_shading_group", sgHash))
+    {
+        return true;
+    }
+
     if (sgCompObjs.length() == 1 && sgCompObjs[0].isNull())
     {
         if (!myMatPerFace)
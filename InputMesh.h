@@ -6,6 +6,13 @@
 #include <HAPI/HAPI.h>
 
 #include <maya/MFnMesh.h>
+#include <maya/MStringArray.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct SharedInputNode;
 
 class InputMesh : public Input
 {
@@ -15,6 +22,11 @@ public:
 
     virtual AssetInputType assetInputType() const;
 
+    virtual HAPI_NodeId outputNodeId() const;
+
+    virtual void setInputTransform(MDataHandle &dataHandle);
+    virtual bool needsInputGeo();
+
     virtual void setInputGeo(MDataBlock &dataBlock, const MPlug &plug);
 
     virtual void setInputComponents(MDataBlock &dataBlock,
@@ -25,19 +37,125 @@ public:
 
 protected:
     bool processPoints(const MFnMesh &meshFn);
-    bool processNormals(const MObject &meshObj,
-                        const MFnMesh &meshFn,
-                        std::vector<int> vertexCount);
+    bool processPointDeltas(const MFnMesh &meshFn);
+    // Deletes the wrangle and the delta attributes once the deltas are no
+    // longer sent.
+    void removePointDeltas();
+    bool processNormals(const MFnMesh &meshFn,
+                        const std::vector<int> &vertexCount,
+                        const std::vector<int> &vertexList);
     bool processUVs(const MFnMesh &meshFn,
-                    std::vector<int> vertexCount,
-                    std::vector<int> vertexList);
+                    const std::vector<int> &vertexCount,
+                    const std::vector<int> &vertexList);
     bool processColorSets(const MFnMesh &meshFn,
-                          std::vector<int> vertexCount,
-                          std::vector<int> vertexList);
+                          const std::vector<int> &vertexCount,
+                          const std::vector<int> &vertexList);
     bool processSets(const MPlug &plug, const MFnMesh &meshFn);
+    void processComponents(const MFnMesh &meshFn);
     bool processShadingGroups(const MFnMesh &meshFn,
                               const MStringArray &sgNames,
                               const MObjectArray &sgCompObjs);
+
+    // Returns whether the hash of a channel changed since it was last sent,
+    // and records the new hash.
+    bool isChannelChanged(const char *channel, unsigned long long hash);
+    void eraseChannels(const char *prefix);
+
+    // Deletes the groups that were sent before but are no longer in
+    // groupNames, unless they are in otherGroupNames.
+    void deleteStaleGroups(HAPI_GroupType groupType,
+                           MStringArray &sentGroupNames,
+                           const MStringArray &groupNames,
+                           const MStringArray &otherGroupNames);
+
+    // Sets the membership of a group from runs of consecutive elements, i.e.
+    // pairs of start and length.
+    void setGroupMembership(HAPI_GroupType groupType,
+                            const MString &groupName,
+                            const std::vector<int> &runs,
+                            int elementCount);
+    static std::string groupRunsKey(HAPI_GroupType groupType,
+                                    const MString &groupName);
+
+    // Identifies the source of the mesh and the options it's sent with. Only
+    // the inputs with the same source key can share a node.
+    unsigned long long sourceKey(const MPlug &plug) const;
+
+    // Returns the hash of everything that is sent to the input node and its
+    // object, which identifies the inputs whose node can be shared.
+    unsigned long long hashContent(const MFnMesh &meshFn,
+                                   const std::vector<int> &vertexCount,
+                                   const std::vector<int> &vertexList) const;
+
+    // Identifies the transform of the input object.
+    unsigned long long transformKey() const;
+
+    // Uses the node of another input with the same content instead of this
+    // input's own node. Returns false if there is no such node.
+    bool attachSharedNode(unsigned long long contentHash);
+    void detachSharedNode();
+
+    // Replaces this input's own node with a new one if other inputs still use
+    // it, so that they keep its content. Returns whether it was replaced.
+    bool separateNode();
+
+private:
+    // This input's own input node, and the node of another input that is
+    // used instead while both have the same content.
+    SharedInputNode *myNode;
+    SharedInputNode *mySharedNode;
+    bool myHasComponents;
+
+    // The input components of the last setInputComponents(), as runs of
+    // elements, and the names of their groups.
+    std::vector<int> myFaceRuns;
+    std::vector<int> myVertRuns;
+    MString myPrimComponentGroup;
+    MString myPointComponentGroup;
+
+    // The transform that the node in use was shared for.
+    unsigned long long myContentTransformKey;
+
+    // The wrangle that adds the quantized deltas to the rest points, and the
+    // rest points that were sent to the input node.
+    HAPI_NodeId myDeltaNodeId;
+    std::vector<float> myRestPointBuffer;
+
+    // Hash of each channel, e.g. P or a UV set, that was last sent to the
+    // input node.
+    std::unordered_map<std::string, unsigned long long> myChannelHashes;
+
+    // The attributes and groups that were sent to the input node, so that
+    // the stale ones can be deleted without cooking the input node.
+    unsigned int myUVSetCount;
+    MStringArray myCdAttributeNames;
+    MStringArray myAlphaAttributeNames;
+    MStringArray myPointGroupNames;
+    MStringArray myPrimGroupNames;
+    MStringArray myPointComponentGroupNames;
+    MStringArray myPrimComponentGroupNames;
+    bool myHasDeltaAttributes;
+
+    // The runs of the members of each group that was sent, so that only the
+    // runs need to be cleared when the membership changes.
+    std::unordered_map<std::string, std::vector<int>> myGroupRuns;
+    // Whether the groups of the node may have members that are not in
+    // myGroupRuns, as after the topology was sent again.
+    bool myGroupRunsUnknown;
+
+    // The source that this input is registered for.
+    unsigned long long mySourceKey;
+    bool myHasSourceKey;
+
+    // Reused between the updates, so that they are not reallocated.
+    std::vector<float> myPointBuffer;
+    std::vector<HAPI_Int16> myDeltaBuffer;
+    std::vector<float> myNormalBuffer;
+    std::vector<int> myNormalIdBuffer;
+    std::vector<int> myNormalLockBuffer;
+    std::vector<int> myLockedNormalBuffer;
+    std::vector<int> myHardEdgeBuffer;
+    std::vector<int> myGroupBuffer;
 };
 
 #endif
@@ -3,7 +3,6 @@
 #include <maya/MDoubleArray.h>
 #include <maya/MFnAttribute.h>
 #include <maya/MFnParticleSystem.h>
-#include <maya/MGlobal.h>
 #include <maya/MMatrix.h>
 #include <maya/MPlug.h>
 #include <maya/MPlugArray.h>
@@ -13,7 +12,34 @@
 #include "hapiutil.h"
 #include "util.h"
 
-InputParticle::InputParticle() : Input()
+namespace
+{
+void
+getArray(const MVectorArray &vectorArray, float *values)
+{
+    vectorArray.get(reinterpret_cast<float(*)[3]>(values));
+}
+
+void
+getArray(const MVectorArray &vectorArray, double *values)
+{
+    vectorArray.get(reinterpret_cast<double(*)[3]>(values));
+}
+
+void
+getArray(const MDoubleArray &doubleArray, float *values)
+{
+    doubleArray.get(values);
+}
+
+void
+getArray(const MDoubleArray &doubleArray, double *values)
+{
+    doubleArray.get(values);
+}
+}
+
+InputParticle::InputParticle() : Input(), myAttributeNamesCount(0)
 {
     Util::PythonInterpreterLock pythonInterpreterLock;
 
@@ -78,6 +104,89 @@ InputParticle::setAttributePointData(const char *attributeName,
     }
 }
 
+template <typename T, typename U>
+void
+InputParticle::setPointAttribute(const char *attributeName,
+                                 int tupleSize,
+                                 const T &mayaArray,
+                                 U scale,
+                                 std::vector<U> &buffer)
+{
+    buffer.resize(mayaArray.length() * tupleSize);
+    if (!buffer.empty())
+    {
+        getArray(mayaArray, &buffer[0]);
+    }
+
+    if (scale != 1)
+    {
+        for (size_t i = 0; i < buffer.size(); i++)
+        {
+            buffer[i] *= scale;
+        }
+    }
+
+    CHECK_HAPI(hapiSetPointAttribute(
+        geometryNodeId(), 0, tupleSize, attributeName, buffer));
+}
+
+void
+InputParticle::updateAttributeNames(
+    const MFnParticleSystem &originalParticleFn)
+{
+    // The attributes are only discovered again when an attribute is added to
+    // or removed from the particle node.
+    MObject particleObj = originalParticleFn.object();
+    const unsigned int attributeCount = originalParticleFn.attributeCount();
+    if (myAttributeNamesNode == MObjectHandle(particleObj) &&
+        myAttributeNamesCount == attributeCount)
+    {
+        return;
+    }
+
+    myAttributeNamesNode  = MObjectHandle(particleObj);
+    myAttributeNamesCount = attributeCount;
+    myVectorAttributeNames.clear();
+    myDoubleAttributeNames.clear();
+
+    for (unsigned int i = 0; i < attributeCount; i++)
+    {
+        MFnAttribute attributeFn(originalParticleFn.attribute(i));
+        if (!attributeFn.parent().isNull())
+        {
+            continue;
+        }
+
+        const MString attributeName = attributeFn.name();
+
+        // mimics "listAttr -v -w" from AEokayAttr
+        // some special per-particle attributes are always included
+        if (!(!attributeFn.isHidden() && attributeFn.isWritable()) &&
+            (attributeName != "age" && attributeName != "finalLifespanPP"))
+        {
+            continue;
+        }
+
+        if (originalParticleFn.isPerParticleVectorAttribute(attributeName))
+        {
+            myVectorAttributeNames.append(attributeName);
+        }
+        else if (originalParticleFn.isPerParticleDoubleAttribute(
+                     attributeName))
+        {
+            myDoubleAttributeNames.append(attributeName);
+        }
+    }
+
+    // explicitly include some special per-particle attributes that aren't
+    // reported as per-particle attributes
+    if (myDoubleAttributeNames.indexOf("age") < 0 &&
+        !originalParticleFn.attribute("age").isNull())
+    {
+        myDoubleAttributeNames.append("age");
+    }
+}
+
 void
 InputParticle::setInputGeo(MDataBlock &dataBlock, const MPlug &plug)
 {
@@ -138,173 +247,120 @@ InputParticle::setInputGeo(MDataBlock &dataBlock, const MPlug &plug)
                 hapiSetPointAttribute(geometryNodeId(), 0, 1, "id", ids));
         }
 
+        updateAttributeNames(originalParticleFn);
+
         // vector attributes
+        MVectorArray vectorArray;
+        for (unsigned int ai = 0; ai < myVectorAttributeNames.length(); ai++)
         {
-            MVectorArray vectorArray;
+            const MString &attributeName = myVectorAttributeNames[ai];
 
-            bool doPreserveAttrScale = false;
+            // get the per-particle data
+            if (attributeName == "position")
+            {
+                // Need to use position() so that we get the right
+                // positions in the case of deformed particles.
+                particleFn.position(vectorArray);
+            }
+            else
+            {
+                // Maya will automatically use the original
+                // particle node in the case of deformed particles.
+                particleFn.getPerParticleAttribute(attributeName, vectorArray);
+            }
 
-            // query the original particle for names of the per-particle
-            // attributes
-            MString getAttributesCommand = "particle -q -perParticleVector ";
-            getAttributesCommand += originalParticleFn.fullPathName();
+            // When particle node is initially loaded from a scene file, if
+            // the attribute is driven by expressions, then
+            // MFnParticleSystem doesn't initially seem to have data.
+            if (partInfo.pointCount != (int)vectorArray.length())
+            {
+                vectorArray.setLength(partInfo.pointCount);
+            }
 
-            // get the per-particle attribute names
-            MStringArray attributeNames;
-            MGlobal::executeCommand(getAttributesCommand, attributeNames);
+            // map the attribute name
+            bool doPreserveAttrScale        = false;
+            const char *mappedAttributeName = attributeName.asChar();
+            if (strcmp(mappedAttributeName, "position") == 0)
+            {
+                mappedAttributeName = "P";
+                doPreserveAttrScale = true;
+            }
+            else if (strcmp(mappedAttributeName, "velocity") == 0)
+            {
+                mappedAttributeName = "v";
+                doPreserveAttrScale = true;
+            }
+            else if (strcmp(mappedAttributeName, "acceleration") == 0)
+            {
+                mappedAttributeName = "force";
+                doPreserveAttrScale = true;
+            }
+            else if (strcmp(mappedAttributeName, "rgbPP") == 0)
+            {
+                mappedAttributeName = "Cd";
+            }
 
-            for (unsigned int ai = 0; ai < attributeNames.length(); ai++)
+            const double scale = myPreserveScale && doPreserveAttrScale ? 0.01 :
+                                                                          1.0;
+            if (mySinglePrecision)
             {
-                const MString attributeName = attributeNames[ai];
-                MObject attributeObj =
-                    originalParticleFn.attribute(attributeName);
-                if (attributeObj.isNull())
-                {
-                    continue;
-                }
-
-                // mimics "listAttr -v -w" from AEokayAttr
-                MFnAttribute attributeFn(attributeObj);
-                if (!(!attributeFn.isHidden() && attributeFn.isWritable()) &&
-                    (attributeName != "age" &&
-                     attributeName != "finalLifespanPP"))
-                {
-                    continue;
-                }
-
-                // get the per-particle data
-                if (attributeName == "position")
-                {
-                    // Need to use position() so that we get the right
-                    // positions in the case of deformed particles.
-                    particleFn.position(vectorArray);
-                }
-                else
-                {
-                    // Maya will automatically use the original
-                    // particle node in the case of deformed particles.
-                    particleFn.getPerParticleAttribute(
-                        attributeName, vectorArray);
-                }
-
-                // When particle node is initially loaded from a scene file, if
-                // the attribute is driven by expressions, then
-                // MFnParticleSystem doesn't initially seem to have data.
-                if (partInfo.pointCount != (int)vectorArray.length())
-                {
-                    vectorArray.setLength(partInfo.pointCount);
-                }
-
-                // map the attribute name
-                const char *mappedAttributeName = attributeName.asChar();
-                if (strcmp(mappedAttributeName, "position") == 0)
-                {
-                    mappedAttributeName = "P";
-                    doPreserveAttrScale = true;
-                }
-                else if (strcmp(mappedAttributeName, "velocity") == 0)
-                {
-                    mappedAttributeName = "v";
-                    doPreserveAttrScale = true;
-                }
-                else if (strcmp(mappedAttributeName, "acceleration") == 0)
-                {
-                    mappedAttributeName = "force";
-                    doPreserveAttrScale = true;
-                }
-                else if (strcmp(mappedAttributeName, "rgbPP") == 0)
-                {
-                    mappedAttributeName = "Cd";
-                }
-
-                if (myPreserveScale && doPreserveAttrScale)
-                {
-                    for (unsigned int i = 0; i < vectorArray.length(); i++)
-                        vectorArray[i] *= 0.01;
-                }
-
-                CHECK_HAPI(hapiSetPointAttribute(
-                    geometryNodeId(), 0, 3, mappedAttributeName,
-                    Util::reshapeArray<3, std::vector<double>>(vectorArray)));
+                setPointAttribute(mappedAttributeName, 3, vectorArray,
+                                  static_cast<float>(scale), myFloatBuffer);
+            }
+            else
+            {
+                setPointAttribute(
+                    mappedAttributeName, 3, vectorArray, scale, myDoubleBuffer);
             }
         }
 
         // double attributes
+        MDoubleArray doubleArray;
+        for (unsigned int ai = 0; ai < myDoubleAttributeNames.length(); ai++)
         {
-            MDoubleArray doubleArray;
-
-            bool doPreserveAttrScale = false;
+            const MString &attributeName = myDoubleAttributeNames[ai];
 
-            // query the original particle for names of the per-particle
-            // attributes
-            MString getAttributesCommand = "particle -q -perParticleDouble ";
-            getAttributesCommand += originalParticleFn.fullPathName();
+            // get the per-particle data
+            // Maya will automatically use the original
+            // particle node in the case of deformed particles.
+            particleFn.getPerParticleAttribute(attributeName, doubleArray);
 
-            // get the per-particle attribute names
-            MStringArray attributeNames;
-            MGlobal::executeCommand(getAttributesCommand, attributeNames);
+            // When particle node is initially loaded from a scene file, if
+            // the attribute is driven by expressions, then
+            // MFnParticleSystem doesn't initially seem to have data.
+            if (partInfo.pointCount != (int)doubleArray.length())
+            {
+                doubleArray.setLength(partInfo.pointCount);
+            }
 
-            // explicitly include some special per-particle attributes that
-            // aren't returned by the MEL command
-            attributeNames.append("age");
+            // map the parameter name
+            bool doPreserveAttrScale        = false;
+            const char *mappedAttributeName = attributeName.asChar();
+            if (strcmp(mappedAttributeName, "opacityPP") == 0)
+            {
+                mappedAttributeName = "Alpha";
+            }
+            else if (strcmp(mappedAttributeName, "radiusPP") == 0)
+            {
+                mappedAttributeName = "pscale";
+                doPreserveAttrScale = true;
+            }
+            else if (strcmp(mappedAttributeName, "finalLifespanPP") == 0)
+            {
+                mappedAttributeName = "life";
+            }
 
-            for (unsigned int ai = 0; ai < attributeNames.length(); ai++)
+            const double scale = myPreserveScale && doPreserveAttrScale ? 0.01 :
+                                                                          1.0;
+            if (mySinglePrecision)
             {
-                const MString attributeName = attributeNames[ai];
-
-                MObject attributeObj =
-                    originalParticleFn.attribute(attributeName);
-                if (attributeObj.isNull())
-                {
-                    continue;
-                }
-
-                // mimics "listAttr -v -w" from AEokayAttr
-                MFnAttribute attributeFn(attributeObj);
-                if (!(!attributeFn.isHidden() && attributeFn.isWritable()) &&
-                    (attributeName != "age" &&
-                     attributeName != "finalLifespanPP"))
-                {
-                    continue;
-                }
-
-                // get the per-particle data
-                // Maya will automatically use the original
-                // particle node in the case of deformed particles.
-                particleFn.getPerParticleAttribute(attributeName, doubleArray);
-
-                // When particle node is initially loaded from a scene file, if
-                // the attribute is driven by expressions, then
-                // MFnParticleSystem doesn't initially seem to have data.
-                if (partInfo.pointCount != (int)doubleArray.length())
-                {
-                    doubleArray.setLength(partInfo.pointCount);
-                }
-
-                // map the parameter name
-                const char *mappedAttributeName = attributeName.asChar();
-                if (strcmp(mappedAttributeName, "opacityPP") == 0)
-                {
-                    mappedAttributeName = "Alpha";
-                }
-                else if (strcmp(mappedAttributeName, "radiusPP") == 0)
-                {
-                    mappedAttributeName = "pscale";
-                    doPreserveAttrScale = true;
-                }
-                else if (strcmp(mappedAttributeName, "finalLifespanPP") == 0)
-                {
-                    mappedAttributeName = "life";
-                }
-
-                if (myPreserveScale && doPreserveAttrScale)
-                {
-                    for (unsigned int i = 0; i < doubleArray.length(); i++)
-                        doubleArray[i] *= 0.01;
-                }
-
-                CHECK_HAPI(hapiSetPointAttribute(
-                    geometryNodeId(), 0, 1, mappedAttributeName, doubleArray));
+                setPointAttribute(mappedAttributeName, 1, doubleArray,
+                                  static_cast<float>(scale), myFloatBuffer);
+            }
+            else
+            {
+                setPointAttribute(
+                    mappedAttributeName, 1, doubleArray, scale, myDoubleBuffer);
             }
         }
     }
@@ -5,6 +5,13 @@
 
 #include <HAPI/HAPI.h>
 
+#include <maya/MObjectHandle.h>
+#include <maya/MStringArray.h>
+
+#include <vector>
+
+class MFnParticleSystem;
+
 class InputParticle : public Input
 {
 public:
@@ -21,6 +28,27 @@ protected:
                                int count,
                                int tupleSize,
                                void *data);
+
+    // Sends a per-particle attribute, converted to the type of the buffer.
+    template <typename T, typename U>
+    void setPointAttribute(const char *attributeName,
+                           int tupleSize,
+                           const T &mayaArray,
+                           U scale,
+                           std::vector<U> &buffer);
+
+    void updateAttributeNames(const MFnParticleSystem &originalParticleFn);
+
+private:
+    // The per-particle attributes of the particle node, which are kept until
+    // the attributes of the node change.
+    MObjectHandle myAttributeNamesNode;
+    unsigned int myAttributeNamesCount;
+    MStringArray myVectorAttributeNames;
+    MStringArray myDoubleAttributeNames;
+
+    std::vector<float> myFloatBuffer;
+    std::vector<double> myDoubleBuffer;
 };
 
 #endif
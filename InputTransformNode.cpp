@@ -5,6 +5,7 @@
 #include <maya/MQuaternion.h>
 #include <maya/MTransformationMatrix.h>
 
+#include "HoudiniApiTracer.h"
 #include "MayaTypeID.h"
 #include "hapiutil.h"
 #include "util.h"
@@ -84,6 +85,9 @@ InputTransformNode::~InputTransformNode()
 MStatus
 InputTransformNode::compute(const MPlug &plug, MDataBlock &dataBlock)
 {
+    HoudiniApiTracer::NodeScope traceScope(
+        thisMObject(), "InputTransformNode::compute");
+
     if (plug == InputTransformNode::outputNodeId)
     {
         MPlug inputMatrixArrayPlug(
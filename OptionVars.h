@@ -90,6 +90,7 @@ struct OptionVars
           hapilLocation("HapilLocation", ""),
           asyncMode("AsynchronousMode", 1),
           sessionType("SessionType", 2), // named pipe
+          sharedMemoryBufferSize("SharedMemoryBufferSize", 100), // MB
           thriftServer("ThriftServer", "localhost"),
           thriftPort("ThriftPort", 9090),
           sessionPipeCustom("SessionPipeCustom", 0),
@@ -98,7 +99,13 @@ struct OptionVars
           unsetPP("UnsetPP", 0),
           viewProduct("ViewProduct", "Houdini Core"),
           timeout("Timeout", 10 * 1000),
-          disableCooking("DisableCooking", 0)
+          disableCooking("DisableCooking", 0),
+          hapiTrace("HapiTrace", 0),
+          hapiRecordMode("HapiRecordMode", 0), // off
+          hapiRecordFile("HapiRecordFile", ""),
+          frameCache("FrameCache", 0),
+          frameCacheSize("FrameCacheSize", 1024), // MB
+          cookAheadFrames("CookAheadFrames", 2)
     {
     }
 
@@ -106,6 +113,7 @@ struct OptionVars
     StringOptionVar hapilLocation;
     IntOptionVar asyncMode;
     IntOptionVar sessionType;
+    IntOptionVar sharedMemoryBufferSize;
     StringOptionVar thriftServer;
     IntOptionVar thriftPort;
     IntOptionVar sessionPipeCustom;
@@ -115,6 +123,12 @@ struct OptionVars
     StringOptionVar viewProduct;
     IntOptionVar timeout;
     IntOptionVar disableCooking;
+    IntOptionVar hapiTrace;
+    IntOptionVar hapiRecordMode;
+    StringOptionVar hapiRecordFile;
+    IntOptionVar frameCache;
+    IntOptionVar frameCacheSize;
+    IntOptionVar cookAheadFrames;
 
 private:
     OptionVars &operator=(const OptionVars &);
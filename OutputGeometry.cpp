@@ -24,16 +24,16 @@ OutputGeometry::update()
 {
     HAPI_Result hapiResult;
 
-    hapiResult = HAPI_GetNodeInfo(
+    hapiResult = HoudiniApi::GetNodeInfo(
         Util::theHAPISession.get(), myNodeId, &myNodeInfo);
     CHECK_HAPI(hapiResult);
 
-    hapiResult = HAPI_GetGeoInfo(
+    hapiResult = HoudiniApi::GetGeoInfo(
         Util::theHAPISession.get(), myNodeId, &myGeoInfo);
     if (HAPI_FAIL(hapiResult))
     {
         // Make sre myGeoInfo is properly initialized.
-        HAPI_GeoInfo_Init(&myGeoInfo);
+        HoudiniApi::GeoInfo_Init(&myGeoInfo);
 
         // Even when HAPI_GetGeoInfo() failed, there's always at least one
         // part. So we want the below code to initialize myParts.
@@ -125,11 +125,45 @@ OutputGeometry::compute(const MTime &time,
             {
                 MPlug partPlug = partsPlug.elementByLogicalIndex(i);
 
+                // Keep the previous output of the parts whose geometry
+                // didn't change. The hash is always updated, so that it
+                // matches the output that was computed.
+                bool partChanged = true;
+                if (needToRecomputeOutputData)
+                {
+                    myParts[i]->invalidateContentHash();
+                }
+
+                if (options.skipUnchangedParts())
+                {
+                    partChanged = myParts[i]->hasContentChanged(time, options);
+                }
+                else
+                {
+                    myParts[i]->invalidateContentHash();
+                }
+
+                if (!partChanged && !partCountChanged && !forceCompute)
+                {
+                    MPlugArray childPlugs;
+                    Util::getChildPlugs(childPlugs, partPlug);
+                    for (unsigned int j = 0; j < childPlugs.length(); j++)
+                    {
+                        data.setClean(childPlugs[j]);
+                    }
+                    data.setClean(partPlug);
+                    continue;
+                }
+
                 CHECK_MSTATUS(partsArrayHandle.jumpToArrayElement(i));
                 MDataHandle partHandle = partsArrayHandle.outputValue();
 
                 stat = myParts[i]->compute(time, partPlug, data, partHandle,
                                            options, needToSyncOutputs);
+                if (MFAIL(stat))
+                {
+                    myParts[i]->invalidateContentHash();
+                }
                 CHECK_MSTATUS_AND_RETURN(stat, MS::kFailure);
             }
         }
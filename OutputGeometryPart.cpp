@@ -20,6 +20,9 @@
 #include <maya/MFnVectorArrayData.h>
 
 #include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
 #include <limits>
 #include <map>
 #include <string>
@@ -37,7 +40,12 @@ OutputGeometryPart::OutputGeometryPart(HAPI_NodeId nodeId, HAPI_PartId partId)
     : myNodeId(nodeId),
       myPartId(partId),
       myLastOutputGeometryGroups(true),
-      myLastOutputCustomAttributes(true)
+      myLastOutputCustomAttributes(true),
+      myContentHash(0),
+      myHasContentHash(false),
+      myMeshTopologyHash(0),
+      myHasMeshTopologyHash(false),
+      myIsUpdated(false)
 {
     update();
 }
@@ -141,6 +149,9 @@ OutputGeometryPart::update()
     CHECK_HAPI(HoudiniApi::GetPartInfo(
         Util::theHAPISession.get(), myNodeId, myPartId, &myPartInfo));
 
+    myFaceCounts.clear();
+    myVertexList.clear();
+
     if (myPartInfo.type == HAPI_PARTTYPE_VOLUME)
     {
         CHECK_HAPI(HoudiniApi::GetVolumeInfo(
@@ -152,14 +163,698 @@ OutputGeometryPart::update()
         CHECK_HAPI(HoudiniApi::GetCurveInfo(
             Util::theHAPISession.get(), myNodeId, myPartId, &myCurveInfo));
     }
-}
 
-bool
-OutputGeometryPart::needCompute(
-    AssetNodeOptions::AccessorDataBlock &options) const
-{
-    return myLastOutputGeometryGroups != options.outputGeometryGroups() ||
-           myLastOutputCustomAttributes != options.outputCustomAttributes();
+    updateAttributes();
+}
+
+void
+OutputGeometryPart::updateAttributes()
+{
+    for (int i = 0; i < HAPI_ATTROWNER_MAX; i++)
+    {
+        const HAPI_AttributeOwner owner = static_cast<HAPI_AttributeOwner>(i);
+        const int attributeCount        = myPartInfo.attributeCounts[owner];
+
+        myAttributes[owner].clear();
+        if (attributeCount <= 0)
+        {
+            continue;
+        }
+
+        std::vector<HAPI_StringHandle> attributeNameHandles(attributeCount);
+        CHECK_HAPI_AND(HoudiniApi::GetAttributeNames(
+                           Util::theHAPISession.get(), myNodeId, myPartId,
+                           owner, &attributeNameHandles[0], attributeCount),
+                       continue;);
+
+        int bufferSize = 0;
+        CHECK_HAPI_AND(HoudiniApi::GetStringBatchSize(
+                           Util::theHAPISession.get(), &attributeNameHandles[0],
+                           attributeCount, &bufferSize),
+                       continue;);
+        if (bufferSize <= 0)
+        {
+            continue;
+        }
+
+        std::vector<char> attributeNames(bufferSize);
+        CHECK_HAPI_AND(HoudiniApi::GetStringBatch(Util::theHAPISession.get(),
+                                                  &attributeNames[0],
+                                                  bufferSize),
+                       continue;);
+
+        myAttributes[owner].reserve(attributeCount);
+        for (size_t j = 0; j < attributeNames.size();
+             j += strlen(&attributeNames[j]) + 1)
+        {
+            Attribute attribute;
+            attribute.name     = &attributeNames[j];
+            attribute.isHashed = false;
+            attribute.hash     = 0;
+
+            // Keep the attributes that HAPI can't handle (e.g. tuple size
+            // is 0), so that they are still listed.
+            if (HAPI_FAIL(HoudiniApi::GetAttributeInfo(
+                    Util::theHAPISession.get(), myNodeId, myPartId,
+                    attribute.name.c_str(), owner, &attribute.info)))
+            {
+                HoudiniApi::AttributeInfo_Init(&attribute.info);
+                attribute.info.exists = false;
+            }
+
+            myAttributes[owner].push_back(attribute);
+        }
+    }
+}
+
+const HAPI_AttributeInfo *
+OutputGeometryPart::findAttribute(HAPI_AttributeOwner owner,
+                                  const char *name) const
+{
+    const std::vector<Attribute> &attributes = myAttributes[owner];
+    for (size_t i = 0; i < attributes.size(); i++)
+    {
+        if (attributes[i].info.exists && attributes[i].name == name)
+        {
+            return &attributes[i].info;
+        }
+    }
+
+    return NULL;
+}
+
+template <typename T>
+HAPI_Result
+OutputGeometryPart::getAttribute(HAPI_AttributeOwner owner,
+                                 const char *name,
+                                 HAPI_AttributeInfo &attrInfo,
+                                 T &data)
+{
+    const HAPI_AttributeInfo *info = findAttribute(owner, name);
+    if (!info)
+    {
+        return HAPI_RESULT_FAILURE;
+    }
+
+    attrInfo = *info;
+    return hapiFetchAttribute(myNodeId, myPartId, name, attrInfo, data);
+}
+
+HAPI_Result
+OutputGeometryPart::getAttribute(HAPI_AttributeOwner owner,
+                                 const char *name,
+                                 HAPI_AttributeInfo &attrInfo,
+                                 std::vector<float> &data)
+{
+    std::vector<Attribute> &attributes = myAttributes[owner];
+    for (size_t i = 0; i < attributes.size(); i++)
+    {
+        Attribute &attribute = attributes[i];
+        if (!attribute.info.exists || attribute.name != name)
+        {
+            continue;
+        }
+
+        attrInfo = attribute.info;
+        if (!attribute.floatData.empty())
+        {
+            data.swap(attribute.floatData);
+            attribute.floatData.clear();
+            return HAPI_RESULT_SUCCESS;
+        }
+
+        return hapiFetchAttribute(myNodeId, myPartId, name, attrInfo, data);
+    }
+
+    return HAPI_RESULT_FAILURE;
+}
+
+bool
+OutputGeometryPart::getFaceCounts(std::vector<int> &faceCounts)
+{
+    if (!myFaceCounts.empty())
+    {
+        faceCounts.swap(myFaceCounts);
+        myFaceCounts.clear();
+        return true;
+    }
+
+    faceCounts.resize(myPartInfo.faceCount);
+    if (faceCounts.empty())
+    {
+        return true;
+    }
+
+    CHECK_HAPI_AND_RETURN(
+        HoudiniApi::GetFaceCounts(Util::theHAPISession.get(), myNodeId,
+                                  myPartId, &faceCounts[0], 0,
+                                  myPartInfo.faceCount),
+        false);
+    return true;
+}
+
+bool
+OutputGeometryPart::getVertexList(std::vector<int> &vertexList)
+{
+    if (!myVertexList.empty())
+    {
+        vertexList.swap(myVertexList);
+        myVertexList.clear();
+        return true;
+    }
+
+    vertexList.resize(myPartInfo.vertexCount);
+    if (vertexList.empty())
+    {
+        return true;
+    }
+
+    CHECK_HAPI_AND_RETURN(
+        HoudiniApi::GetVertexList(Util::theHAPISession.get(), myNodeId,
+                                  myPartId, &vertexList[0], 0,
+                                  myPartInfo.vertexCount),
+        false);
+    return true;
+}
+
+void
+OutputGeometryPart::clearFetchedData()
+{
+    for (int i = 0; i < HAPI_ATTROWNER_MAX; i++)
+    {
+        for (size_t j = 0; j < myAttributes[i].size(); j++)
+        {
+            std::vector<float>().swap(myAttributes[i][j].floatData);
+        }
+    }
+
+    std::vector<int>().swap(myFaceCounts);
+    std::vector<int>().swap(myVertexList);
+}
+
+template <typename T>
+HAPI_Result
+OutputGeometryPart::getAnyAttribute(const char *name,
+                                    HAPI_AttributeInfo &attrInfo,
+                                    T &data)
+{
+    const HAPI_AttributeOwner owners[] = {
+        HAPI_ATTROWNER_VERTEX,
+        HAPI_ATTROWNER_POINT,
+        HAPI_ATTROWNER_PRIM,
+        HAPI_ATTROWNER_DETAIL,
+    };
+    for (HAPI_AttributeOwner owner : owners)
+    {
+        if (findAttribute(owner, name))
+        {
+            return getAttribute(owner, name, attrInfo, data);
+        }
+    }
+
+    return HAPI_RESULT_FAILURE;
+}
+
+bool
+OutputGeometryPart::needCompute(
+    AssetNodeOptions::AccessorDataBlock &options) const
+{
+    return myLastOutputGeometryGroups != options.outputGeometryGroups() ||
+           myLastOutputCustomAttributes != options.outputCustomAttributes();
+}
+
+namespace
+{
+template <typename T>
+void
+hashValue(unsigned long long &hash, const T &value)
+{
+    hash = Util::hashBytes(hash, &value, sizeof(T));
+}
+
+template <typename T>
+void
+hashArray(unsigned long long &hash, const std::vector<T> &array)
+{
+    hashValue(hash, array.size());
+    if (!array.empty())
+    {
+        hash = Util::hashBytes(hash, &array[0], array.size() * sizeof(T));
+    }
+}
+
+// Fetches the strings of the handles as one buffer of null terminated strings.
+bool
+getStringBatch(std::vector<char> &buffer,
+               const std::vector<HAPI_StringHandle> &handles)
+{
+    buffer.clear();
+    if (handles.empty())
+    {
+        return true;
+    }
+
+    int bufferSize = 0;
+    CHECK_HAPI_AND_RETURN(
+        HoudiniApi::GetStringBatchSize(Util::theHAPISession.get(), &handles[0],
+                                       handles.size(), &bufferSize),
+        false);
+    if (bufferSize <= 0)
+    {
+        return true;
+    }
+
+    buffer.resize(bufferSize);
+    CHECK_HAPI_AND_RETURN(
+        HoudiniApi::GetStringBatch(
+            Util::theHAPISession.get(), &buffer[0], bufferSize),
+        false);
+
+    return true;
+}
+
+// Attributes other than P that computeMesh() reads.
+bool
+isMeshAttribute(const char *name)
+{
+    return strcmp(name, "currentlayer") == 0 ||
+           strncmp(name, "maya_", 5) == 0 || strncmp(name, "uv", 2) == 0 ||
+           strncmp(name, "Cd", 2) == 0 || strncmp(name, "Alpha", 5) == 0;
+}
+
+bool
+isNormalAttribute(const char *name)
+{
+    return strcmp(name, "N") == 0;
+}
+
+// Attributes that compute() reads for meshes and curves, when the other
+// attributes are not output as custom attributes.
+bool
+isComputedAttribute(const char *name)
+{
+    return strcmp(name, "P") == 0 || strcmp(name, "Pw") == 0 ||
+           isNormalAttribute(name) || isMeshAttribute(name);
+}
+}
+
+bool
+OutputGeometryPart::hasContentChanged(
+    const MTime &time,
+    AssetNodeOptions::AccessorDataBlock &options)
+{
+    update();
+
+    unsigned long long hash = Util::hashSeed;
+    const bool hashed       = hashContent(hash, time, options);
+
+    const bool changed =
+        !hashed || !myHasContentHash || hash != myContentHash;
+
+    myContentHash    = hash;
+    myHasContentHash = hashed;
+
+    // the part is computed right after a change, with what was fetched
+    myIsUpdated = changed;
+    if (!changed)
+    {
+        clearFetchedData();
+    }
+
+    return changed;
+}
+
+void
+OutputGeometryPart::invalidateContentHash()
+{
+    myHasContentHash = false;
+}
+
+bool
+OutputGeometryPart::hashContent(unsigned long long &hash,
+                                const MTime &time,
+                                AssetNodeOptions::AccessorDataBlock &options)
+{
+    // The voxels and the instance transforms are not hashed, since fetching
+    // them costs about as much as computing the output.
+    if (myPartInfo.type != HAPI_PARTTYPE_MESH &&
+        myPartInfo.type != HAPI_PARTTYPE_CURVE)
+    {
+        return false;
+    }
+
+    HAPI_Result hstat;
+
+    hashValue(hash, options.preserveScale());
+    hashValue(hash, options.outputGeometryGroups());
+    hashValue(hash, options.outputCustomAttributes());
+    hashValue(hash, options.outputMeshPreserveHardEdges());
+    hashValue(hash, options.outputMeshPreserveLockedNormals());
+
+    hashValue(hash, myPartInfo.type);
+    hashValue(hash, myPartInfo.faceCount);
+    hashValue(hash, myPartInfo.vertexCount);
+    hashValue(hash, myPartInfo.pointCount);
+    hashValue(hash, myPartInfo.attributeCounts);
+    hashValue(hash, myPartInfo.isInstanced);
+    hashValue(hash, myPartInfo.instancedPartCount);
+    hashValue(hash, myPartInfo.instanceCount);
+
+    if (myPartInfo.nameSH != 0)
+    {
+        std::string partName = Util::HAPIString(myPartInfo.nameSH);
+        hash = Util::hashBytes(hash, partName.c_str(), partName.size() + 1);
+    }
+
+    // The particles are stamped with the current time.
+    const bool hasParticles = myPartInfo.pointCount != 0 &&
+                              myPartInfo.vertexCount == 0 &&
+                              myPartInfo.faceCount == 0;
+    if (hasParticles)
+    {
+        hashValue(hash, time.as(MTime::Unit::kSeconds));
+    }
+
+    if (myPartInfo.faceCount > 0)
+    {
+        myFaceCounts.resize(myPartInfo.faceCount);
+        hstat = HoudiniApi::GetFaceCounts(Util::theHAPISession.get(), myNodeId,
+                                          myPartId, &myFaceCounts[0], 0,
+                                          myPartInfo.faceCount);
+        CHECK_HAPI_AND(hstat, myFaceCounts.clear(); return false;);
+        hashArray(hash, myFaceCounts);
+
+        std::vector<HAPI_NodeId> materialIds(myPartInfo.faceCount);
+        HAPI_Bool areAllTheSame = false;
+        hstat = HoudiniApi::GetMaterialNodeIdsOnFaces(
+            Util::theHAPISession.get(), myNodeId, myPartId, &areAllTheSame,
+            &materialIds[0], 0, myPartInfo.faceCount);
+        CHECK_HAPI_AND_RETURN(hstat, false);
+        hashValue(hash, areAllTheSame);
+        hashArray(hash, materialIds);
+    }
+
+    if (myPartInfo.vertexCount > 0 && myPartInfo.type == HAPI_PARTTYPE_MESH)
+    {
+        myVertexList.resize(myPartInfo.vertexCount);
+        hstat = HoudiniApi::GetVertexList(Util::theHAPISession.get(), myNodeId,
+                                          myPartId, &myVertexList[0], 0,
+                                          myPartInfo.vertexCount);
+        CHECK_HAPI_AND(hstat, myVertexList.clear(); return false;);
+        hashArray(hash, myVertexList);
+    }
+
+    if (myPartInfo.type == HAPI_PARTTYPE_CURVE)
+    {
+        hashValue(hash, myCurveInfo.curveType);
+        hashValue(hash, myCurveInfo.curveCount);
+        hashValue(hash, myCurveInfo.vertexCount);
+        hashValue(hash, myCurveInfo.knotCount);
+        hashValue(hash, myCurveInfo.isPeriodic);
+        hashValue(hash, myCurveInfo.isRational);
+        hashValue(hash, myCurveInfo.order);
+        hashValue(hash, myCurveInfo.hasKnots);
+
+        if (myCurveInfo.curveCount > 0)
+        {
+            std::vector<int> counts(myCurveInfo.curveCount);
+            hstat = HoudiniApi::GetCurveCounts(Util::theHAPISession.get(),
+                                               myNodeId, myPartId, &counts[0],
+                                               0, myCurveInfo.curveCount);
+            CHECK_HAPI_AND_RETURN(hstat, false);
+            hashArray(hash, counts);
+
+            if (myCurveInfo.order == HAPI_CURVE_ORDER_VARYING ||
+                myCurveInfo.order == HAPI_CURVE_ORDER_INVALID)
+            {
+                std::vector<int> orders(myCurveInfo.curveCount);
+                hstat = HoudiniApi::GetCurveOrders(
+                    Util::theHAPISession.get(), myNodeId, myPartId, &orders[0],
+                    0, myCurveInfo.curveCount);
+                CHECK_HAPI_AND_RETURN(hstat, false);
+                hashArray(hash, orders);
+            }
+        }
+
+        if (myCurveInfo.hasKnots && myCurveInfo.knotCount > 0)
+        {
+            std::vector<float> knots(myCurveInfo.knotCount);
+            hstat = HoudiniApi::GetCurveKnots(Util::theHAPISession.get(),
+                                              myNodeId, myPartId, &knots[0], 0,
+                                              myCurveInfo.knotCount);
+            CHECK_HAPI_AND_RETURN(hstat, false);
+            hashArray(hash, knots);
+        }
+    }
+
+    if (options.outputGeometryGroups() && !hashGroups(hash))
+    {
+        return false;
+    }
+
+    // Without the custom attributes, only the attributes that compute()
+    // reads are hashed. The particles read all of their point attributes.
+    const bool hashAllAttributes = options.outputCustomAttributes() ||
+                                   hasParticles;
+    for (int i = 0; i < HAPI_ATTROWNER_MAX; i++)
+    {
+        if (!hashAttributes(hash, static_cast<HAPI_AttributeOwner>(i),
+                            hashAllAttributes ? NULL : isComputedAttribute))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool
+OutputGeometryPart::hashGroups(unsigned long long &hash)
+{
+    const HAPI_GroupType groupTypes[HAPI_GROUPTYPE_MAX] = {
+        HAPI_GROUPTYPE_POINT,
+        HAPI_GROUPTYPE_PRIM,
+    };
+    const int groupCounts[HAPI_GROUPTYPE_MAX] = {
+        myGeoInfo.pointGroupCount,
+        myGeoInfo.primitiveGroupCount,
+    };
+    const int memberCounts[HAPI_GROUPTYPE_MAX] = {
+        myPartInfo.pointCount,
+        myPartInfo.faceCount,
+    };
+
+    for (int i = 0; i < HAPI_GROUPTYPE_MAX; i++)
+    {
+        if (groupCounts[i] == 0 || memberCounts[i] == 0)
+        {
+            continue;
+        }
+
+        std::vector<HAPI_StringHandle> groupNameHandles(groupCounts[i]);
+        CHECK_HAPI_AND_RETURN(
+            HoudiniApi::GetGroupNames(Util::theHAPISession.get(), myNodeId,
+                                      groupTypes[i], &groupNameHandles[0],
+                                      groupCounts[i]),
+            false);
+
+        std::vector<char> groupNames;
+        if (!getStringBatch(groupNames, groupNameHandles))
+        {
+            return false;
+        }
+        hashArray(hash, groupNames);
+
+        std::vector<int> membership(memberCounts[i]);
+        for (size_t j = 0; j < groupNames.size();
+             j += strlen(&groupNames[j]) + 1)
+        {
+            if (strcmp(&groupNames[j], HAPI_UNGROUPED_GROUP_NAME) == 0)
+            {
+                continue;
+            }
+
+            CHECK_HAPI_AND_RETURN(
+                HoudiniApi::GetGroupMembership(
+                    Util::theHAPISession.get(), myNodeId, myPartId,
+                    groupTypes[i], &groupNames[j], NULL, &membership[0], 0,
+                    memberCounts[i]),
+                false);
+            hashArray(hash, membership);
+        }
+    }
+
+    return true;
+}
+
+bool
+OutputGeometryPart::hashAttributes(unsigned long long &hash,
+                                   HAPI_AttributeOwner owner,
+                                   bool (*filter)(const char *))
+{
+    for (size_t i = 0; i < myAttributes[owner].size(); i++)
+    {
+        Attribute &attribute      = myAttributes[owner][i];
+        const char *attributeName = attribute.name.c_str();
+        if (filter && !filter(attributeName))
+        {
+            continue;
+        }
+
+        hash = Util::hashBytes(hash, attributeName, strlen(attributeName) + 1);
+
+        const HAPI_AttributeInfo &attrInfo = attribute.info;
+
+        hashValue(hash, attrInfo.exists);
+        hashValue(hash, attrInfo.storage);
+        hashValue(hash, attrInfo.originalOwner);
+        hashValue(hash, attrInfo.count);
+        hashValue(hash, attrInfo.tupleSize);
+        hashValue(hash, attrInfo.totalArrayElements);
+        hashValue(hash, attrInfo.typeInfo);
+
+        if (!hashAttributeData(attribute))
+        {
+            return false;
+        }
+        hashValue(hash, attribute.hash);
+    }
+
+    return true;
+}
+
+bool
+OutputGeometryPart::hashAttributeData(Attribute &attribute)
+{
+    if (attribute.isHashed)
+    {
+        return true;
+    }
+
+    HAPI_AttributeInfo attrInfo = attribute.info;
+    const char *attributeName   = attribute.name.c_str();
+
+    unsigned long long hash = Util::hashSeed;
+    if (attrInfo.exists && attrInfo.count > 0 && attrInfo.tupleSize > 0)
+    {
+        std::vector<int> intData;
+        std::vector<HAPI_Int64> int64Data;
+        std::vector<double> float64Data;
+        std::vector<char> stringData;
+
+        // Only the storages that compute() can read are fetched. The float
+        // data is kept for compute().
+        const size_t size = static_cast<size_t>(attrInfo.count) *
+                            attrInfo.tupleSize;
+        switch (attrInfo.storage)
+        {
+        case HAPI_STORAGETYPE_INT:
+            intData.resize(size);
+            CHECK_HAPI_AND_RETURN(
+                HoudiniApi::GetAttributeIntData(
+                    Util::theHAPISession.get(), myNodeId, myPartId,
+                    attributeName, &attrInfo, -1, &intData[0], 0,
+                    attrInfo.count),
+                false);
+            hashArray(hash, intData);
+            break;
+        case HAPI_STORAGETYPE_INT64:
+            int64Data.resize(size);
+            CHECK_HAPI_AND_RETURN(
+                HoudiniApi::GetAttributeInt64Data(
+                    Util::theHAPISession.get(), myNodeId, myPartId,
+                    attributeName, &attrInfo, -1, &int64Data[0], 0,
+                    attrInfo.count),
+                false);
+            hashArray(hash, int64Data);
+            break;
+        case HAPI_STORAGETYPE_FLOAT:
+            attribute.floatData.resize(size);
+            CHECK_HAPI_AND(
+                HoudiniApi::GetAttributeFloatData(
+                    Util::theHAPISession.get(), myNodeId, myPartId,
+                    attributeName, &attrInfo, -1, &attribute.floatData[0], 0,
+                    attrInfo.count),
+                attribute.floatData.clear(); return false;);
+            hashArray(hash, attribute.floatData);
+            break;
+        case HAPI_STORAGETYPE_FLOAT64:
+            float64Data.resize(size);
+            CHECK_HAPI_AND_RETURN(
+                HoudiniApi::GetAttributeFloat64Data(
+                    Util::theHAPISession.get(), myNodeId, myPartId,
+                    attributeName, &attrInfo, -1, &float64Data[0], 0,
+                    attrInfo.count),
+                false);
+            hashArray(hash, float64Data);
+            break;
+        case HAPI_STORAGETYPE_STRING:
+            // The handles are not stable across cooks, so hash the strings.
+            intData.resize(size);
+            CHECK_HAPI_AND_RETURN(
+                HoudiniApi::GetAttributeStringData(
+                    Util::theHAPISession.get(), myNodeId, myPartId,
+                    attributeName, &attrInfo, &intData[0], 0, attrInfo.count),
+                false);
+            if (!getStringBatch(stringData, intData))
+            {
+                return false;
+            }
+            hashArray(hash, stringData);
+            break;
+        default:
+            break;
+        }
+    }
+
+    attribute.hash     = hash;
+    attribute.isHashed = true;
+
+    return true;
+}
+
+bool
+OutputGeometryPart::hashMeshAttributes(
+    unsigned long long &hash,
+    AssetNodeOptions::AccessorDataBlock &options)
+{
+    hashValue(hash, options.outputMeshPreserveHardEdges());
+    hashValue(hash, options.outputMeshPreserveLockedNormals());
+
+    for (int i = 0; i < HAPI_ATTROWNER_MAX; i++)
+    {
+        if (!hashAttributes(
+                hash, static_cast<HAPI_AttributeOwner>(i), isMeshAttribute))
+        {
+            return false;
+        }
+    }
+
+    // The normals are only output when some of them are locked.
+    if (options.outputMeshPreserveLockedNormals())
+    {
+        const HAPI_AttributeOwner owners[] = {HAPI_ATTROWNER_VERTEX,
+                                              HAPI_ATTROWNER_POINT};
+        for (HAPI_AttributeOwner owner : owners)
+        {
+            if (!findAttribute(owner, "maya_locked_normal"))
+            {
+                continue;
+            }
+
+            for (int i = 0; i < HAPI_ATTROWNER_MAX; i++)
+            {
+                if (!hashAttributes(hash, static_cast<HAPI_AttributeOwner>(i),
+                                    isNormalAttribute))
+                {
+                    return false;
+                }
+            }
+            break;
+        }
+    }
+
+    return true;
 }
 
 MStatus
@@ -172,7 +867,11 @@ OutputGeometryPart::compute(const MTime &time,
 {
     data.setClean(partPlug);
 
-    update();
+    if (!myIsUpdated)
+    {
+        update();
+    }
+    myIsUpdated = false;
 
     // compute geometry
     {
@@ -237,7 +936,8 @@ OutputGeometryPart::compute(const MTime &time,
         computeInstancer(
             time, partPlug.child(AssetNode::outputPartHasInstancer),
             partPlug.child(AssetNode::outputPartInstancer), data,
-            hasInstancerHandle, instanceHandle, options.preserveScale());
+            hasInstancerHandle, instanceHandle, options.preserveScale(),
+            options.useInstancerNode());
 
         // Groups
         MDataHandle groupsHandle =
@@ -259,6 +959,8 @@ OutputGeometryPart::compute(const MTime &time,
             extraAttributesHandle, options, needToSyncOutputs);
     }
 
+    clearFetchedData();
+
     return MS::kSuccess;
 }
 
@@ -287,14 +989,120 @@ OutputGeometryPart::computeCurves(const MTime &time,
         HAPI_AttributeInfo attrInfo;
 
         std::vector<float> pArray, pwArray;
-        hapiGetPointAttribute(myNodeId, myPartId, "P", attrInfo, pArray);
-        hapiGetPointAttribute(myNodeId, myPartId, "Pw", attrInfo, pwArray);
+        getAttribute(HAPI_ATTROWNER_POINT, "P", attrInfo, pArray);
+        getAttribute(HAPI_ATTROWNER_POINT, "Pw", attrInfo, pwArray);
         markAttributeUsed("P");
         markAttributeUsed("Pw");
 
-        int vertexOffset = 0;
-        int knotOffset   = 0;
-        for (int iCurve = 0; iCurve < myCurveInfo.curveCount; iCurve++)
+        // Fetch the counts, orders and knots of all the curves at once
+        std::vector<int> counts(curveCount);
+        HoudiniApi::GetCurveCounts(Util::theHAPISession.get(), myNodeId,
+                                   myPartId, &counts.front(), 0, curveCount);
+
+        std::vector<int> orders(curveCount, myCurveInfo.order);
+        if (myCurveInfo.order == HAPI_CURVE_ORDER_VARYING ||
+            myCurveInfo.order == HAPI_CURVE_ORDER_INVALID)
+        {
+            HoudiniApi::GetCurveOrders(Util::theHAPISession.get(), myNodeId,
+                                       myPartId, &orders.front(), 0,
+                                       curveCount);
+        }
+
+        // The curve at i will have numVertices vertices, and may have some
+        // knots. The knot count will be numVertices + order for nurbs curves
+        std::vector<int> vertexOffsets(curveCount + 1, 0);
+        std::vector<int> knotOffsets(curveCount + 1, 0);
+        int validCurveCount = curveCount;
+        for (int iCurve = 0; iCurve < curveCount; iCurve++)
+        {
+            const int nextVertexOffset = vertexOffsets[iCurve] + counts[iCurve];
+            if (nextVertexOffset * 3 > static_cast<int>(pArray.size()) ||
+                (!pwArray.empty() &&
+                 nextVertexOffset > static_cast<int>(pwArray.size())))
+            {
+                MGlobal::displayError("Not enough points to create a curve");
+                validCurveCount = iCurve;
+                break;
+            }
+
+            vertexOffsets[iCurve + 1] = nextVertexOffset;
+            knotOffsets[iCurve + 1] = knotOffsets[iCurve] + counts[iCurve] +
+                                      orders[iCurve];
+        }
+
+        std::vector<float> knots;
+        if (myCurveInfo.hasKnots && knotOffsets[validCurveCount] > 0)
+        {
+            knots.resize(knotOffsets[validCurveCount]);
+            HoudiniApi::GetCurveKnots(Util::theHAPISession.get(), myNodeId,
+                                      myPartId, &knots.front(), 0,
+                                      (int)knots.size());
+        }
+
+        // Build the control vertices and knots of the curves into plain
+        // buffers, so that large parts can be split across threads without
+        // touching the Maya API. The Maya knot vector of each curve has two
+        // fewer knots than the Houdini one.
+        const bool preserveScale = options.preserveScale();
+        std::vector<double> cvBuffer(vertexOffsets[validCurveCount] * 4);
+        std::vector<double> knotBuffer(
+            (std::max)(knotOffsets[validCurveCount] - 2 * validCurveCount, 0));
+        Util::parallelFor(
+            validCurveCount, 256, [&](size_t begin, size_t end) {
+                for (size_t iCurve = begin; iCurve < end; iCurve++)
+                {
+                    const int numVertices = counts[iCurve];
+                    const int order       = orders[iCurve];
+
+                    // If there's not enough vertices, then the curve isn't
+                    // created.
+                    if (numVertices < order)
+                        continue;
+
+                    const double scale = preserveScale ? 100.0 : 1.0;
+                    double *cvs = &cvBuffer[vertexOffsets[iCurve] * 4];
+                    for (int iDst = 0, iSrc = vertexOffsets[iCurve];
+                         iDst < numVertices; ++iDst, ++iSrc)
+                    {
+                        cvs[iDst * 4]     = pArray[iSrc * 3] * scale;
+                        cvs[iDst * 4 + 1] = pArray[iSrc * 3 + 1] * scale;
+                        cvs[iDst * 4 + 2] = pArray[iSrc * 3 + 2] * scale;
+                        cvs[iDst * 4 + 3] =
+                            (pwArray.empty() ? 1.0f : pwArray[iSrc]) * scale;
+                    }
+
+                    double *knotSequence =
+                        &knotBuffer[knotOffsets[iCurve] - 2 * iCurve];
+                    if (myCurveInfo.hasKnots)
+                    {
+                        // Maya doesn't need the first and last houdini knots
+                        const float *curveKnots = &knots[knotOffsets[iCurve]];
+                        for (int j = 0; j < numVertices + order - 2; j++)
+                            knotSequence[j] = curveKnots[j + 1];
+                    }
+                    else if (myCurveInfo.curveType == HAPI_CURVETYPE_BEZIER)
+                    {
+                        // Bezier knot vector needs to still be passed in
+                        for (int j = 0; j < numVertices + order - 2; j++)
+                            knotSequence[j] = j / (order - 1);
+                    }
+                    else
+                    {
+                        int j = 0;
+                        for (; j < order - 1; j++)
+                            knotSequence[j] = 0.0;
+
+                        for (int k = 1; j < numVertices - 1; k++, j++)
+                            knotSequence[j] = (double)k /
+                                              (numVertices - order + 1);
+
+                        for (; j < numVertices + order - 2; j++)
+                            knotSequence[j] = 1.0;
+                    }
+                }
+            });
+
+        for (int iCurve = 0; iCurve < validCurveCount; iCurve++)
         {
             CHECK_MSTATUS(curvesArrayHandle.jumpToArrayElement(iCurve));
             MDataHandle curve    = curvesArrayHandle.outputValue();
@@ -311,123 +1119,32 @@ OutputGeometryPart::computeCurves(const MTime &time,
                 curveDataFn.setObject(curveDataObj);
             }
 
-            // Number of CVs
-            int numVertices = 0;
-            HoudiniApi::GetCurveCounts(Util::theHAPISession.get(), myNodeId, myPartId,
-                                &numVertices, iCurve, 1);
-
-            const int nextVertexOffset = vertexOffset + numVertices;
-            if (nextVertexOffset > static_cast<int>(pArray.size()) * 3 ||
-                (!pwArray.empty() &&
-                 nextVertexOffset > static_cast<int>(pwArray.size())))
-            {
-                MGlobal::displayError("Not enough points to create a curve");
-                break;
-            }
-
-            // Order of this particular curve
-            int order;
-            if (myCurveInfo.order != HAPI_CURVE_ORDER_VARYING &&
-                myCurveInfo.order != HAPI_CURVE_ORDER_INVALID)
-            {
-                order = myCurveInfo.order;
-            }
-            else
-            {
-                HoudiniApi::GetCurveOrders(Util::theHAPISession.get(), myNodeId,
-                                    myPartId, &order, iCurve, 1);
-            }
-
-            // If there's not enough vertices, then don't try to create the
-            // curve.
-            if (numVertices < order)
+            if (counts[iCurve] < orders[iCurve])
             {
                 // Need to make sure we clear out the curve that was created
                 // previously.
                 curve.setMObject(curveDataFn.create());
-
-                // The curve at i will have numVertices vertices, and may have
-                // some knots. The knot count will be numVertices + order for
-                // nurbs curves
-                vertexOffset = nextVertexOffset;
-                knotOffset += numVertices + order;
-
                 continue;
             }
 
-            MPointArray controlVertices(numVertices);
-            for (int iDst = 0, iSrc = vertexOffset; iDst < numVertices;
-                 ++iDst, ++iSrc)
-            {
-                controlVertices[iDst] = MPoint(
-                    pArray[iSrc * 3], pArray[iSrc * 3 + 1],
-                    pArray[iSrc * 3 + 2],
-                    pwArray.empty() ? 1.0f : pwArray[iSrc]);
-            }
-
-            if (options.preserveScale())
-            {
-                for (unsigned int i = 0; i < controlVertices.length(); i++)
-                {
-                    controlVertices[i].x *= 100.0;
-                    controlVertices[i].y *= 100.0;
-                    controlVertices[i].z *= 100.0;
-                    controlVertices[i].w *= 100.0;
-                }
-            }
-
-            MDoubleArray knotSequences;
-            if (myCurveInfo.hasKnots)
-            {
-                std::vector<float> knots;
-                knots.resize(numVertices + order);
-                // The Maya knot vector has two fewer knots;
-                // the first and last houdini knot are excluded
-                knotSequences.setLength(numVertices + order - 2);
-                HoudiniApi::GetCurveKnots(Util::theHAPISession.get(), myNodeId,
-                                   myPartId, &knots.front(), knotOffset,
-                                   numVertices + order);
-                // Maya doesn't need the first and last knots
-                for (int j = 0; j < numVertices + order - 2; j++)
-                    knotSequences[j] = knots[j + 1];
-            }
-            else if (myCurveInfo.curveType == HAPI_CURVETYPE_BEZIER)
-            {
-                // Bezier knot vector needs to still be passed in
-                knotSequences.setLength(numVertices + order - 2);
-                for (int j = 0; j < numVertices + order - 2; j++)
-                    knotSequences[j] = j / (order - 1);
-            }
-            else
-            {
-                knotSequences.setLength(numVertices + order - 2);
-                int j = 0;
-                for (; j < order - 1; j++)
-                    knotSequences[j] = 0.0;
-
-                for (int k = 1; j < numVertices - 1; k++, j++)
-                    knotSequences[j] = (double)k / (numVertices - order + 1);
-
-                for (; j < numVertices + order - 2; j++)
-                    knotSequences[j] = 1.0;
-            }
-
             // NOTE: Periodicity is always constant, so periodic and
             //           non-periodic curve meshes will have different parts.
+            const MPointArray controlVertices(
+                reinterpret_cast<const double(*)[4]>(
+                    &cvBuffer[vertexOffsets[iCurve] * 4]),
+                counts[iCurve]);
+            const MDoubleArray knotSequence(
+                &knotBuffer[knotOffsets[iCurve] - 2 * iCurve],
+                counts[iCurve] + orders[iCurve] - 2);
+
             MFnNurbsCurve curveFn;
             MObject nurbsCurve = curveFn.create(
-                controlVertices, knotSequences, order - 1,
+                controlVertices, knotSequence, orders[iCurve] - 1,
                 myCurveInfo.isPeriodic ? MFnNurbsCurve::kPeriodic :
                                          MFnNurbsCurve::kOpen,
                 false /* 2d? */, myCurveInfo.isRational /* rational? */,
                 curveDataObj, &status);
             CHECK_MSTATUS(status);
-
-            // The curve at i will have numVertices vertices, and may have
-            // some knots. The knot count will be numVertices + order for
-            // nurbs curves
-            vertexOffset = nextVertexOffset;
-            knotOffset += numVertices + order;
         }
 
         curvesIsBezierHandle.setBool(myCurveInfo.curveType ==
@@ -437,21 +1154,80 @@ OutputGeometryPart::computeCurves(const MTime &time,
     curvesArrayHandle.setAllClean();
 }
 
+namespace
+{
+// Copies the components into a particle array in one call.
+void
+setParticleArray(MVectorArray particleArray, const std::vector<double> &data)
+{
+    if (data.empty())
+    {
+        particleArray.clear();
+        return;
+    }
+
+    particleArray = MVectorArray(
+        reinterpret_cast<const double(*)[3]>(&data.front()),
+        static_cast<unsigned int>(data.size() / 3));
+}
+
+void
+setParticleArray(MDoubleArray particleArray, const std::vector<double> &data)
+{
+    if (data.empty())
+    {
+        particleArray.clear();
+        return;
+    }
+
+    particleArray = MDoubleArray(
+        &data.front(), static_cast<unsigned int>(data.size()));
+}
+}
+
 template <typename T>
 bool
 OutputGeometryPart::convertParticleAttribute(T particleArray,
                                              const char *houdiniName,
                                              bool preserveScale)
+{
+    return convertParticleAttribute(
+        particleArray, houdiniName,
+        findAttribute(HAPI_ATTROWNER_POINT, houdiniName), preserveScale);
+}
+
+template <typename T>
+bool
+OutputGeometryPart::convertParticleAttribute(
+    T particleArray,
+    const char *houdiniName,
+    const HAPI_AttributeInfo *attributeInfo,
+    bool preserveScale)
 {
     typedef ARRAYTRAIT(T) Trait;
     typedef ELEMENTTRAIT(T) ElementTrait;
 
-    HAPI_AttributeInfo attrInfo;
+    if (!attributeInfo)
+    {
+        Trait::resize(particleArray, myPartInfo.pointCount);
+        Util::zeroArray(particleArray);
+        return false;
+    }
+
+    HAPI_AttributeInfo attrInfo = *attributeInfo;
 
-    std::vector<typename ElementTrait::ComponentType> dataArray;
-    if (!HAPI_FAIL(hapiGetPointAttribute(
-            myNodeId, myPartId, houdiniName, attrInfo, dataArray)))
+    // Other tuple sizes are reshaped component by component
+    if (attrInfo.tupleSize != static_cast<int>(ElementTrait::numComponents))
     {
+        std::vector<typename ElementTrait::ComponentType> dataArray;
+        if (HAPI_FAIL(hapiFetchAttribute(
+                myNodeId, myPartId, houdiniName, attrInfo, dataArray)))
+        {
+            Trait::resize(particleArray, myPartInfo.pointCount);
+            Util::zeroArray(particleArray);
+            return false;
+        }
+
         particleArray = Util::reshapeArray<T>(dataArray);
 
         if (preserveScale)
@@ -462,12 +1238,55 @@ OutputGeometryPart::convertParticleAttribute(T particleArray,
 
         return true;
     }
+
+    // Float attributes are fetched as they are, which is half the size, and
+    // converted to doubles on the worker threads.
+    const double scale = preserveScale ? 100.0 : 1.0;
+    HAPI_Result hapiResult;
+    if (attrInfo.storage == HAPI_STORAGETYPE_FLOAT)
+    {
+        hapiResult = hapiFetchAttribute(myNodeId, myPartId, houdiniName,
+                                        attrInfo, myParticleFloatBuffer);
+
+        myParticleDoubleBuffer.resize(myParticleFloatBuffer.size());
+        const float *src = myParticleFloatBuffer.data();
+        double *dst      = myParticleDoubleBuffer.data();
+        Util::parallelFor(myParticleFloatBuffer.size(), 1 << 16,
+                          [&](size_t begin, size_t end) {
+                              for (size_t i = begin; i < end; i++)
+                              {
+                                  dst[i] = src[i] * scale;
+                              }
+                          });
+    }
     else
+    {
+        hapiResult = hapiFetchAttribute(myNodeId, myPartId, houdiniName,
+                                        attrInfo, myParticleDoubleBuffer);
+
+        if (preserveScale)
+        {
+            double *data = myParticleDoubleBuffer.data();
+            Util::parallelFor(myParticleDoubleBuffer.size(), 1 << 16,
+                              [&](size_t begin, size_t end) {
+                                  for (size_t i = begin; i < end; i++)
+                                  {
+                                      data[i] *= scale;
+                                  }
+                              });
+        }
+    }
+
+    if (HAPI_FAIL(hapiResult))
     {
         Trait::resize(particleArray, myPartInfo.pointCount);
         Util::zeroArray(particleArray);
         return false;
     }
+
+    setParticleArray(particleArray, myParticleDoubleBuffer);
+
+    return true;
 }
 
 bool
@@ -498,17 +1317,17 @@ OutputGeometryPart::computeExtraAttribute(const MPlug &extraAttributePlug,
     MDataHandle dataHandle =
         extraAttributeHandle.child(AssetNode::outputPartExtraAttributeData);
 
-    HAPI_AttributeInfo attributeInfo;
-    HAPI_FAIL(HoudiniApi::GetAttributeInfo(Util::theHAPISession.get(), myNodeId,
-                                    myPartId, attributeName, attributeOwner,
-                                    &attributeInfo));
-    if (!attributeInfo.exists)
+    const HAPI_AttributeInfo *foundAttributeInfo =
+        findAttribute(attributeOwner, attributeName);
+    if (!foundAttributeInfo)
     {
         // HAPI might not be able to handle certain attributes (e.g.
         // tuple size is 0).
         return false;
     }
 
+    HAPI_AttributeInfo attributeInfo = *foundAttributeInfo;
+
     HAPI_StorageType storage = attributeInfo.storage;
 
     // Particle requires special treatment
@@ -535,8 +1354,7 @@ OutputGeometryPart::computeExtraAttribute(const MPlug &extraAttributePlug,
     if (storage == HAPI_STORAGETYPE_FLOAT)
     {
         MFloatArray floatArray;
-        hapiGetAttribute(myNodeId, myPartId, attributeOwner, attributeName,
-                         attributeInfo, floatArray);
+        getAttribute(attributeOwner, attributeName, attributeInfo, floatArray);
 
         if (attributeOwner == HAPI_ATTROWNER_DETAIL &&
             attributeInfo.tupleSize == 1)
@@ -586,8 +1404,7 @@ OutputGeometryPart::computeExtraAttribute(const MPlug &extraAttributePlug,
     else if (storage == HAPI_STORAGETYPE_FLOAT64)
     {
         MDoubleArray doubleArray;
-        hapiGetAttribute(myNodeId, myPartId, attributeOwner, attributeName,
-                         attributeInfo, doubleArray);
+        getAttribute(attributeOwner, attributeName, attributeInfo, doubleArray);
 
         if (attributeOwner == HAPI_ATTROWNER_DETAIL &&
             attributeInfo.tupleSize == 1)
@@ -646,8 +1463,7 @@ OutputGeometryPart::computeExtraAttribute(const MPlug &extraAttributePlug,
              storage == HAPI_STORAGETYPE_INT64)
     {
         MIntArray intArray;
-        hapiGetAttribute(myNodeId, myPartId, attributeOwner, attributeName,
-                         attributeInfo, intArray);
+        getAttribute(attributeOwner, attributeName, attributeInfo, intArray);
 
         if (attributeInfo.owner == HAPI_ATTROWNER_DETAIL &&
             attributeInfo.tupleSize == 1)
@@ -685,8 +1501,7 @@ OutputGeometryPart::computeExtraAttribute(const MPlug &extraAttributePlug,
     else if (storage == HAPI_STORAGETYPE_STRING)
     {
         MStringArray stringArray;
-        hapiGetAttribute(myNodeId, myPartId, attributeOwner, attributeName,
-                         attributeInfo, stringArray);
+        getAttribute(attributeOwner, attributeName, attributeInfo, stringArray);
 
         if (attributeInfo.owner == HAPI_ATTROWNER_DETAIL &&
             attributeInfo.tupleSize == 1)
@@ -800,8 +1615,8 @@ OutputGeometryPart::computeParticle(
         HAPI_AttributeInfo attrInfo;
 
         MDoubleArray idArray = arrayDataFn.doubleArray("id");
-        if (HAPI_FAIL(hapiGetPointAttribute(
-                myNodeId, myPartId, "id", attrInfo, idArray)))
+        if (HAPI_FAIL(
+                getAttribute(HAPI_ATTROWNER_POINT, "id", attrInfo, idArray)))
         {
             idArray.setLength(particleCount);
             for (unsigned int i = 0; i < idArray.length(); i++)
@@ -878,15 +1693,11 @@ OutputGeometryPart::computeParticle(
     markAttributeUsed("life");
 
     // other attributes
-    std::vector<HAPI_StringHandle> attributeNames(
-        myPartInfo.attributeCounts[HAPI_ATTROWNER_POINT]);
-    HoudiniApi::GetAttributeNames(Util::theHAPISession.get(), myNodeId, myPartId,
-                           HAPI_ATTROWNER_POINT,
-                           attributeNames.empty() ? NULL : &attributeNames[0],
-                           myPartInfo.attributeCounts[HAPI_ATTROWNER_POINT]);
-    for (unsigned int i = 0; i < attributeNames.size(); i++)
+    const std::vector<Attribute> &pointAttributes =
+        myAttributes[HAPI_ATTROWNER_POINT];
+    for (size_t i = 0; i < pointAttributes.size(); i++)
     {
-        MString attributeName = Util::HAPIString(attributeNames[i]);
+        MString attributeName = pointAttributes[i].name.c_str();
 
         // skip attributes that were done above already
         if (isAttributeUsed(attributeName.asChar()))
@@ -917,11 +1728,11 @@ OutputGeometryPart::computeParticle(
             translatedAttributeName = attributeName;
         }
 
-        HAPI_AttributeInfo attributeInfo;
-
-        HoudiniApi::GetAttributeInfo(Util::theHAPISession.get(), myNodeId, myPartId,
-                              attributeName.asChar(), HAPI_ATTROWNER_POINT,
-                              &attributeInfo);
+        const HAPI_AttributeInfo &attributeInfo = pointAttributes[i].info;
+        if (!attributeInfo.exists)
+        {
+            continue;
+        }
 
         HAPI_StorageType storage = attributeInfo.storage;
         if (storage == HAPI_STORAGETYPE_INT ||
@@ -937,19 +1748,186 @@ OutputGeometryPart::computeParticle(
         {
             convertParticleAttribute(
                 arrayDataFn.vectorArray(translatedAttributeName),
-                attributeName.asChar(), false);
+                attributeName.asChar(), &attributeInfo, false);
         }
         else if (storage == HAPI_STORAGETYPE_FLOAT64 &&
                  attributeInfo.tupleSize == 1)
         {
             convertParticleAttribute(
                 arrayDataFn.doubleArray(translatedAttributeName),
-                attributeName.asChar(), false);
+                attributeName.asChar(), &attributeInfo, false);
         }
     }
 }
 
 #if MAYA_API_VERSION >= 201400
+#ifdef max
+#undef max
+#endif
+#ifdef min
+#undef min
+#endif
+
+void
+OutputGeometryPart::fetchVolumeTiles(float *grid)
+{
+    const int xres          = myVolumeInfo.xLength;
+    const int yres          = myVolumeInfo.yLength;
+    const int zres          = myVolumeInfo.zLength;
+    const int tileSize      = myVolumeInfo.tileSize;
+    const int tileVoxelSize = tileSize * tileSize * tileSize;
+
+    // The grid is split in slots of tileSize voxels. A slot that is filled by a
+    // tile aligned to it doesn't need to be cleared. The other tiles are kept
+    // aside and written again once the empty slots are cleared.
+    const int xslots = (xres + tileSize - 1) / tileSize;
+    const int yslots = (yres + tileSize - 1) / tileSize;
+    const int zslots = (zres + tileSize - 1) / tileSize;
+    std::vector<char> filledSlots(
+        static_cast<size_t>(xslots) * yslots * zslots, false);
+    size_t filledVoxelCount = 0;
+
+    std::vector<HAPI_VolumeTileInfo> unalignedTileInfos;
+    std::vector<float> unalignedTiles;
+
+    // Fetch the tiles in batches of about 4MB, and scatter each batch in
+    // parallel.
+    const size_t batchSize = std::max((1 << 20) / tileVoxelSize, 1);
+    std::vector<HAPI_VolumeTileInfo> tileInfos;
+    std::vector<float> tiles(batchSize * tileVoxelSize);
+    tileInfos.reserve(batchSize);
+
+    HAPI_VolumeTileInfo tileInfo;
+    HoudiniApi::GetFirstVolumeTile(
+        Util::theHAPISession.get(), myNodeId, myPartId, &tileInfo);
+
+    while (tileInfo.minX != std::numeric_limits<int>::max() &&
+           tileInfo.minY != std::numeric_limits<int>::max() &&
+           tileInfo.minZ != std::numeric_limits<int>::max())
+    {
+        float *tile = &tiles[tileInfos.size() * tileVoxelSize];
+        HoudiniApi::GetVolumeTileFloatData(Util::theHAPISession.get(),
+                                           myNodeId, myPartId, 0.0f, &tileInfo,
+                                           tile, tileVoxelSize);
+        tileInfos.push_back(tileInfo);
+
+        const int x = tileInfo.minX - myVolumeInfo.minX;
+        const int y = tileInfo.minY - myVolumeInfo.minY;
+        const int z = tileInfo.minZ - myVolumeInfo.minZ;
+        if (x % tileSize == 0 && y % tileSize == 0 && z % tileSize == 0 &&
+            x >= 0 && y >= 0 && z >= 0 && x < xres && y < yres && z < zres)
+        {
+            char &filled = filledSlots[(static_cast<size_t>(z / tileSize) *
+                                            yslots +
+                                        y / tileSize) *
+                                           xslots +
+                                       x / tileSize];
+            if (!filled)
+            {
+                filled = true;
+                filledVoxelCount +=
+                    static_cast<size_t>(std::min(tileSize, xres - x)) *
+                    std::min(tileSize, yres - y) * std::min(tileSize, zres - z);
+            }
+        }
+        else
+        {
+            unalignedTileInfos.push_back(tileInfo);
+            unalignedTiles.insert(
+                unalignedTiles.end(), tile, tile + tileVoxelSize);
+        }
+
+        if (tileInfos.size() == batchSize)
+        {
+            scatterVolumeTiles(grid, tileInfos, tiles);
+            tileInfos.clear();
+        }
+
+        HoudiniApi::GetNextVolumeTile(
+            Util::theHAPISession.get(), myNodeId, myPartId, &tileInfo);
+    }
+
+    scatterVolumeTiles(grid, tileInfos, tiles);
+
+    if (filledVoxelCount == static_cast<size_t>(xres) * yres * zres)
+    {
+        return;
+    }
+
+    // Clear the slots that no tile filled
+    Util::parallelFor(
+        filledSlots.size(), 64, [&](size_t begin, size_t end) {
+            for (size_t slot = begin; slot < end; slot++)
+            {
+                if (filledSlots[slot])
+                    continue;
+
+                const int x = (slot % xslots) * tileSize;
+                const int y = (slot / xslots % yslots) * tileSize;
+                const int z = (slot / xslots / yslots) * tileSize;
+                const int xend = std::min(x + tileSize, xres);
+                const int yend = std::min(y + tileSize, yres);
+                const int zend = std::min(z + tileSize, zres);
+
+                for (int k = z; k < zend; k++)
+                    for (int j = y; j < yend; j++)
+                    {
+                        float *row = grid +
+                                     (static_cast<size_t>(k) * yres + j) * xres;
+                        std::fill(row + x, row + xend, 0.0f);
+                    }
+            }
+        });
+
+    scatterVolumeTiles(grid, unalignedTileInfos, unalignedTiles);
+}
+
+void
+OutputGeometryPart::scatterVolumeTiles(
+    float *grid,
+    const std::vector<HAPI_VolumeTileInfo> &tileInfos,
+    const std::vector<float> &tiles) const
+{
+    const int xres          = myVolumeInfo.xLength;
+    const int yres          = myVolumeInfo.yLength;
+    const int zres          = myVolumeInfo.zLength;
+    const int tileSize      = myVolumeInfo.tileSize;
+    const int tileVoxelSize = tileSize * tileSize * tileSize;
+
+    // The tiles don't overlap, so they can be written from any thread. Each
+    // tile is clipped to the grid once, and then copied a row at a time. For
+    // the tiles inside the grid, that's a plain copy of every row.
+    Util::parallelFor(tileInfos.size(), 16, [&](size_t begin, size_t end) {
+        for (size_t t = begin; t < end; t++)
+        {
+            const HAPI_VolumeTileInfo &tileInfo = tileInfos[t];
+            const float *tile                   = &tiles[t * tileVoxelSize];
+
+            const int x = tileInfo.minX - myVolumeInfo.minX;
+            const int y = tileInfo.minY - myVolumeInfo.minY;
+            const int z = tileInfo.minZ - myVolumeInfo.minZ;
+
+            const int ibegin = std::max(0, -x);
+            const int jbegin = std::max(0, -y);
+            const int kbegin = std::max(0, -z);
+            const int iend   = std::min(tileSize, xres - x);
+            const int jend   = std::min(tileSize, yres - y);
+            const int kend   = std::min(tileSize, zres - z);
+
+            for (int k = kbegin; k < kend; k++)
+                for (int j = jbegin; j < jend; j++)
+                {
+                    const float *src = tile + (k * tileSize + j) * tileSize;
+                    float *dst       = grid +
+                                 (static_cast<size_t>(z + k) * yres + y + j) *
+                                     xres +
+                                 x;
+                    std::copy(src + ibegin, src + iend, dst + ibegin);
+                }
+        }
+    });
+}
+
 void
 OutputGeometryPart::computeVolume(const MTime &time,
                                   const MPlug &volumePlug,
@@ -977,55 +1955,17 @@ OutputGeometryPart::computeVolume(const MTime &time,
 
         MFloatArray grid = gridDataFn.array();
 
-        int xres     = myVolumeInfo.xLength;
-        int yres     = myVolumeInfo.yLength;
-        int zres     = myVolumeInfo.zLength;
-        int tileSize = myVolumeInfo.tileSize;
-
-        grid.setLength(xres * yres * zres);
-        for (unsigned int i = 0; i < grid.length(); i++)
-            grid[i] = 0.0f;
-
-        std::vector<float> tile;
-        tile.resize(tileSize * tileSize * tileSize);
-
-        HAPI_VolumeTileInfo tileInfo;
-        HoudiniApi::GetFirstVolumeTile(
-            Util::theHAPISession.get(), myNodeId, myPartId, &tileInfo);
+        const int xres     = myVolumeInfo.xLength;
+        const int yres     = myVolumeInfo.yLength;
+        const int zres     = myVolumeInfo.zLength;
+        const int tileSize = myVolumeInfo.tileSize;
 
-#ifdef max
-#undef max
-#endif
+        const size_t voxelCount = static_cast<size_t>(xres) * yres * zres;
+        grid.setLength(static_cast<unsigned int>(voxelCount));
 
-        while (tileInfo.minX != std::numeric_limits<int>::max() &&
-               tileInfo.minY != std::numeric_limits<int>::max() &&
-               tileInfo.minZ != std::numeric_limits<int>::max())
+        if (voxelCount && tileSize > 0)
         {
-            HoudiniApi::GetVolumeTileFloatData(Util::theHAPISession.get(), myNodeId,
-                                        myPartId, 0.0f, &tileInfo,
-                                        &tile.front(), (int)tile.size());
-
-            for (int k = 0; k < tileSize; k++)
-                for (int j = 0; j < tileSize; j++)
-                    for (int i = 0; i < tileSize; i++)
-                    {
-                        int z = k + tileInfo.minZ - myVolumeInfo.minZ,
-                            y = j + tileInfo.minY - myVolumeInfo.minY,
-                            x = i + tileInfo.minX - myVolumeInfo.minX;
-
-                        int index = xres * yres * z + xres * y + x;
-
-                        float value =
-                            tile[k * tileSize * tileSize + j * tileSize + i];
-                        if (x < xres && y < yres && z < zres && x >= 0 &&
-                            y >= 0 && z >= 0)
-                        {
-                            grid[index] = value;
-                        }
-                    }
-
-            HoudiniApi::GetNextVolumeTile(
-                Util::theHAPISession.get(), myNodeId, myPartId, &tileInfo);
+            fetchVolumeTiles(&grid[0]);
         }
     }
 
@@ -1097,8 +2037,8 @@ OutputGeometryPart::computeMesh(const MTime &time,
     std::vector<int> intArray;
 
     int currentlayer = -1;
-    if (!HAPI_FAIL(hapiGetDetailAttribute(
-            myNodeId, myPartId, "currentlayer", attrInfo, currentlayer)))
+    if (!HAPI_FAIL(getAttribute(
+            HAPI_ATTROWNER_DETAIL, "currentlayer", attrInfo, currentlayer)))
     {
         currentlayer -= 1;
     }
@@ -1107,7 +2047,7 @@ OutputGeometryPart::computeMesh(const MTime &time,
     MFloatPointArray vertexArray;
     if (hasMesh)
     {
-        hapiGetPointAttribute(myNodeId, myPartId, "P", attrInfo, floatArray);
+        getAttribute(HAPI_ATTROWNER_POINT, "P", attrInfo, floatArray);
 
         if (options.preserveScale())
         {
@@ -1121,27 +2061,65 @@ OutputGeometryPart::computeMesh(const MTime &time,
     }
 
     // polygon counts
-    MIntArray polygonCounts;
     if (hasMesh)
     {
-        intArray.resize(myPartInfo.faceCount);
-
-        HoudiniApi::GetFaceCounts(Util::theHAPISession.get(), myNodeId, myPartId,
-                           &intArray.front(), 0, myPartInfo.faceCount);
-
-        polygonCounts = MIntArray(&intArray.front(), intArray.size());
+        getFaceCounts(intArray);
     }
 
     // polygon connects
     std::vector<int> polygonConnectsReversed;
-    MIntArray polygonConnects;
     if (hasMesh)
     {
-        polygonConnectsReversed.resize(myPartInfo.vertexCount);
+        getVertexList(polygonConnectsReversed);
+    }
+
+    // If the topology and the other mesh attributes are the same as in the
+    // last compute, only the points need to be updated in the existing mesh.
+    unsigned long long meshTopologyHash = Util::hashSeed;
+    bool hasMeshTopologyHash            = false;
+    if (hasMesh)
+    {
+        hashValue(meshTopologyHash, myPartId);
+        hashValue(meshTopologyHash, vertexArray.length());
+        hashArray(meshTopologyHash, intArray);
+        hashArray(meshTopologyHash, polygonConnectsReversed);
+        hasMeshTopologyHash = hashMeshAttributes(meshTopologyHash, options);
+    }
+
+    const bool isTopologyUnchanged = hasMeshTopologyHash &&
+                                     myHasMeshTopologyHash &&
+                                     meshTopologyHash == myMeshTopologyHash;
+    if (isTopologyUnchanged)
+    {
+        MFnMesh meshFn(meshDataObj, &status);
+        const bool isSameMesh =
+            status && meshFn.numVertices() == (int)vertexArray.length();
+
+        // A deform-only frame must only update the points of the mesh that
+        // was output last time.
+        const bool isPointsSet = isSameMesh && meshFn.setPoints(vertexArray);
+        assert(isPointsSet || !isSameMesh);
+        if (isPointsSet)
+        {
+            hasMeshHandle.setBool(hasMesh);
+
+            for (size_t i = 0; i < myMeshAttributesUsed.size(); i++)
+            {
+                markAttributeUsed(myMeshAttributesUsed[i]);
+            }
 
-        HoudiniApi::GetVertexList(Util::theHAPISession.get(), myNodeId, myPartId,
-                           &polygonConnectsReversed.front(), 0,
-                           myPartInfo.vertexCount);
+            return;
+        }
+    }
+
+    // The hash is only kept once the mesh is fully computed.
+    myHasMeshTopologyHash = false;
+
+    MIntArray polygonCounts;
+    MIntArray polygonConnects;
+    if (hasMesh)
+    {
+        polygonCounts = MIntArray(&intArray.front(), intArray.size());
 
         polygonConnects = MIntArray(
             &polygonConnectsReversed.front(), polygonConnectsReversed.size());
@@ -1214,9 +2192,8 @@ OutputGeometryPart::computeMesh(const MTime &time,
     std::vector<int> lockedNormal;
     if (hasMesh)
     {
-        if (!HAPI_FAIL(hapiGetVertexAttribute(myNodeId, myPartId,
-                                              "maya_locked_normal", attrInfo,
-                                              lockedNormal)))
+        if (!HAPI_FAIL(getAttribute(HAPI_ATTROWNER_VERTEX, "maya_locked_normal",
+                                    attrInfo, lockedNormal)))
         {
             markAttributeUsed("maya_locked_normal");
 
@@ -1235,9 +2212,9 @@ OutputGeometryPart::computeMesh(const MTime &time,
                 lockedNormal.clear();
             }
         }
-        else if (!HAPI_FAIL(hapiGetPointAttribute(myNodeId, myPartId,
-                                                  "maya_locked_normal",
-                                                  attrInfo, lockedNormal)))
+        else if (!HAPI_FAIL(getAttribute(HAPI_ATTROWNER_POINT,
+                                         "maya_locked_normal", attrInfo,
+                                         lockedNormal)))
         {
             markAttributeUsed("maya_locked_normal");
 
@@ -1265,13 +2242,13 @@ OutputGeometryPart::computeMesh(const MTime &time,
         options.outputMeshPreserveLockedNormals())
     {
         HAPI_AttributeOwner normalOwner = HAPI_ATTROWNER_MAX;
-        if (!HAPI_FAIL(hapiGetVertexAttribute(
-                myNodeId, myPartId, "N", attrInfo, floatArray)))
+        if (!HAPI_FAIL(getAttribute(
+                HAPI_ATTROWNER_VERTEX, "N", attrInfo, floatArray)))
         {
             normalOwner = HAPI_ATTROWNER_VERTEX;
         }
-        else if (!HAPI_FAIL(hapiGetPointAttribute(
-                     myNodeId, myPartId, "N", attrInfo, floatArray)))
+        else if (!HAPI_FAIL(getAttribute(
+                     HAPI_ATTROWNER_POINT, "N", attrInfo, floatArray)))
         {
             normalOwner = HAPI_ATTROWNER_POINT;
         }
@@ -1374,8 +2351,8 @@ OutputGeometryPart::computeMesh(const MTime &time,
     // hard/soft edge
     if (hasMesh && options.outputMeshPreserveHardEdges())
     {
-        if (!HAPI_FAIL(hapiGetVertexAttribute(
-                myNodeId, myPartId, "maya_hard_edge", attrInfo, intArray)))
+        if (!HAPI_FAIL(getAttribute(
+                HAPI_ATTROWNER_VERTEX, "maya_hard_edge", attrInfo, intArray)))
         {
             markAttributeUsed("maya_hard_edge");
 
@@ -1459,16 +2436,16 @@ OutputGeometryPart::computeMesh(const MTime &time,
         MStringArray uvSetNames;
         MStringArray mappedUVAttributeNames;
 
-        hapiGetDetailAttribute(
-            myNodeId, myPartId, "maya_uv_current", attrInfo, currentUVSetName);
+        getAttribute(HAPI_ATTROWNER_DETAIL, "maya_uv_current", attrInfo,
+                     currentUVSetName);
         markAttributeUsed("maya_uv_current");
 
-        hapiGetDetailAttribute(
-            myNodeId, myPartId, "maya_uv_name", attrInfo, uvSetNames);
+        getAttribute(
+            HAPI_ATTROWNER_DETAIL, "maya_uv_name", attrInfo, uvSetNames);
         markAttributeUsed("maya_uv_name");
 
-        hapiGetDetailAttribute(myNodeId, myPartId, "maya_uv_mapped_uv",
-                               attrInfo, mappedUVAttributeNames);
+        getAttribute(HAPI_ATTROWNER_DETAIL, "maya_uv_mapped_uv", attrInfo,
+                     mappedUVAttributeNames);
         markAttributeUsed("maya_uv_mapped_uv");
 
         bool useMappedUV =
@@ -1517,15 +2494,15 @@ OutputGeometryPart::computeMesh(const MTime &time,
 
             HAPI_AttributeInfo uvAttrInfo;
             bool found = false;
-            if (!HAPI_FAIL(hapiGetVertexAttribute(myNodeId, myPartId,
-                                                  uvAttributeName.asChar(),
-                                                  uvAttrInfo, floatArray)))
+            if (!HAPI_FAIL(getAttribute(HAPI_ATTROWNER_VERTEX,
+                                        uvAttributeName.asChar(), uvAttrInfo,
+                                        floatArray)))
             {
                 found = true;
             }
-            else if (!HAPI_FAIL(hapiGetPointAttribute(myNodeId, myPartId,
-                                                      uvAttributeName.asChar(),
-                                                      uvAttrInfo, floatArray)))
+            else if (!HAPI_FAIL(getAttribute(HAPI_ATTROWNER_POINT,
+                                             uvAttributeName.asChar(),
+                                             uvAttrInfo, floatArray)))
             {
                 found = true;
             }
@@ -1687,24 +2664,24 @@ OutputGeometryPart::computeMesh(const MTime &time,
         MStringArray mappedAlphaAttributeNames;
         MStringArray colorReps;
 
-        hapiGetDetailAttribute(myNodeId, myPartId, "maya_colorset_current",
-                               attrInfo, currentColorSetName);
+        getAttribute(HAPI_ATTROWNER_DETAIL, "maya_colorset_current", attrInfo,
+                     currentColorSetName);
         markAttributeUsed("maya_colorset_current");
 
-        hapiGetDetailAttribute(
-            myNodeId, myPartId, "maya_colorset_name", attrInfo, colorSetNames);
+        getAttribute(HAPI_ATTROWNER_DETAIL, "maya_colorset_name", attrInfo,
+                     colorSetNames);
         markAttributeUsed("maya_colorset_name");
 
-        hapiGetDetailAttribute(myNodeId, myPartId, "maya_colorset_mapped_Cd",
-                               attrInfo, mappedCdAttributeNames);
+        getAttribute(HAPI_ATTROWNER_DETAIL, "maya_colorset_mapped_Cd", attrInfo,
+                     mappedCdAttributeNames);
         markAttributeUsed("maya_colorset_mapped_Cd");
 
-        hapiGetDetailAttribute(myNodeId, myPartId, "maya_colorset_mapped_Alpha",
-                               attrInfo, mappedAlphaAttributeNames);
+        getAttribute(HAPI_ATTROWNER_DETAIL, "maya_colorset_mapped_Alpha",
+                     attrInfo, mappedAlphaAttributeNames);
         markAttributeUsed("maya_colorset_mapped_Alpha");
 
-        hapiGetDetailAttribute(
-            myNodeId, myPartId, "maya_colorRep", attrInfo, colorReps);
+        getAttribute(
+            HAPI_ATTROWNER_DETAIL, "maya_colorRep", attrInfo, colorReps);
         markAttributeUsed("maya_colorRep");
 
         // if there is no Alpha, still want to map the color set names
@@ -1744,9 +2721,8 @@ OutputGeometryPart::computeMesh(const MTime &time,
 #endif
 
             HAPI_AttributeOwner colorOwner;
-            if (!HAPI_FAIL(hapiGetAnyAttribute(myNodeId, myPartId,
-                                               cdAttributeName.asChar(),
-                                               attrInfo, floatArray)))
+            if (!HAPI_FAIL(getAnyAttribute(
+                    cdAttributeName.asChar(), attrInfo, floatArray)))
             {
                 colorOwner = attrInfo.owner;
             }
@@ -1757,9 +2733,8 @@ OutputGeometryPart::computeMesh(const MTime &time,
 
             HAPI_AttributeOwner alphaOwner;
             std::vector<float> alphaArray;
-            if (!HAPI_FAIL(hapiGetAnyAttribute(myNodeId, myPartId,
-                                               alphaAttributeName.asChar(),
-                                               attrInfo, alphaArray)))
+            if (!HAPI_FAIL(getAnyAttribute(
+                    alphaAttributeName.asChar(), attrInfo, alphaArray)))
             {
                 alphaOwner = attrInfo.owner;
             }
@@ -1937,6 +2912,10 @@ OutputGeometryPart::computeMesh(const MTime &time,
             layerIndex++;
         }
     }
+
+    myMeshTopologyHash    = meshTopologyHash;
+    myHasMeshTopologyHash = hasMeshTopologyHash;
+    myMeshAttributesUsed  = myAttributesUsed;
 }
 
 void
@@ -1984,7 +2963,8 @@ OutputGeometryPart::computeInstancer(const MTime &time,
                                      MDataBlock &data,
                                      MDataHandle &hasInstancerHandle,
                                      MDataHandle &instanceHandle,
-                                     const bool preserveScale)
+                                     const bool preserveScale,
+                                     const bool useInstancerNode)
 {
     data.setClean(hasInstancerPlug);
     data.setClean(instancerPlug);
@@ -2027,54 +3007,96 @@ OutputGeometryPart::computeInstancer(const MTime &time,
             instanceCount ? &transforms.front() : NULL, 0, instanceCount));
         markAttributeUsed("P");
 
+        // The transforms are converted on the worker threads into one buffer
+        // per array, which is then copied into the array in one call.
+        std::vector<double> positionBuffer(instanceCount * 3);
+        std::vector<double> rotationBuffer(instanceCount * 3);
+        std::vector<double> scaleBuffer(instanceCount * 3);
+        const double positionScale = preserveScale ? 100.0 : 1.0;
+        Util::parallelFor(instanceCount, 4096, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++)
+            {
+                const HAPI_Transform &transform = transforms[i];
+
+                double *p = &positionBuffer[i * 3];
+                double *r = &rotationBuffer[i * 3];
+                double *s = &scaleBuffer[i * 3];
+                for (int j = 0; j < 3; j++)
+                {
+                    p[j] = transform.position[j] * positionScale;
+                    s[j] = transform.scale[j];
+                }
+
+                // Euler angles in the XYZ rotation order, like
+                // MQuaternion::asEulerRotation()
+                const double x = transform.rotationQuaternion[0];
+                const double y = transform.rotationQuaternion[1];
+                const double z = transform.rotationQuaternion[2];
+                const double w = transform.rotationQuaternion[3];
+
+                const double lengthSquared = x * x + y * y + z * z + w * w;
+                const double k = lengthSquared > 0.0 ? 2.0 / lengthSquared :
+                                                       0.0;
+
+                const double sinY = k * (w * y - z * x);
+                r[0] = std::atan2(k * (w * x + y * z),
+                                  1.0 - k * (x * x + y * y));
+                r[1] = std::asin((std::max)(-1.0, (std::min)(1.0, sinY)));
+                r[2] = std::atan2(k * (w * z + x * y),
+                                  1.0 - k * (y * y + z * z));
+            }
+        });
+
+        // Particle instancer
         MVectorArray positions  = instancerArrayDataFn.vectorArray("position");
         MVectorArray rotations  = instancerArrayDataFn.vectorArray("rotation");
         MVectorArray scales     = instancerArrayDataFn.vectorArray("scale");
         MIntArray objectIndices = instancerArrayDataFn.intArray("objectIndex");
 
-        positions.setLength(instanceCount);
-        rotations.setLength(instanceCount);
-        scales.setLength(instanceCount);
-        objectIndices.setLength(instanceCount);
-        Util::resizeArrayDataHandle(instancerTransformHandle, instanceCount);
-
-        for (int i = 0; i < instanceCount; i++)
-        {
-            const HAPI_Transform &transform = transforms[i];
-
-            MVector p(transform.position[0], transform.position[1],
-                      transform.position[2]);
-            MVector r = MQuaternion(transform.rotationQuaternion[0],
-                                    transform.rotationQuaternion[1],
-                                    transform.rotationQuaternion[2],
-                                    transform.rotationQuaternion[3])
-                            .asEulerRotation()
-                            .asVector();
-            MVector s(
-                transform.scale[0], transform.scale[1], transform.scale[2]);
-
-            if (preserveScale)
-                p *= 100.0;
-
-            // Particle instancer
-            positions[i]     = p;
-            rotations[i]     = r;
-            scales[i]        = s;
-            objectIndices[i] = 0;
-
-            // Transform Instancing
-            CHECK_MSTATUS(instancerTransformHandle.jumpToArrayElement(i));
-            MDataHandle transformHandle =
-                instancerTransformHandle.outputValue();
-            MDataHandle translateHandle =
-                transformHandle.child(AssetNode::outputPartInstancerTranslate);
-            translateHandle.set(p);
-            MDataHandle rotateHandle =
-                transformHandle.child(AssetNode::outputPartInstancerRotate);
-            rotateHandle.set(r);
-            MDataHandle scaleHandle =
-                transformHandle.child(AssetNode::outputPartInstancerScale);
-            scaleHandle.set(s);
+        if (instanceCount)
+        {
+            positions = MVectorArray(
+                reinterpret_cast<double(*)[3]>(&positionBuffer.front()),
+                instanceCount);
+            rotations = MVectorArray(
+                reinterpret_cast<double(*)[3]>(&rotationBuffer.front()),
+                instanceCount);
+            scales = MVectorArray(
+                reinterpret_cast<double(*)[3]>(&scaleBuffer.front()),
+                instanceCount);
+        }
+        else
+        {
+            positions.clear();
+            rotations.clear();
+            scales.clear();
+        }
+        objectIndices = MIntArray(instanceCount, 0);
+
+        // Transform Instancing. The instancer node only reads the arrays.
+        if (useInstancerNode)
+        {
+            Util::resizeArrayDataHandle(instancerTransformHandle, 0);
+        }
+        else
+        {
+            Util::resizeArrayDataHandle(
+                instancerTransformHandle, instanceCount);
+            for (int i = 0; i < instanceCount; i++)
+            {
+                CHECK_MSTATUS(instancerTransformHandle.jumpToArrayElement(i));
+                MDataHandle transformHandle =
+                    instancerTransformHandle.outputValue();
+                MDataHandle translateHandle = transformHandle.child(
+                    AssetNode::outputPartInstancerTranslate);
+                translateHandle.set(positions[i]);
+                MDataHandle rotateHandle =
+                    transformHandle.child(AssetNode::outputPartInstancerRotate);
+                rotateHandle.set(rotations[i]);
+                MDataHandle scaleHandle =
+                    transformHandle.child(AssetNode::outputPartInstancerScale);
+                scaleHandle.set(scales[i]);
+            }
         }
     }
 
@@ -2131,60 +3153,25 @@ OutputGeometryPart::computeExtraAttributes(
         HAPI_ATTROWNER_POINT,
         HAPI_ATTROWNER_VERTEX,
     };
-    const int attributeCounts[] = {
-        myPartInfo.attributeCounts[HAPI_ATTROWNER_DETAIL],
-        myPartInfo.attributeCounts[HAPI_ATTROWNER_PRIM],
-        myPartInfo.attributeCounts[HAPI_ATTROWNER_POINT],
-        myPartInfo.attributeCounts[HAPI_ATTROWNER_VERTEX],
-    };
 
     size_t newSize = 0;
 
-    std::array<std::vector<char>, HAPI_ATTROWNER_MAX> attributeNames;
-
     for (size_t i = 0; i < HAPI_ATTROWNER_MAX; i++)
     {
-        const HAPI_AttributeOwner &owner = attributeOwners[i];
-        const int &attributeCount        = attributeCounts[i];
+        const std::vector<Attribute> &attributes =
+            myAttributes[attributeOwners[i]];
 
-        std::vector<HAPI_StringHandle> ownerAttributeNames(attributeCount);
-
-        if (attributeCount > 0)
-        {
-            HoudiniApi::GetAttributeNames(Util::theHAPISession.get(), myNodeId, myPartId,
-                                owner, &ownerAttributeNames[0],
-                                attributeCount);
-
-            int stringsbuffer_len;
-            HoudiniApi::GetStringBatchSize(Util::theHAPISession.get(), &ownerAttributeNames[0],
-                                    attributeCount, &stringsbuffer_len);
-
-            attributeNames[i].resize(stringsbuffer_len);
-            HoudiniApi::GetStringBatch(
-                Util::theHAPISession.get(), &attributeNames[i][0], stringsbuffer_len);
-        }
-    }
-
-    for (size_t i = 0; i < HAPI_ATTROWNER_MAX; i++)
-    {
-        const int &attributeCount = attributeCounts[i];
-
-        auto read_iter = attributeNames[i].begin();
-        for (int j = 0; j < attributeCount; j++)
+        for (size_t j = 0; j < attributes.size(); j++)
         {
-            auto next_null = std::find(read_iter, attributeNames[i].end(), '\0');
-            MString attributeName(&(*read_iter));
+            MString attributeName(attributes[j].name.c_str());
 
             if (isAttributeUsed(attributeName.asChar()) ||
                 Util::startsWith(attributeName, "__"))
             {
-                read_iter = next_null + 1;
                 continue;
             }
 
             newSize++;
-
-            read_iter = next_null + 1;
         }
     }
 
@@ -2198,24 +3185,16 @@ OutputGeometryPart::computeExtraAttributes(
 
     for (size_t i = 0; i < HAPI_ATTROWNER_MAX; i++)
     {
-        const HAPI_AttributeOwner &owner = attributeOwners[i];
-        const int &attributeCount        = attributeCounts[i];
-
-        if (attributeCount == 0)
-        {
-            continue;
-        }
+        const HAPI_AttributeOwner &owner         = attributeOwners[i];
+        const std::vector<Attribute> &attributes = myAttributes[owner];
 
-        auto read_iter = attributeNames[i].begin();
-        for (int j = 0; j < attributeCount; ++j)
+        for (size_t j = 0; j < attributes.size(); ++j)
         {
-            auto next_null = std::find(read_iter, attributeNames[i].end(), '\0');
-            MString attributeName(&(*read_iter));
+            MString attributeName(attributes[j].name.c_str());
 
             if (isAttributeUsed(attributeName.asChar()) ||
                 Util::startsWith(attributeName, "__"))
             {
-                read_iter = next_null + 1;
                 continue;
             }
 
@@ -2236,8 +3215,6 @@ OutputGeometryPart::computeExtraAttributes(
                                 "    ^1s",
                                 attributeName);
             }
-
-            read_iter = next_null + 1;
         }
     }
 
@@ -18,6 +18,17 @@ public:
 
     bool needCompute(AssetNodeOptions::AccessorDataBlock &options) const;
 
+    // Hashes the geometry that compute() reads from HAPI, and returns whether
+    // it differs from the last time. Volumes and instancers are always
+    // considered changed. When the part changed, the following compute()
+    // uses the attribute directory and the data fetched for the hash.
+    bool hasContentChanged(const MTime &time,
+                           AssetNodeOptions::AccessorDataBlock &options);
+    // Forgets the hash of the last content, so that the next compute outputs
+    // the part again. The mesh topology is still compared, so that only the
+    // points are updated when it's unchanged.
+    void invalidateContentHash();
+
     MStatus compute(const MTime &time,
                     const MPlug &partPlug,
                     MDataBlock &data,
@@ -27,6 +38,7 @@ public:
 
 protected:
     void update();
+    void updateAttributes();
 
 private:
     void computeMaterial(const MTime &time,
@@ -63,13 +75,18 @@ private:
     void computeVolumeTransform(const MTime &time,
                                 MDataHandle &volumeTransformHandle,
                                 const bool preserveScale);
+    void fetchVolumeTiles(float *grid);
+    void scatterVolumeTiles(float *grid,
+                            const std::vector<HAPI_VolumeTileInfo> &tileInfos,
+                            const std::vector<float> &tiles) const;
     void computeInstancer(const MTime &time,
                           const MPlug &hasInstancerPlug,
                           const MPlug &instancePlug,
                           MDataBlock &data,
                           MDataHandle &hasInstancerHandle,
                           MDataHandle &instanceHandle,
-                          const bool preserveScale);
+                          const bool preserveScale,
+                          const bool useInstancerNode);
     void computeExtraAttributes(const MTime &time,
                                 const MPlug &extraAttributesPlug,
                                 MDataBlock &data,
@@ -83,6 +100,43 @@ private:
                        AssetNodeOptions::AccessorDataBlock &options,
                        bool &needToSyncOutputs);
 
+    bool hashContent(unsigned long long &hash,
+                     const MTime &time,
+                     AssetNodeOptions::AccessorDataBlock &options);
+    bool hashAttributes(unsigned long long &hash,
+                        HAPI_AttributeOwner owner,
+                        bool (*filter)(const char *) = NULL);
+    struct Attribute;
+    bool hashAttributeData(Attribute &attribute);
+    bool hashMeshAttributes(unsigned long long &hash,
+                            AssetNodeOptions::AccessorDataBlock &options);
+    bool hashGroups(unsigned long long &hash);
+
+    const HAPI_AttributeInfo *findAttribute(HAPI_AttributeOwner owner,
+                                            const char *name) const;
+
+    template <typename T>
+    HAPI_Result getAttribute(HAPI_AttributeOwner owner,
+                             const char *name,
+                             HAPI_AttributeInfo &attrInfo,
+                             T &data);
+    // Takes the data that was fetched for the hash, if there is some.
+    HAPI_Result getAttribute(HAPI_AttributeOwner owner,
+                             const char *name,
+                             HAPI_AttributeInfo &attrInfo,
+                             std::vector<float> &data);
+
+    // Like the attributes, the topology that was fetched for the hash is
+    // taken by computeMesh().
+    bool getFaceCounts(std::vector<int> &faceCounts);
+    bool getVertexList(std::vector<int> &vertexList);
+    void clearFetchedData();
+
+    template <typename T>
+    HAPI_Result getAnyAttribute(const char *name,
+                                HAPI_AttributeInfo &attrInfo,
+                                T &data);
+
     template <typename T>
     bool getAttributeData(std::vector<T> &array,
                           const char *name,
@@ -92,6 +146,11 @@ private:
     bool convertParticleAttribute(T arrayDataFn,
                                   const char *houdiniName,
                                   bool preserveScale);
+    template <typename T>
+    bool convertParticleAttribute(T arrayDataFn,
+                                  const char *houdiniName,
+                                  const HAPI_AttributeInfo *attributeInfo,
+                                  bool preserveScale);
 
     bool computeExtraAttribute(const MPlug &extraAttributePlug,
                                MDataBlock &data,
@@ -114,8 +173,42 @@ private:
     HAPI_VolumeInfo myVolumeInfo;
     HAPI_CurveInfo myCurveInfo;
 
+    // The attributes of the part in HAPI order, fetched once per update, so
+    // that looking one up doesn't need a HAPI call. The hash of the data is
+    // kept once it's computed, along with the float data that was fetched
+    // for it until compute() takes it.
+    struct Attribute
+    {
+        std::string name;
+        HAPI_AttributeInfo info;
+
+        bool isHashed;
+        unsigned long long hash;
+        std::vector<float> floatData;
+    };
+    std::vector<Attribute> myAttributes[HAPI_ATTROWNER_MAX];
+
+    // Whether update() already ran for the next compute().
+    bool myIsUpdated;
+
+    std::vector<int> myFaceCounts;
+    std::vector<int> myVertexList;
+
     bool myLastOutputGeometryGroups;
     bool myLastOutputCustomAttributes;
+
+    unsigned long long myContentHash;
+    bool myHasContentHash;
+
+    // Topology of the last mesh output, and the attributes it used, so that
+    // only the points need to be updated while the topology doesn't change.
+    unsigned long long myMeshTopologyHash;
+    bool myHasMeshTopologyHash;
+    std::vector<std::string> myMeshAttributesUsed;
+
+    // Reused by the particle attributes, so that they are not reallocated.
+    std::vector<float> myParticleFloatBuffer;
+    std::vector<double> myParticleDoubleBuffer;
 };
 
 #endif
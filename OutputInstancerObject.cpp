@@ -11,9 +11,130 @@
 #include "hapiutil.h"
 #include "util.h"
 
+#include <cstring>
+#include <string>
+#include <unordered_map>
+
+namespace
+{
+// Fetches a string point attribute as a table of its unique strings, and the
+// index of the string of each point in the table. The points usually share a
+// few strings, so each string handle is only fetched once, and all of them
+// are fetched in one batch.
+void
+getPointStrings(HAPI_NodeId nodeId,
+                const char *name,
+                int pointCount,
+                MStringArray &strings,
+                std::vector<int> &indices)
+{
+    strings.clear();
+    indices.clear();
+
+    HAPI_AttributeInfo attrInfo;
+    CHECK_HAPI_AND(
+        HoudiniApi::GetAttributeInfo(Util::theHAPISession.get(), nodeId, 0,
+                                     name, HAPI_ATTROWNER_POINT, &attrInfo),
+        return;);
+    if (!attrInfo.exists || attrInfo.storage != HAPI_STORAGETYPE_STRING ||
+        attrInfo.tupleSize != 1 || attrInfo.count != pointCount ||
+        pointCount <= 0)
+    {
+        return;
+    }
+
+    std::vector<HAPI_StringHandle> handles(pointCount);
+    CHECK_HAPI_AND(HoudiniApi::GetAttributeStringData(
+                       Util::theHAPISession.get(), nodeId, 0, name,
+                       &attrInfo, &handles[0], 0, pointCount),
+                   return;);
+
+    std::unordered_map<HAPI_StringHandle, int> handleIndices;
+    std::vector<HAPI_StringHandle> uniqueHandles;
+    indices.resize(pointCount);
+    for (int i = 0; i < pointCount; i++)
+    {
+        std::pair<std::unordered_map<HAPI_StringHandle, int>::iterator, bool>
+            result = handleIndices.insert(
+                std::make_pair(handles[i], (int)uniqueHandles.size()));
+        if (result.second)
+        {
+            uniqueHandles.push_back(handles[i]);
+        }
+        indices[i] = result.first->second;
+    }
+
+    int bufferSize = 0;
+    CHECK_HAPI_AND(HoudiniApi::GetStringBatchSize(
+                       Util::theHAPISession.get(), &uniqueHandles[0],
+                       uniqueHandles.size(), &bufferSize),
+                   indices.clear();
+                   return;);
+    std::vector<char> buffer((std::max)(bufferSize, 1), '\0');
+    if (bufferSize > 0)
+    {
+        CHECK_HAPI_AND(HoudiniApi::GetStringBatch(Util::theHAPISession.get(),
+                                                  &buffer[0], bufferSize),
+                       indices.clear();
+                       return;);
+    }
+
+    // Different handles can still have the same string
+    std::unordered_map<std::string, int> stringIndices;
+    std::vector<int> handleStringIndices(uniqueHandles.size(), 0);
+    size_t offset = 0;
+    for (size_t i = 0; i < uniqueHandles.size(); i++)
+    {
+        const char *string = offset < buffer.size() ? &buffer[offset] : "";
+        offset += strlen(string) + 1;
+
+        std::pair<std::unordered_map<std::string, int>::iterator, bool>
+            result = stringIndices.insert(
+                std::make_pair(std::string(string), (int)strings.length()));
+        if (result.second)
+        {
+            strings.append(string);
+        }
+        handleStringIndices[i] = result.first->second;
+    }
+
+    for (int i = 0; i < pointCount; i++)
+    {
+        indices[i] = handleStringIndices[indices[i]];
+    }
+}
+
+// Returns the last component of a path, e.g. the object of an instance path.
+std::string
+lastPathComponent(const char *path)
+{
+    const std::string string(path);
+
+    const size_t end = string.find_last_not_of('/');
+    if (end == std::string::npos)
+    {
+        return std::string();
+    }
+
+    const size_t separator = string.rfind('/', end);
+    const size_t start = separator == std::string::npos ? 0 : separator + 1;
+    return string.substr(start, end - start + 1);
+}
+
+const MString &
+pointString(const MStringArray &strings,
+            const std::vector<int> &indices,
+            unsigned int point)
+{
+    static const MString theEmptyString;
+
+    return point < indices.size() ? strings[indices[point]] : theEmptyString;
+}
+}
+
 OutputInstancerObject::OutputInstancerObject(HAPI_NodeId nodeId)
     : OutputObject(nodeId),
-      myGeoInfo(HAPI_GeoInfo_Create()),
+      myGeoInfo(HoudiniApi::GeoInfo_Create()),
       myLastSopCookCount(0)
 {
 }
@@ -31,17 +152,17 @@ OutputInstancerObject::update()
 {
     HAPI_Result hapiResult;
 
-    hapiResult = HAPI_GetNodeInfo(
+    hapiResult = HoudiniApi::GetNodeInfo(
         Util::theHAPISession.get(), myNodeId, &myNodeInfo);
     CHECK_HAPI(hapiResult);
 
-    hapiResult = HAPI_GetObjectInfo(
+    hapiResult = HoudiniApi::GetObjectInfo(
         Util::theHAPISession.get(), myNodeId, &myObjectInfo);
     CHECK_HAPI(hapiResult);
 
     // Get the SOP nodes
     int geoCount;
-    hapiResult = HAPI_ComposeChildNodeList(
+    hapiResult = HoudiniApi::ComposeChildNodeList(
         Util::theHAPISession.get(), myNodeId, HAPI_NODETYPE_SOP,
         HAPI_NODEFLAGS_DISPLAY, false, &geoCount);
     CHECK_HAPI(hapiResult);
@@ -49,16 +170,16 @@ OutputInstancerObject::update()
     std::vector<HAPI_NodeId> geoNodeIds(geoCount);
     if (geoCount > 0)
     {
-        hapiResult = HAPI_GetComposedChildNodeList(
+        hapiResult = HoudiniApi::GetComposedChildNodeList(
             Util::theHAPISession.get(), myNodeId, &geoNodeIds.front(),
             geoCount);
         CHECK_HAPI(hapiResult);
 
-        hapiResult = HAPI_GetNodeInfo(
+        hapiResult = HoudiniApi::GetNodeInfo(
             Util::theHAPISession.get(), geoNodeIds[0], &mySopNodeInfo);
         CHECK_HAPI(hapiResult);
 
-        hapiResult = HAPI_GetGeoInfo(
+        hapiResult = HoudiniApi::GetGeoInfo(
             Util::theHAPISession.get(), geoNodeIds[0], &myGeoInfo);
         CHECK_HAPI(hapiResult);
     }
@@ -66,13 +187,14 @@ OutputInstancerObject::update()
     if (mySopNodeInfo.totalCookCount > myLastSopCookCount)
     {
         // clear the arrays
-        myInstancedObjectNames.clear();
         myInstancedObjectIndices.clear();
         myUniqueInstObjNames.clear();
-        myHoudiniInstanceAttribute.clear();
-        myHoudiniNameAttribute.clear();
+        myHoudiniInstanceStrings.clear();
+        myHoudiniInstanceIndices.clear();
+        myHoudiniNameStrings.clear();
+        myHoudiniNameIndices.clear();
 
-        hapiResult = HAPI_GetPartInfo(
+        hapiResult = HoudiniApi::GetPartInfo(
             Util::theHAPISession.get(), mySopNodeInfo.id, 0, &myPartInfo);
         CHECK_HAPI(hapiResult);
 
@@ -82,48 +204,47 @@ OutputInstancerObject::update()
             return;
         }
 
-        // fill array of size pointCount of instanced names
-        HAPI_AttributeInfo attrInfo;
-        MStringArray instanceAttrs;
-        hapiGetPointAttribute(
-            mySopNodeInfo.id, 0, "instance", attrInfo, instanceAttrs);
-        for (unsigned int i = 0; i < instanceAttrs.length(); i++)
+        getPointStrings(mySopNodeInfo.id, "instance", myPartInfo.pointCount,
+                        myHoudiniInstanceStrings, myHoudiniInstanceIndices);
+        getPointStrings(mySopNodeInfo.id, "name", myPartInfo.pointCount,
+                        myHoudiniNameStrings, myHoudiniNameIndices);
+
+        // Get a list of unique instanced names, and compute the object indices
+        // that would be passed to Maya instancer. Only the unique instance
+        // strings need to be looked at.
+        std::unordered_map<std::string, int> objectIndices;
+        std::vector<int> stringObjectIndices(
+            myHoudiniInstanceStrings.length());
+        for (unsigned int i = 0; i < myHoudiniInstanceStrings.length(); i++)
         {
-            MStringArray splitObjName;
-            instanceAttrs[i].split('/', splitObjName);
-            myInstancedObjectNames.append(
-                splitObjName[splitObjName.length() - 1]);
-            myHoudiniInstanceAttribute.append(instanceAttrs[i]);
+            const std::string objectName = lastPathComponent(
+                myHoudiniInstanceStrings[i].asChar());
+
+            std::pair<std::unordered_map<std::string, int>::iterator, bool>
+                result = objectIndices.insert(std::make_pair(
+                    objectName, (int)myUniqueInstObjNames.length()));
+            if (result.second)
+            {
+                myUniqueInstObjNames.append(objectName.c_str());
+            }
+            stringObjectIndices[i] = result.first->second;
         }
 
-        MStringArray nameAttrs;
-        hapiGetPointAttribute(mySopNodeInfo.id, 0, "name", attrInfo, nameAttrs);
-        for (unsigned int ii = 0; ii < nameAttrs.length(); ii++)
+        std::vector<int> instancedObjectIndices(
+            myHoudiniInstanceIndices.size());
+        for (size_t i = 0; i < myHoudiniInstanceIndices.size(); i++)
         {
-            myHoudiniNameAttribute.append(nameAttrs[ii]);
+            instancedObjectIndices[i] =
+                stringObjectIndices[myHoudiniInstanceIndices[i]];
         }
-
-        // get a list of unique instanced names, and compute the object indices
-        // that would be passed to Maya instancer
-        for (unsigned int i = 0; i < myInstancedObjectNames.length(); ++i)
+        if (!instancedObjectIndices.empty())
         {
-            bool duplicate = false;
-            unsigned int j = 0;
-            for (; j < myUniqueInstObjNames.length(); ++j)
-            {
-                if (myUniqueInstObjNames[j] == myInstancedObjectNames[i])
-                {
-                    duplicate = true;
-                    break;
-                }
-            }
-            if (!duplicate)
-                myUniqueInstObjNames.append(myInstancedObjectNames[i]);
-            myInstancedObjectIndices.append((int)j);
+            myInstancedObjectIndices = MIntArray(
+                &instancedObjectIndices[0], instancedObjectIndices.size());
         }
 
         // Workaround a crash where we can't determine the object to instance.
-        if (!myInstancedObjectNames.length())
+        if (myHoudiniInstanceIndices.empty())
         {
             myInstancedObjectIndices = MIntArray(myPartInfo.pointCount, -1);
         }
@@ -189,11 +310,11 @@ OutputInstancerObject::compute(const MTime &time,
         MVectorArray scales     = arrayDataFn.vectorArray("scale");
         MIntArray objectIndices = arrayDataFn.intArray("objectIndex");
 
-        unsigned int size              = myPartInfo.pointCount;
-        HAPI_Transform *instTransforms = new HAPI_Transform[size];
-        CHECK_HAPI(HAPI_GetInstanceTransformsOnPart(
+        unsigned int size = myPartInfo.pointCount;
+        myTransformBuffer.resize(size);
+        CHECK_HAPI(HoudiniApi::GetInstanceTransformsOnPart(
             Util::theHAPISession.get(), mySopNodeInfo.id, 0, HAPI_SRT,
-            instTransforms, 0, size));
+            size ? &myTransformBuffer.front() : NULL, 0, size));
 
         Util::resizeArrayDataHandle(houdiniInstanceAttributeHandle, size);
         Util::resizeArrayDataHandle(houdiniNameAttributeHandle, size);
@@ -211,7 +332,7 @@ OutputInstancerObject::compute(const MTime &time,
 
         for (unsigned int j = 0; j < size; j++)
         {
-            HAPI_Transform it = instTransforms[j];
+            const HAPI_Transform &it = myTransformBuffer[j];
             MVector p(it.position[0], it.position[1], it.position[2]);
             MVector r = MQuaternion(
                             it.rotationQuaternion[0], it.rotationQuaternion[1],
@@ -233,12 +354,14 @@ OutputInstancerObject::compute(const MTime &time,
             CHECK_MSTATUS(houdiniInstanceAttributeHandle.jumpToArrayElement(j));
             MDataHandle intanceAttributeHandle =
                 houdiniInstanceAttributeHandle.outputValue();
-            intanceAttributeHandle.set(myHoudiniInstanceAttribute[j]);
+            intanceAttributeHandle.set(pointString(
+                myHoudiniInstanceStrings, myHoudiniInstanceIndices, j));
 
             CHECK_MSTATUS(houdiniNameAttributeHandle.jumpToArrayElement(j));
             MDataHandle nameAttributeHandle =
                 houdiniNameAttributeHandle.outputValue();
-            nameAttributeHandle.set(myHoudiniNameAttribute[j]);
+            nameAttributeHandle.set(
+                pointString(myHoudiniNameStrings, myHoudiniNameIndices, j));
 
             CHECK_MSTATUS(instanceTransformHandle.jumpToArrayElement(j));
             MDataHandle transformHandle = instanceTransformHandle.outputValue();
@@ -285,17 +408,15 @@ OutputInstancerObject::compute(const MTime &time,
         houdiniNameAttributeHandle.setAllClean();
         instanceTransformHandle.setAllClean();
 
-        delete[] instTransforms;
-
         if (myObjectInfo.objectToInstanceId >= 0)
         {
             // instancing a single object
             Util::resizeArrayDataHandle(instancedObjectNamesHandle, 1);
 
             HAPI_ObjectInfo instanceObjectInfo;
-            CHECK_HAPI(HAPI_GetObjectInfo(Util::theHAPISession.get(),
-                                          myObjectInfo.objectToInstanceId,
-                                          &instanceObjectInfo));
+            CHECK_HAPI(HoudiniApi::GetObjectInfo(Util::theHAPISession.get(),
+                                                 myObjectInfo.objectToInstanceId,
+                                                 &instanceObjectInfo));
             MString name = Util::HAPIString(instanceObjectInfo.nameSH);
 
             CHECK_MSTATUS(instancedObjectNamesHandle.jumpToArrayElement(0));
@@ -4,6 +4,8 @@
 #include "AssetNodeOptions.h"
 #include "OutputObject.h"
 
+#include <vector>
+
 class OutputInstancerObject : public OutputObject
 {
 public:
@@ -37,12 +39,18 @@ private:
 
     int myLastSopCookCount;
 
-    MStringArray myInstancedObjectNames;
     MStringArray myUniqueInstObjNames;
     MIntArray myInstancedObjectIndices;
 
-    MStringArray myHoudiniInstanceAttribute;
-    MStringArray myHoudiniNameAttribute;
+    // The unique strings of the instance and name attributes, and the index
+    // of the string of each point in them.
+    MStringArray myHoudiniInstanceStrings;
+    std::vector<int> myHoudiniInstanceIndices;
+    MStringArray myHoudiniNameStrings;
+    std::vector<int> myHoudiniNameIndices;
+
+    // Reused between the computes, so that it is not reallocated.
+    std::vector<HAPI_Transform> myTransformBuffer;
 };
 
 #endif
@@ -1,19 +1,441 @@
 #include "OutputMaterial.h"
 
 #include <maya/MDataHandle.h>
+#include <maya/MEventMessage.h>
+#include <maya/MFileObject.h>
+#include <maya/MObjectHandle.h>
 #include <maya/MStatus.h>
+#include <maya/MStringArray.h>
+
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "AssetNode.h"
 #include "util.h"
 
+namespace
+{
+// Textures are baked while Maya is idle, one per idle event, so that changing
+// a parm doesn't block until all the textures of the materials are rendered.
+// The images are stored in a folder of the plugin under the source images of
+// the workspace. They are named after the material and a hash of its parm
+// values, so that a material that is computed again with the same values
+// reuses its image without rendering it. Only the last image of each material
+// is kept.
+struct TextureBake
+{
+    MObjectHandle node;
+    MPlug materialPlug;
+    HAPI_NodeId nodeId;
+    int texturePathParmIndex;
+    unsigned long long key;
+    MString filePrefix;
+    MString fileName;
+};
+
+std::deque<TextureBake> theTextureBakes;
+MCallbackId theBakeIdleCallbackId = 0;
+bool theHasBakeIdleCallback       = false;
+
+// The materials whose textures were baked, which are computed again at once
+// when the queue is empty, rather than cooking the asset after every bake.
+MStringArray theBakedMaterialPlugs;
+
+MString theTextureCachePath;
+MCallbackId theWorkspaceCallbackId = 0;
+bool theHasWorkspaceCallback       = false;
+
+void
+workspaceChangedCallback(void *clientData)
+{
+    theTextureCachePath.clear();
+}
+
+// Resolves the folder of the baked textures once, and again after the
+// workspace changes.
+const MString &
+textureCachePath()
+{
+    if (theTextureCachePath.length())
+    {
+        return theTextureCachePath;
+    }
+
+    MString sourceImagesPath;
+    MGlobal::executeCommand("workspace -expandName "
+                            "`workspace -q -fileRuleEntry sourceImages`;",
+                            sourceImagesPath);
+    theTextureCachePath = sourceImagesPath + "/houdiniEngineTextures";
+    MGlobal::executeCommand(
+        "sysFile -makeDir \"" + theTextureCachePath + "\"");
+
+    if (!theHasWorkspaceCallback)
+    {
+        MStatus status;
+        theWorkspaceCallbackId = MEventMessage::addEventCallback(
+            "workspaceChanged", workspaceChangedCallback, NULL, &status);
+        theHasWorkspaceCallback = status;
+        CHECK_MSTATUS(status);
+    }
+
+    return theTextureCachePath;
+}
+
+bool
+fileExists(const MString &path)
+{
+    MFileObject file;
+    file.setRawFullName(path);
+    return file.exists();
+}
+
+// Deletes the images that were baked for the material before, which all start
+// with the prefix of the material.
+void
+deleteStaleTextures(const MString &folderPath,
+                    const MString &filePrefix,
+                    const MString &fileName)
+{
+    MStringArray fileNames;
+    MGlobal::executeCommand("getFileList -folder \"" + folderPath +
+                                "/\" -filespec \"" + filePrefix + "*\"",
+                            fileNames);
+
+    for (unsigned int i = 0; i < fileNames.length(); i++)
+    {
+        if (fileNames[i].substring(0, fileName.length() - 1) == fileName)
+        {
+            continue;
+        }
+
+        MGlobal::executeCommand(
+            "sysFile -delete \"" + folderPath + "/" + fileNames[i] + "\"");
+    }
+}
+
+// Hashes the values of all the parms of the material node, which determine
+// its texture.
+bool
+hashMaterial(HAPI_NodeId nodeId, unsigned long long &hash)
+{
+    hash = Util::hashSeed;
+    return Util::hashParmValues(nodeId, hash);
+}
+
+// The material nodes of each asset by path, which is built again once the
+// asset cooked, so that finding a material doesn't fetch the path of every
+// node each time.
+struct MaterialIndex
+{
+    bool isBuilt;
+    int cookCount;
+    std::unordered_map<std::string, HAPI_NodeId> nodeIds;
+};
+
+std::unordered_map<HAPI_NodeId, MaterialIndex> theMaterialIndices;
+
+HAPI_NodeId
+findMaterialNode(HAPI_NodeId assetId, const std::string &path)
+{
+    HAPI_NodeInfo assetInfo;
+    CHECK_HAPI_AND_RETURN(HoudiniApi::GetNodeInfo(Util::theHAPISession.get(),
+                                                  assetId, &assetInfo),
+                          -1);
+
+    MaterialIndex &index = theMaterialIndices[assetId];
+    if (!index.isBuilt || index.cookCount != assetInfo.totalCookCount)
+    {
+        index.isBuilt   = true;
+        index.cookCount = assetInfo.totalCookCount;
+        index.nodeIds.clear();
+
+        int count;
+        CHECK_HAPI_AND_RETURN(
+            HoudiniApi::ComposeChildNodeList(
+                Util::theHAPISession.get(), assetId,
+                HAPI_NODETYPE_SHOP | HAPI_NODETYPE_VOP, HAPI_NODEFLAGS_ANY,
+                true, &count),
+            -1);
+
+        std::vector<HAPI_NodeId> nodeIds(count);
+        std::vector<HAPI_StringHandle> pathHandles(count);
+        if (count)
+        {
+            CHECK_HAPI_AND_RETURN(
+                HoudiniApi::GetComposedChildNodeList(
+                    Util::theHAPISession.get(), assetId, &nodeIds[0], count),
+                -1);
+        }
+
+        // the paths are fetched in one batch
+        for (int i = 0; i < count; i++)
+        {
+            CHECK_HAPI(HoudiniApi::GetNodePath(Util::theHAPISession.get(),
+                                               nodeIds[i], assetId,
+                                               &pathHandles[i]));
+        }
+
+        int bufferSize = 0;
+        if (count)
+        {
+            CHECK_HAPI_AND_RETURN(
+                HoudiniApi::GetStringBatchSize(Util::theHAPISession.get(),
+                                               &pathHandles[0], count,
+                                               &bufferSize),
+                -1);
+        }
+
+        if (bufferSize > 0)
+        {
+            std::vector<char> buffer(bufferSize);
+            CHECK_HAPI_AND_RETURN(
+                HoudiniApi::GetStringBatch(Util::theHAPISession.get(),
+                                           &buffer[0], bufferSize),
+                -1);
+
+            size_t offset = 0;
+            for (int i = 0; i < count && offset < buffer.size(); i++)
+            {
+                const char *nodePath = &buffer[offset];
+                offset += strlen(nodePath) + 1;
+
+                // the first node with the path is used
+                index.nodeIds.insert(std::make_pair(nodePath, nodeIds[i]));
+            }
+        }
+    }
+
+    std::unordered_map<std::string, HAPI_NodeId>::const_iterator iter =
+        index.nodeIds.find(path);
+    return iter != index.nodeIds.end() ? iter->second : -1;
+}
+
+void
+removeBakeIdleCallback()
+{
+    if (theHasBakeIdleCallback)
+    {
+        MMessage::removeCallback(theBakeIdleCallbackId);
+        theHasBakeIdleCallback = false;
+    }
+}
+
+// Dirties the materials whose textures were baked, so that their asset nodes
+// compute them again with the images.
+void
+dirtyBakedMaterials()
+{
+    if (!theBakedMaterialPlugs.length())
+    {
+        return;
+    }
+
+    MString command = "dgdirty";
+    for (unsigned int i = 0; i < theBakedMaterialPlugs.length(); i++)
+    {
+        command += " \"" + theBakedMaterialPlugs[i] + "\"";
+    }
+    theBakedMaterialPlugs.clear();
+
+    MGlobal::executeCommand(command);
+}
+
+// Renders and extracts the image of a queued texture. Returns whether the
+// image was baked.
+bool
+bakeTexture(const TextureBake &bake)
+{
+    if (!bake.node.isValid())
+    {
+        return false;
+    }
+
+    // The parms may have changed since the bake was queued, in which case
+    // another bake was queued for the new values.
+    unsigned long long key;
+    if (!hashMaterial(bake.nodeId, key) || key != bake.key)
+    {
+        return false;
+    }
+
+    const MString &folderPath = textureCachePath();
+
+    // this could fail if texture parameter is empty
+    if (HAPI_FAIL(HoudiniApi::RenderTextureToImage(Util::theHAPISession.get(),
+                                                   bake.nodeId,
+                                                   bake.texturePathParmIndex)))
+    {
+        return false;
+    }
+
+    // this could fail if the image planes don't exist
+    HAPI_StringHandle filePathSH = 0;
+    if (HAPI_FAIL(HoudiniApi::ExtractImageToFile(
+            Util::theHAPISession.get(), bake.nodeId, HAPI_PNG_FORMAT_NAME,
+            "C A", folderPath.asChar(), bake.fileName.asChar(),
+            &filePathSH)))
+    {
+        DISPLAY_ERROR("Could not extract image to directory:\n"
+                      "    ^1s",
+                      folderPath);
+        DISPLAY_ERROR_HAPI_STATUS_CALL();
+        return false;
+    }
+
+    deleteStaleTextures(folderPath, bake.filePrefix, bake.fileName);
+
+    return true;
+}
+
+// Bakes one of the queued textures each time Maya is idle. Once all of them
+// are baked, their materials are computed again.
+void
+bakeIdleCallback(void *clientData)
+{
+    if (theTextureBakes.empty() || !Util::theHAPISession.get())
+    {
+        theTextureBakes.clear();
+        theBakedMaterialPlugs.clear();
+        removeBakeIdleCallback();
+        return;
+    }
+
+    TextureBake bake = theTextureBakes.front();
+    theTextureBakes.pop_front();
+
+    if (bakeTexture(bake))
+    {
+        const MString plugName = bake.materialPlug.name();
+        if (theBakedMaterialPlugs.indexOf(plugName) < 0)
+        {
+            theBakedMaterialPlugs.append(plugName);
+        }
+    }
+
+    if (theTextureBakes.empty())
+    {
+        removeBakeIdleCallback();
+        dirtyBakedMaterials();
+    }
+}
+
+void
+queueTextureBake(const TextureBake &bake)
+{
+    for (size_t i = 0; i < theTextureBakes.size(); i++)
+    {
+        if (theTextureBakes[i].fileName == bake.fileName &&
+            theTextureBakes[i].nodeId == bake.nodeId)
+        {
+            return;
+        }
+    }
+
+    theTextureBakes.push_back(bake);
+
+    if (!theHasBakeIdleCallback)
+    {
+        MStatus status;
+        theBakeIdleCallbackId = MEventMessage::addEventCallback(
+            "idle", bakeIdleCallback, NULL, &status);
+        theHasBakeIdleCallback = status;
+        CHECK_MSTATUS(status);
+    }
+}
+}
+
 OutputMaterial::OutputMaterial(HAPI_NodeId assetId)
     : myAssetId(assetId),
       myNodeId(-1),
       myMaterialLastCookCount(0),
-      myBakeTexture(0)
+      myBakeTexture(0),
+      myIsBakingTexture(false)
 {
 }
 
+void
+OutputMaterial::cancelTextureBakes()
+{
+    theTextureBakes.clear();
+    theBakedMaterialPlugs.clear();
+    removeBakeIdleCallback();
+
+    if (theHasWorkspaceCallback)
+    {
+        MMessage::removeCallback(theWorkspaceCallbackId);
+        theHasWorkspaceCallback = false;
+    }
+    theTextureCachePath.clear();
+}
+
+void
+OutputMaterial::removeAsset(HAPI_NodeId assetId)
+{
+    theMaterialIndices.erase(assetId);
+}
+
+MString
+OutputMaterial::bakedTexturePath(const MPlug &materialPlug,
+                                 int texturePathParmIndex,
+                                 bool queueBake)
+{
+    unsigned long long key;
+    if (!hashMaterial(myNodeId, key))
+    {
+        return MString();
+    }
+
+    // The prefix identifies the asset node, the material node and its
+    // texture parm, which have one image at a time.
+    const std::string assetName =
+        Util::getNodeName(materialPlug.node()).asChar();
+    unsigned long long materialKey = Util::hashSeed;
+    materialKey = Util::hashBytes(
+        materialKey, assetName.c_str(), assetName.size());
+    materialKey = Util::hashBytes(
+        materialKey, myNodePath.c_str(), myNodePath.size());
+    materialKey = Util::hashBytes(
+        materialKey, &texturePathParmIndex, sizeof(texturePathParmIndex));
+
+    char materialKeyString[17];
+    char keyString[17];
+    snprintf(materialKeyString, sizeof(materialKeyString), "%016llx",
+             materialKey);
+    snprintf(keyString, sizeof(keyString), "%016llx", key);
+
+    const MString filePrefix = MString(Util::HAPIString(myNodeInfo.nameSH)) +
+                               "_" + materialKeyString + "_";
+    const MString fileName = filePrefix + keyString;
+    const MString filePath = textureCachePath() + "/" + fileName + "." +
+                             HAPI_PNG_FORMAT_NAME;
+    if (fileExists(filePath))
+    {
+        return filePath;
+    }
+
+    if (!queueBake)
+    {
+        return MString();
+    }
+
+    TextureBake bake;
+    bake.node                 = MObjectHandle(materialPlug.node());
+    bake.materialPlug         = materialPlug;
+    bake.nodeId               = myNodeId;
+    bake.texturePathParmIndex = texturePathParmIndex;
+    bake.key                  = key;
+    bake.filePrefix           = filePrefix;
+    bake.fileName             = fileName;
+    queueTextureBake(bake);
+
+    myIsBakingTexture = true;
+    return MString();
+}
+
 MStatus
 OutputMaterial::compute(const MTime &time,
                         const MPlug &materialPlug,
@@ -21,8 +443,6 @@ OutputMaterial::compute(const MTime &time,
                         MDataHandle &materialHandle,
                         bool bakeTexture)
 {
-    HAPI_Result hapiResult;
-
     data.setClean(materialPlug);
 
     update(materialHandle);
@@ -51,129 +471,90 @@ OutputMaterial::compute(const MTime &time,
         materialHandle.child(AssetNode::outputMaterialTexturePath);
 
     HAPI_MaterialInfo materialInfo;
-    CHECK_HAPI(HAPI_GetMaterialInfo(
+    CHECK_HAPI(HoudiniApi::GetMaterialInfo(
         Util::theHAPISession.get(), myNodeId, &materialInfo));
 
     if (myNodeInfo.totalCookCount > myMaterialLastCookCount ||
-        materialInfo.hasChanged || bakeTexture != myBakeTexture)
+        materialInfo.hasChanged || bakeTexture != myBakeTexture ||
+        myIsBakingTexture)
     {
-        myBakeTexture = bakeTexture;
+        myBakeTexture     = bakeTexture;
+        myIsBakingTexture = false;
         std::vector<HAPI_ParmInfo> parms(myNodeInfo.parmCount);
-        HAPI_GetParameters(Util::theHAPISession.get(), myNodeId, &parms[0], 0,
-                           myNodeInfo.parmCount);
+        HoudiniApi::GetParameters(Util::theHAPISession.get(), myNodeId, &parms[0], 0,
+                                  myNodeInfo.parmCount);
 
         int ambientParmIndex       = Util::findParm(parms, "ogl_amb");
         int diffuseParmIndex       = Util::findParm(parms, "ogl_diff");
         int alphaParmIndex         = Util::findParm(parms, "ogl_alpha");
         int specularParmIndex      = Util::findParm(parms, "ogl_spec");
         int texturePathSHParmIndex = Util::findParm(parms, "ogl_tex#", 1);
-        float valueHolder[4];
+
+        // all the float values are fetched at once
+        std::vector<float> floatValues(
+            (std::max)(myNodeInfo.parmFloatValueCount, 1), 0.0f);
+        if (myNodeInfo.parmFloatValueCount > 0)
+        {
+            CHECK_HAPI(HoudiniApi::GetParmFloatValues(
+                Util::theHAPISession.get(), myNodeId, &floatValues[0], 0,
+                myNodeInfo.parmFloatValueCount));
+        }
 
         nameHandle.setString(Util::HAPIString(myNodeInfo.nameSH));
 
         if (ambientParmIndex >= 0)
         {
-            HAPI_GetParmFloatValues(
-                Util::theHAPISession.get(), myNodeId, valueHolder,
-                parms[ambientParmIndex].floatValuesIndex, 3);
-            ambientHandle.set3Float(
-                valueHolder[0], valueHolder[1], valueHolder[2]);
+            const float *values =
+                &floatValues[parms[ambientParmIndex].floatValuesIndex];
+            ambientHandle.set3Float(values[0], values[1], values[2]);
         }
 
         if (specularParmIndex >= 0)
         {
-            HAPI_GetParmFloatValues(
-                Util::theHAPISession.get(), myNodeId, valueHolder,
-                parms[specularParmIndex].floatValuesIndex, 3);
-            specularHandle.set3Float(
-                valueHolder[0], valueHolder[1], valueHolder[2]);
+            const float *values =
+                &floatValues[parms[specularParmIndex].floatValuesIndex];
+            specularHandle.set3Float(values[0], values[1], values[2]);
         }
 
         if (diffuseParmIndex >= 0)
         {
-            HAPI_GetParmFloatValues(
-                Util::theHAPISession.get(), myNodeId, valueHolder,
-                parms[diffuseParmIndex].floatValuesIndex, 3);
-            diffuseHandle.set3Float(
-                valueHolder[0], valueHolder[1], valueHolder[2]);
+            const float *values =
+                &floatValues[parms[diffuseParmIndex].floatValuesIndex];
+            diffuseHandle.set3Float(values[0], values[1], values[2]);
         }
 
         if (alphaParmIndex >= 0)
         {
-            HAPI_GetParmFloatValues(Util::theHAPISession.get(), myNodeId,
-                                    valueHolder,
-                                    parms[alphaParmIndex].floatValuesIndex, 1);
-            float alpha = 1 - valueHolder[0];
+            float alpha =
+                1 - floatValues[parms[alphaParmIndex].floatValuesIndex];
             alphaHandle.set3Float(alpha, alpha, alpha);
         }
 
         if (texturePathSHParmIndex >= 0)
         {
-            HAPI_ParmInfo texturePathParm;
-            HAPI_GetParameters(Util::theHAPISession.get(), myNodeId,
-                               &texturePathParm, texturePathSHParmIndex, 1);
+            const HAPI_ParmInfo &texturePathParm =
+                parms[texturePathSHParmIndex];
 
             int texturePathSH;
-            HAPI_GetParmStringValues(Util::theHAPISession.get(), myNodeId, true,
-                                     &texturePathSH,
-                                     texturePathParm.stringValuesIndex, 1);
+            HoudiniApi::GetParmStringValues(Util::theHAPISession.get(), myNodeId, true,
+                                            &texturePathSH,
+                                            texturePathParm.stringValuesIndex, 1);
 
             bool hasTextureSource =
                 ((std::string)Util::HAPIString(texturePathSH)).size() > 0;
-            bool canRenderTexture = false;
-            if (hasTextureSource && bakeTexture)
-            {
-                // this could fail if texture parameter is empty
-                hapiResult = HAPI_RenderTextureToImage(
-                    Util::theHAPISession.get(), myNodeId,
-                    texturePathSHParmIndex);
-
-                canRenderTexture = hapiResult == HAPI_RESULT_SUCCESS;
-            }
 
-            int destinationFilePathSH = 0;
-            MString destinationFolderPath;
-            MGlobal::executeCommand(
-                "workspace -expandName "
-                "`workspace -q -fileRuleEntry sourceImages`;",
-                destinationFolderPath);
-
-            if (canRenderTexture && bakeTexture)
+            MString texturePath;
+            if (hasTextureSource)
             {
-                // this could fail if the image planes don't exist
-                hapiResult = HAPI_ExtractImageToFile(
-                    Util::theHAPISession.get(), myNodeId, HAPI_PNG_FORMAT_NAME,
-                    "C A", destinationFolderPath.asChar(), NULL,
-                    &destinationFilePathSH);
-                if (HAPI_FAIL(hapiResult))
-                {
-                    DISPLAY_ERROR("Could not extract image to directory:\n"
-                                  "    ^1s",
-                                  destinationFolderPath);
-                    DISPLAY_ERROR_HAPI_STATUS_CALL();
-                }
+                // Until the texture is baked, the previous one is kept. If
+                // baking is off but the texture was baked for the current
+                // values, it's still used.
+                texturePath = bakedTexturePath(
+                    materialPlug, texturePathSHParmIndex, bakeTexture);
             }
 
-            if (hasTextureSource && !bakeTexture)
+            if (texturePath.length())
             {
-                // if baking is off but the expected texture file exists
-                // keep using it
-                hapiResult = HAPI_GetImageFilePath(
-                    Util::theHAPISession.get(), myNodeId, HAPI_PNG_FORMAT_NAME,
-                    "C A", destinationFolderPath.asChar(), NULL,
-                    texturePathSHParmIndex, &destinationFilePathSH);
-
-                MString texturePath = Util::HAPIString(destinationFilePathSH);
-                MString cmd         = "filetest -e \"" + texturePath + "\"";
-                int fileExists;
-                MGlobal::executeCommand(cmd, fileExists);
-                if (!fileExists)
-                    destinationFilePathSH = 0;
-            }
-
-            if (destinationFilePathSH > 0)
-            {
-                MString texturePath = Util::HAPIString(destinationFilePathSH);
                 texturePathHandle.set(texturePath);
             }
         }
@@ -199,34 +580,7 @@ OutputMaterial::update(MDataHandle &materialHandle)
     // find node id from path
     if (myNodeId < 0)
     {
-        int count;
-        CHECK_HAPI(
-            HAPI_ComposeChildNodeList(Util::theHAPISession.get(), myAssetId,
-                                      HAPI_NODETYPE_SHOP | HAPI_NODETYPE_VOP,
-                                      HAPI_NODEFLAGS_ANY, true, &count));
-
-        std::vector<HAPI_NodeId> nodeIds(count);
-        if (count)
-        {
-            CHECK_HAPI(HAPI_GetComposedChildNodeList(
-                Util::theHAPISession.get(), myAssetId, &nodeIds[0], count));
-        }
-
-        for (size_t i = 0; i < nodeIds.size(); i++)
-        {
-            HAPI_NodeId testNodeId = nodeIds[i];
-
-            HAPI_StringHandle testPath;
-
-            CHECK_HAPI(HAPI_GetNodePath(
-                Util::theHAPISession.get(), testNodeId, myAssetId, &testPath));
-
-            if (Util::HAPIString(testPath) == path)
-            {
-                myNodeId = testNodeId;
-                break;
-            }
-        }
+        myNodeId = findMaterialNode(myAssetId, path);
     }
 
     if (myNodeId < 0)
@@ -238,5 +592,5 @@ OutputMaterial::update(MDataHandle &materialHandle)
 
     // get material info
     CHECK_HAPI(
-        HAPI_GetNodeInfo(Util::theHAPISession.get(), myNodeId, &myNodeInfo));
+        HoudiniApi::GetNodeInfo(Util::theHAPISession.get(), myNodeId, &myNodeInfo));
 }
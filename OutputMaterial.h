@@ -7,7 +7,9 @@
 
 #include <maya/MDataBlock.h>
 #include <maya/MDataHandle.h>
+#include <maya/MPlug.h>
 #include <maya/MStatus.h>
+#include <maya/MString.h>
 #include <maya/MTime.h>
 
 class OutputMaterial
@@ -21,9 +23,23 @@ public:
                     MDataHandle &materialHandle,
                     bool bakeTexture);
 
+    // Cancels the texture bakes that are still queued, e.g. when the plugin
+    // is unloaded.
+    static void cancelTextureBakes();
+
+    // Forgets the material nodes of an asset that is deleted, since its node
+    // id may be reused.
+    static void removeAsset(HAPI_NodeId assetId);
+
 private:
     void update(MDataHandle &materialHandle);
 
+    // Returns the path of the baked texture for the current parm values, and
+    // queues the bake if queueBake is true and the texture doesn't exist.
+    MString bakedTexturePath(const MPlug &materialPlug,
+                             int texturePathParmIndex,
+                             bool queueBake);
+
 private:
     HAPI_NodeId myAssetId;
 
@@ -33,6 +49,10 @@ private:
     HAPI_NodeInfo myNodeInfo;
     int myMaterialLastCookCount;
     bool myBakeTexture;
+
+    // Whether the texture is being baked in the background, after which the
+    // material is computed again.
+    bool myIsBakingTexture;
 };
 
 #endif
@@ -102,7 +102,7 @@ struct HAPIAttributeTrait<HAPI_STORAGETYPE_INT>
                                     int start,
                                     int length)
     {
-        return HAPI_SetAttributeIntData(
+        return HoudiniApi::SetAttributeIntData(
             session, nodeId, partId, name, attrInfo, dataArray, start, length);
     }
 
@@ -115,8 +115,8 @@ struct HAPIAttributeTrait<HAPI_STORAGETYPE_INT>
                                     int start,
                                     int length)
     {
-        return HAPI_GetAttributeIntData(session, nodeId, partId, name, attrInfo,
-                                        -1, dataArray, start, length);
+        return HoudiniApi::GetAttributeIntData(session, nodeId, partId, name, attrInfo,
+                                               -1, dataArray, start, length);
     }
 };
 
@@ -135,7 +135,7 @@ struct HAPIAttributeTrait<HAPI_STORAGETYPE_INT64>
                                     int start,
                                     int length)
     {
-        return HAPI_SetAttributeInt64Data(
+        return HoudiniApi::SetAttributeInt64Data(
             session, nodeId, partId, name, attrInfo, dataArray, start, length);
     }
 
@@ -148,9 +148,9 @@ struct HAPIAttributeTrait<HAPI_STORAGETYPE_INT64>
                                     int start,
                                     int length)
     {
-        return HAPI_GetAttributeInt64Data(session, nodeId, partId, name,
-                                          attrInfo, -1, dataArray, start,
-                                          length);
+        return HoudiniApi::GetAttributeInt64Data(session, nodeId, partId, name,
+                                                 attrInfo, -1, dataArray, start,
+                                                 length);
     }
 };
 
@@ -169,7 +169,7 @@ struct HAPIAttributeTrait<HAPI_STORAGETYPE_FLOAT>
                                     int start,
                                     int length)
     {
-        return HAPI_SetAttributeFloatData(
+        return HoudiniApi::SetAttributeFloatData(
             session, nodeId, partId, name, attrInfo, dataArray, start, length);
     }
 
@@ -182,9 +182,9 @@ struct HAPIAttributeTrait<HAPI_STORAGETYPE_FLOAT>
                                     int start,
                                     int length)
     {
-        return HAPI_GetAttributeFloatData(session, nodeId, partId, name,
-                                          attrInfo, -1, dataArray, start,
-                                          length);
+        return HoudiniApi::GetAttributeFloatData(session, nodeId, partId, name,
+                                                 attrInfo, -1, dataArray, start,
+                                                 length);
     }
 };
 
@@ -203,7 +203,7 @@ struct HAPIAttributeTrait<HAPI_STORAGETYPE_FLOAT64>
                                     int start,
                                     int length)
     {
-        return HAPI_SetAttributeFloat64Data(
+        return HoudiniApi::SetAttributeFloat64Data(
             session, nodeId, partId, name, attrInfo, dataArray, start, length);
     }
 
@@ -216,9 +216,9 @@ struct HAPIAttributeTrait<HAPI_STORAGETYPE_FLOAT64>
                                     int start,
                                     int length)
     {
-        return HAPI_GetAttributeFloat64Data(session, nodeId, partId, name,
-                                            attrInfo, -1, dataArray, start,
-                                            length);
+        return HoudiniApi::GetAttributeFloat64Data(session, nodeId, partId, name,
+                                                   attrInfo, -1, dataArray, start,
+                                                   length);
     }
 };
 
@@ -237,9 +237,9 @@ struct HAPIAttributeTrait<HAPI_STORAGETYPE_STRING>
                                     int start,
                                     int length)
     {
-        return HAPI_SetAttributeStringData(session, nodeId, partId, name,
-                                           attrInfo, (const char **)dataArray,
-                                           start, length);
+        return HoudiniApi::SetAttributeStringData(session, nodeId, partId, name,
+                                                  attrInfo, (const char **)dataArray,
+                                                  start, length);
     }
 
     static HAPI_Result getAttribute(const HAPI_Session *session,
@@ -251,7 +251,7 @@ struct HAPIAttributeTrait<HAPI_STORAGETYPE_STRING>
                                     int start,
                                     int length)
     {
-        return HAPI_GetAttributeStringData(
+        return HoudiniApi::GetAttributeStringData(
             session, nodeId, partId, name, attrInfo, dataArray, start, length);
     }
 };
@@ -292,7 +292,7 @@ struct HAPISetAttribute
         size_t count = dataArraySize / tupleSize;
 
         HAPI_AttributeInfo attributeInfo;
-        HAPI_AttributeInfo_Init(&attributeInfo);
+        HoudiniApi::AttributeInfo_Init(&attributeInfo);
         attributeInfo.exists    = true;
         attributeInfo.owner     = owner;
         attributeInfo.storage   = storageType;
@@ -308,8 +308,8 @@ struct HAPISetAttribute
             attributeInfo.typeInfo =
                 HAPI_AttributeTypeInfo::HAPI_ATTRIBUTE_TYPE_COLOR;
 
-        hapiResult = HAPI_AddAttribute(Util::theHAPISession.get(), nodeId,
-                                       partId, attributeName, &attributeInfo);
+        hapiResult = HoudiniApi::AddAttribute(Util::theHAPISession.get(), nodeId,
+                                              partId, attributeName, &attributeInfo);
         CHECK_HAPI_AND_RETURN(hapiResult, hapiResult);
 
         // Even when the count is zero, we still need to call
@@ -454,9 +454,9 @@ struct HAPIGetAttribute
     {
         HAPI_Result hapiResult;
 
-        hapiResult = HAPI_GetAttributeInfo(Util::theHAPISession.get(), nodeId,
-                                           partId, attributeName, owner,
-                                           &attrInfo);
+        hapiResult = HoudiniApi::GetAttributeInfo(Util::theHAPISession.get(), nodeId,
+                                                  partId, attributeName, owner,
+                                                  &attrInfo);
         if (HAPI_FAIL(hapiResult))
         {
             return HAPI_RESULT_FAILURE;
@@ -467,6 +467,18 @@ struct HAPIGetAttribute
             return HAPI_RESULT_FAILURE;
         }
 
+        return fetch(nodeId, partId, attributeName, attrInfo, dataArray);
+    }
+
+    // Fetches the data of an attribute whose info is already known.
+    static HAPI_Result fetch(HAPI_NodeId nodeId,
+                             HAPI_PartId partId,
+                             const char *attributeName,
+                             HAPI_AttributeInfo &attrInfo,
+                             T &dataArray)
+    {
+        HAPI_Result hapiResult;
+
         if (attrInfo.storage != storageType)
         {
             switch (attrInfo.storage)
@@ -478,8 +490,8 @@ struct HAPIGetAttribute
                 typedef std::vector<ComponentType> BufferType;
                 BufferType buffer;
                 hapiResult =
-                    HAPIGetAttribute<HAPI_STORAGETYPE_INT, BufferType>::impl(
-                        nodeId, partId, owner, attributeName, attrInfo, buffer);
+                    HAPIGetAttribute<HAPI_STORAGETYPE_INT, BufferType>::fetch(
+                        nodeId, partId, attributeName, attrInfo, buffer);
                 CHECK_HAPI_AND_RETURN(hapiResult, hapiResult);
                 Util::convertArray(dataArray, buffer);
 
@@ -493,8 +505,8 @@ struct HAPIGetAttribute
                 typedef std::vector<ComponentType> BufferType;
                 BufferType buffer;
                 hapiResult =
-                    HAPIGetAttribute<HAPI_STORAGETYPE_INT64, BufferType>::impl(
-                        nodeId, partId, owner, attributeName, attrInfo, buffer);
+                    HAPIGetAttribute<HAPI_STORAGETYPE_INT64, BufferType>::fetch(
+                        nodeId, partId, attributeName, attrInfo, buffer);
                 CHECK_HAPI_AND_RETURN(hapiResult, hapiResult);
                 Util::convertArray(dataArray, buffer);
 
@@ -508,8 +520,8 @@ struct HAPIGetAttribute
                 typedef std::vector<ComponentType> BufferType;
                 BufferType buffer;
                 hapiResult =
-                    HAPIGetAttribute<HAPI_STORAGETYPE_FLOAT, BufferType>::impl(
-                        nodeId, partId, owner, attributeName, attrInfo, buffer);
+                    HAPIGetAttribute<HAPI_STORAGETYPE_FLOAT, BufferType>::fetch(
+                        nodeId, partId, attributeName, attrInfo, buffer);
                 CHECK_HAPI_AND_RETURN(hapiResult, hapiResult);
                 Util::convertArray(dataArray, buffer);
 
@@ -524,9 +536,9 @@ struct HAPIGetAttribute
                 BufferType buffer;
                 hapiResult =
                     HAPIGetAttribute<HAPI_STORAGETYPE_FLOAT64,
-                                     BufferType>::impl(nodeId, partId, owner,
-                                                       attributeName, attrInfo,
-                                                       buffer);
+                                     BufferType>::fetch(nodeId, partId,
+                                                        attributeName, attrInfo,
+                                                        buffer);
                 CHECK_HAPI_AND_RETURN(hapiResult, hapiResult);
                 Util::convertArray(dataArray, buffer);
 
@@ -577,6 +589,31 @@ struct HAPIGetAttribute<storageType, T, false>
 
         return HAPI_RESULT_SUCCESS;
     }
+
+    static HAPI_Result fetch(HAPI_NodeId nodeId,
+                             HAPI_PartId partId,
+                             const char *attributeName,
+                             HAPI_AttributeInfo &attrInfo,
+                             T &dataArray)
+    {
+        typedef typename HAPIAttributeTrait<storageType>::GetType GetType;
+        typedef std::vector<GetType> ConvertedDataArray;
+
+        HAPI_Result hapiResult;
+
+        ConvertedDataArray convertedDataArray;
+
+        hapiResult = HAPIGetAttribute<storageType, ConvertedDataArray>::fetch(
+            nodeId, partId, attributeName, attrInfo, convertedDataArray);
+        if (HAPI_FAIL(hapiResult))
+        {
+            return HAPI_RESULT_FAILURE;
+        }
+
+        Util::convertArray(dataArray, convertedDataArray);
+
+        return HAPI_RESULT_SUCCESS;
+    }
 };
 
 template <typename T>
@@ -593,6 +630,51 @@ hapiGetAttribute(HAPI_NodeId nodeId,
                                      attrInfo, dataArray);
 }
 
+template <typename T, bool isArray = ARRAYTRAIT(T)::isArray>
+struct HAPIFetchAttribute
+{
+    static HAPI_Result impl(HAPI_NodeId nodeId,
+                            HAPI_PartId partId,
+                            const char *attributeName,
+                            HAPI_AttributeInfo &attrInfo,
+                            T &dataArray)
+    {
+        return HAPIGetAttribute<HAPITYPETRAIT(ELEMENTTYPE(T))::storageType,
+                                T>::fetch(nodeId, partId, attributeName,
+                                          attrInfo, dataArray);
+    }
+};
+
+template <typename T>
+struct HAPIFetchAttribute<T, false>
+{
+    static HAPI_Result impl(HAPI_NodeId nodeId,
+                            HAPI_PartId partId,
+                            const char *attributeName,
+                            HAPI_AttributeInfo &attrInfo,
+                            T &value)
+    {
+        RawArray<T> array(&value, 1);
+        return HAPIFetchAttribute<RawArray<T>>::impl(
+            nodeId, partId, attributeName, attrInfo, array);
+    }
+};
+
+// Like hapiGetAttribute(), but for an attribute whose info was already
+// fetched, e.g. with HAPI_GetAttributeInfo(). Single values are accepted as
+// well as arrays.
+template <typename T>
+HAPI_Result
+hapiFetchAttribute(HAPI_NodeId nodeId,
+                   HAPI_PartId partId,
+                   const char *attributeName,
+                   HAPI_AttributeInfo &attrInfo,
+                   T &value)
+{
+    return HAPIFetchAttribute<T>::impl(
+        nodeId, partId, attributeName, attrInfo, value);
+}
+
 template <typename T, bool isArray = ARRAYTRAIT(T)::isArray>
 struct HAPIGetDetailAttribute
 {
@@ -670,43 +752,4 @@ hapiGetPointAttribute(HAPI_NodeId nodeId,
                             attrInfo, dataArray);
 }
 
-template <typename T>
-HAPI_Result
-hapiGetAnyAttribute(HAPI_NodeId nodeId,
-                    HAPI_PartId partId,
-                    const char *attributeName,
-                    HAPI_AttributeInfo &attrInfo,
-                    T &dataArray)
-{
-    bool found = false;
-
-    if (!HAPI_FAIL(hapiGetVertexAttribute(
-            nodeId, partId, attributeName, attrInfo, dataArray)))
-    {
-        found = true;
-    }
-    else if (!HAPI_FAIL(hapiGetPointAttribute(
-                 nodeId, partId, attributeName, attrInfo, dataArray)))
-    {
-        found = true;
-    }
-    else if (!HAPI_FAIL(hapiGetPrimAttribute(
-                 nodeId, partId, attributeName, attrInfo, dataArray)))
-    {
-        found = true;
-    }
-    else if (!HAPI_FAIL(hapiGetDetailAttribute(
-                 nodeId, partId, attributeName, attrInfo, dataArray)))
-    {
-        found = true;
-    }
-
-    if (!found)
-    {
-        return HAPI_RESULT_FAILURE;
-    }
-
-    return HAPI_RESULT_SUCCESS;
-}
-
 #endif
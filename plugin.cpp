@@ -11,14 +11,18 @@
 #include <maya/MFnPlugin.h>
 
 #include "AssetCommand.h"
+#include "AssetFrameCache.h"
 #include "AssetNode.h"
 #include "EngineCommand.h"
 #include "FluidGridConvert.h"
+#include "HoudiniApiRecorder.h"
+#include "HoudiniApiTracer.h"
 #include "InputCurveNode.h"
 #include "InputGeometryNode.h"
 #include "InputMergeNode.h"
 #include "InputTransformNode.h"
 #include "OptionVars.h"
+#include "OutputMaterial.h"
 #include "Platform.h"
 #include "util.h"
 
@@ -91,10 +95,177 @@ enum Enum
 {
     ST_INPROCESS,
     ST_THRIFT_SOCKET,
-    ST_THRIFT_PIPE
+    ST_THRIFT_PIPE,
+    ST_THRIFT_SHARED_MEMORY,
+    ST_AUTO
 };
 }
 
+void
+displayConnectionError(const MString &fallbackMessage)
+{
+    int errorLength = 0;
+
+    HoudiniApi::GetConnectionErrorLength(&errorLength);
+
+    if (errorLength > 0)
+    {
+        char *msg = new char[errorLength];
+        HoudiniApi::GetConnectionError(msg, errorLength, true);
+        MGlobal::displayError(msg);
+        delete[] msg;
+    }
+    else
+    {
+        MGlobal::displayError(fallbackMessage);
+    }
+}
+
+// Starts HARS with either a named pipe or a shared memory transport. The
+// environment workarounds needed to launch HARS from inside Maya are applied
+// for the duration of the call.
+HAPI_Result
+startThriftServer(const OptionVars &optionVars,
+                  SessionType::Enum sessionType,
+                  const HAPI_ThriftServerOptions &serverOptions,
+                  const MString &serverName)
+{
+    // on Linux, if LD_LIBRARY_PATH is set, HARS might fail to start due
+    // to library conflicts so we have an option to unset it before
+    // autostarting the server.
+#ifndef _WIN32
+    char *llpString = getenv("LD_LIBRARY_PATH");
+    char *llpSave   = NULL;
+    if (optionVars.unsetLLP.get())
+    {
+        if (llpString && strlen(llpString) > 0)
+        {
+            // llpString points into the environment, so if we unsetenv,
+            // it may well be deleted, so save a copy just in case
+            llpSave = new char[strlen((llpString)) + 1];
+            strcpy(llpSave, llpString);
+            unsetenv("LD_LIBRARY_PATH");
+        }
+    }
+#endif
+
+    // When starting HARS, it's possible that the Maya python path will
+    // conflict with Houdini's. Clear the PYTHONPATH variable if
+    // instructed.
+    char *ppString = getenv("PYTHONPATH");
+    char *ppSave   = NULL;
+
+    if (optionVars.unsetPP.get())
+    {
+        if (ppString && strlen(ppString) > 0)
+        {
+            ppSave = new char[strlen((ppString)) + 1];
+            strcpy(ppSave, ppString);
+
+#ifdef _WIN32
+            _putenv("PYTHONPATH=");
+#else
+            unsetenv("PYTHONPATH");
+#endif
+        }
+    }
+
+    HAPI_Result result;
+    HAPI_ProcessId processId;
+    if (sessionType == SessionType::ST_THRIFT_SHARED_MEMORY)
+    {
+        result = HoudiniApi::StartThriftSharedMemoryServer(
+            &serverOptions, serverName.asChar(), &processId, nullptr);
+    }
+    else
+    {
+        result = HoudiniApi::StartThriftNamedPipeServer(
+            &serverOptions, serverName.asChar(), &processId, nullptr);
+    }
+
+#ifndef _WIN32
+    if (llpSave)
+    {
+        setenv("LD_LIBRARY_PATH", llpSave, 1);
+        delete[] llpSave;
+        llpSave = NULL;
+    }
+#endif
+
+    if (ppSave)
+    {
+#ifdef _WIN32
+        char prefix[] = "PYTHONPATH=";
+        char *buffer = new char[strlen(ppString) + strlen(prefix) + 1];
+        strcpy(buffer, prefix);
+        strcat(buffer, ppString);
+        _putenv(buffer);
+#else
+        setenv("PYTHONPATH", ppSave, 1);
+#endif
+        delete[] ppSave;
+        ppSave = NULL;
+    }
+
+    return result;
+}
+
+HAPI_Result
+initializeSharedMemorySession(const OptionVars &optionVars,
+                              HAPI_SessionInfo &sessionInfo)
+{
+    // Shared memory avoids serializing the attribute payloads through the
+    // pipe, which dominates the transfer time for large geometry.
+    HAPI_ThriftServerOptions serverOptions =
+        HoudiniApi::ThriftServerOptions_Create();
+    serverOptions.autoClose              = true;
+    serverOptions.timeoutMs              = optionVars.timeout.get();
+    serverOptions.sharedMemoryBufferSize =
+        optionVars.sharedMemoryBufferSize.get();
+
+    sessionInfo.sharedMemoryBufferType = serverOptions.sharedMemoryBufferType;
+    sessionInfo.sharedMemoryBufferSize = serverOptions.sharedMemoryBufferSize;
+
+    MString sharedMemoryName = "hapi_shm";
+    sharedMemoryName += getpid();
+
+    MGlobal::displayInfo("Automatically starting Houdini Engine server "
+                         "using shared memory.");
+
+    HAPI_Result sessionResult = startThriftServer(
+        optionVars, SessionType::ST_THRIFT_SHARED_MEMORY, serverOptions,
+        sharedMemoryName);
+    if (HAPI_FAIL(sessionResult))
+    {
+        displayConnectionError("Failed to automatically start Houdini Engine "
+                               "server using shared memory.");
+
+        return sessionResult;
+    }
+
+    sessionResult = HoudiniApi::CreateThriftSharedMemorySession(
+        Util::theHAPISession.get(), sharedMemoryName.asChar(), &sessionInfo);
+
+    if (!HAPI_FAIL(sessionResult))
+    {
+        MString msgBufferSize;
+        msgBufferSize += optionVars.sharedMemoryBufferSize.get();
+
+        MGlobal::displayInfo(
+            "Connected to Houdini Engine server using shared memory \"" +
+            sharedMemoryName + "\" (" + msgBufferSize + " MB buffer).");
+    }
+    else
+    {
+        displayConnectionError(
+            "Failed to connected to Houdini Engine server using shared "
+            "memory \"" +
+            sharedMemoryName + "\".");
+    }
+
+    return sessionResult;
+}
+
 HAPI_Result
 initializeSession(const OptionVars &optionVars)
 {
@@ -123,10 +294,45 @@ initializeSession(const OptionVars &optionVars)
         overrideInProcess = true;
     }
 
+    // Auto picks the transport that is cheapest for large payloads. A custom
+    // pipe means the user is connecting to a server they started themselves,
+    // so respect that. Otherwise, prefer shared memory and fall back to the
+    // named pipe if the shared memory server cannot be started.
+    bool autoFallbackToPipe = false;
+    if (sessionType == SessionType::ST_AUTO)
+    {
+        if (optionVars.sessionPipeCustom.get() ||
+            optionVars.sharedMemoryBufferSize.get() <= 0)
+        {
+            actualSessionType = SessionType::ST_THRIFT_PIPE;
+        }
+        else
+        {
+            actualSessionType  = SessionType::ST_THRIFT_SHARED_MEMORY;
+            autoFallbackToPipe = true;
+        }
+    }
+
     Util::theHAPISession.reset(new Util::HAPISession);
     HAPI_Result sessionResult = HoudiniApi::ClearConnectionError();
     HAPI_SessionInfo sessionInfo = HoudiniApi::SessionInfo_Create();
 
+    if (actualSessionType == SessionType::ST_THRIFT_SHARED_MEMORY)
+    {
+        sessionResult = initializeSharedMemorySession(optionVars, sessionInfo);
+
+        if (HAPI_FAIL(sessionResult) && autoFallbackToPipe)
+        {
+            MGlobal::displayInfo("Falling back to a named pipe Houdini Engine "
+                                 "session.");
+
+            Util::theHAPISession.reset(new Util::HAPISession);
+            HoudiniApi::ClearConnectionError();
+            sessionInfo       = HoudiniApi::SessionInfo_Create();
+            actualSessionType = SessionType::ST_THRIFT_PIPE;
+        }
+    }
+
     switch (actualSessionType)
     {
     case SessionType::ST_INPROCESS:
@@ -159,24 +365,10 @@ initializeSession(const OptionVars &optionVars)
         }
         else
         {
-            int errorLength = 0;
-
-            HoudiniApi::GetConnectionErrorLength(&errorLength);
-
-            if (errorLength > 0)
-            {
-                char *msg = new char[errorLength];
-                HoudiniApi::GetConnectionError(msg, errorLength, true);
-                MGlobal::displayError(msg);
-                delete[] msg;
-            }
-            else
-            {
-                MGlobal::displayInfo(
-                    "Failed to connected to Houdini Engine server using "
-                    "TCP socket at " +
-                    msgHostPort + ".");
-            }
+            displayConnectionError(
+                "Failed to connected to Houdini Engine server using "
+                "TCP socket at " +
+                msgHostPort + ".");
         }
     }
     break;
@@ -187,9 +379,11 @@ initializeSession(const OptionVars &optionVars)
 
         MString msgPipe;
 
-        if (!optionVars.sessionPipeCustom.get() || overrideInProcess)
+        if (!optionVars.sessionPipeCustom.get() || overrideInProcess ||
+            autoFallbackToPipe)
         {
-            HAPI_ThriftServerOptions serverOptions;
+            HAPI_ThriftServerOptions serverOptions =
+                HoudiniApi::ThriftServerOptions_Create();
             serverOptions.autoClose = true;
             serverOptions.timeoutMs = optionVars.timeout.get();
 
@@ -203,93 +397,15 @@ initializeSession(const OptionVars &optionVars)
             MGlobal::displayInfo("Automatically starting Houdini Engine server "
                                  "using named pipe.");
 
-            // on Linux, if LD_LIBRARY_PATH is set, HARS might fail to start due
-            // to library conflicts so we have an option to unset it before
-            // autostarting the server.
-#ifndef _WIN32
-            char *llpString = getenv("LD_LIBRARY_PATH");
-            char *llpSave   = NULL;
-            if (optionVars.unsetLLP.get())
-            {
-                if (llpString && strlen(llpString) > 0)
-                {
-                    // llpString points into the environment, so if we unsetenv,
-                    // it may well be deleted, so save a copy just in case
-                    llpSave = new char[strlen((llpString)) + 1];
-                    strcpy(llpSave, llpString);
-                    unsetenv("LD_LIBRARY_PATH");
-                }
-            }
-#endif
-
-            // When starting HARS, it's possible that the Maya python path will
-            // conflict with Houdini's. Clear the PYTHONPATH variable if
-            // instructed.
-            char *ppString = getenv("PYTHONPATH");
-            char *ppSave   = NULL;
-
-            if (optionVars.unsetPP.get())
-            {
-                if (ppString && strlen(ppString) > 0)
-                {
-                    ppSave = new char[strlen((ppString)) + 1];
-                    strcpy(ppSave, ppString);
-
-#ifdef _WIN32
-                    _putenv("PYTHONPATH=");
-#else
-                    unsetenv("PYTHONPATH");
-#endif
-                }
-            }
-
-            HAPI_ProcessId processId;
-            sessionResult = HoudiniApi::StartThriftNamedPipeServer(
-                &serverOptions, pipeName.asChar(), &processId, nullptr);
-
-#ifndef _WIN32
-            if (llpSave)
-            {
-                setenv("LD_LIBRARY_PATH", llpSave, 1);
-                delete[] llpSave;
-                llpSave = NULL;
-            }
-#endif
-
-            if (ppSave)
-            {
-#ifdef _WIN32
-                char prefix[] = "PYTHONPATH=";
-                char *buffer = new char[strlen(ppString) + strlen(prefix) + 1];
-                strcpy(buffer, prefix);
-                strcat(buffer, ppString);
-                _putenv(buffer);
-#else
-                setenv("PYTHONPATH", ppSave, 1);
-#endif
-                delete[] ppSave;
-                ppSave = NULL;
-            }
+            sessionResult = startThriftServer(
+                optionVars, SessionType::ST_THRIFT_PIPE, serverOptions,
+                pipeName);
 
             if (HAPI_FAIL(sessionResult))
             {
-                int errorLength = 0;
-
-                HoudiniApi::GetConnectionErrorLength(&errorLength);
-
-                if (errorLength > 0)
-                {
-                    char *msg = new char[errorLength];
-                    HoudiniApi::GetConnectionError(msg, errorLength, true);
-                    MGlobal::displayError(msg);
-                    delete[] msg;
-                }
-                else
-                {
-                    MGlobal::displayError(
-                        "Failed to automatically start Houdini Engine "
-                        "server using named pipe.");
-                }
+                displayConnectionError(
+                    "Failed to automatically start Houdini Engine "
+                    "server using named pipe.");
 
                 return HAPI_RESULT_FAILURE;
             }
@@ -319,27 +435,18 @@ initializeSession(const OptionVars &optionVars)
         }
         else
         {
-            int errorLength = 0;
-
-            HoudiniApi::GetConnectionErrorLength(&errorLength);
-
-            if (errorLength > 0)
-            {
-                char *msg = new char[errorLength];
-                HoudiniApi::GetConnectionError(msg, errorLength, true);
-                MGlobal::displayError(msg);
-                delete[] msg;
-            }
-            else
-            {
-                MGlobal::displayInfo(
-                    "Failed to connected to Houdini Engine server using "
-                    "named pipe at \"" +
-                    msgPipe + "\".");
-            }
+            displayConnectionError(
+                "Failed to connected to Houdini Engine server using "
+                "named pipe at \"" +
+                msgPipe + "\".");
         }
     }
     break;
+
+    case SessionType::ST_THRIFT_SHARED_MEMORY:
+    case SessionType::ST_AUTO:
+        // handled above
+        break;
     }
 
     if (sessionResult != HAPI_RESULT_SUCCESS)
@@ -583,7 +690,20 @@ initializePlugin(MObject obj)
         }
     }
 
-    if (hapilValid)
+    const bool replayHAPI = optionVars.hapiRecordMode.get() ==
+                            HoudiniApiRecorder::ModeReplay;
+
+    if (replayHAPI)
+    {
+        // Answer the HAPI calls from a recorded log instead of libHAPIL
+        if (!HoudiniApiRecorder::startReplay(optionVars.hapiRecordFile.get()))
+        {
+            return MStatus::kSuccess;
+        }
+
+        Util::isHapilLoaded = true;
+    }
+    else if (hapilValid)
     {
         void *hapilHandle = obtainHAPILHandle(hapilLocation.asChar());
         
@@ -595,6 +715,12 @@ initializePlugin(MObject obj)
 
         HoudiniApi::InitializeHAPI(hapilHandle);
 
+        if (optionVars.hapiRecordMode.get() == HoudiniApiRecorder::ModeRecord)
+        {
+            HoudiniApiRecorder::startRecording(
+                optionVars.hapiRecordFile.get());
+        }
+
         Util::isHapilLoaded = true;
     }
     else
@@ -613,8 +739,20 @@ initializePlugin(MObject obj)
         return MStatus::kSuccess;
     }
 
+    if (optionVars.hapiTrace.get())
+    {
+        HoudiniApiTracer::enable();
+    }
+
+    if (optionVars.frameCache.get())
+    {
+        AssetFrameCache::enable(
+            (size_t)optionVars.frameCacheSize.get() * 1024 * 1024,
+            optionVars.cookAheadFrames.get());
+    }
+
     std::string harsPath = "";
-    bool harsFound = Util::getHarsPath(harsPath);
+    bool harsFound = replayHAPI || Util::getHarsPath(harsPath);
 
     if (!harsFound)
     {
@@ -760,6 +898,11 @@ uninitializePlugin(MObject obj)
     else
         MGlobal::displayInfo("Houdini Engine cleaned up successfully.");
 
+    AssetFrameCache::disable();
+    OutputMaterial::cancelTextureBakes();
+    HoudiniApiTracer::disable();
+    HoudiniApiRecorder::stop();
+
     return status;
 }
 
@@ -1,3 +1,5 @@
+#include <cstring>
+
 #include <maya/MArrayDataBuilder.h>
 #include <maya/MDGModifier.h>
 #include <maya/MDataHandle.h>
@@ -157,6 +159,93 @@ isItemNameUsed(const std::string &itemName,
         itemNamesUsed.begin(), itemNamesUsed.end(), itemName);
 }
 
+const unsigned long long hashSeed = 14695981039346656037ull;
+
+unsigned long long
+hashBytes(unsigned long long hash, const void *data, size_t size)
+{
+    const unsigned char *bytes = static_cast<const unsigned char *>(data);
+
+    // Multiply and fold 8 bytes at a time, then the remaining bytes like
+    // FNV-1a, then mix the result so that every input bit affects every bit.
+    size_t i = 0;
+    for (; i + sizeof(unsigned long long) <= size;
+         i += sizeof(unsigned long long))
+    {
+        unsigned long long word;
+        memcpy(&word, bytes + i, sizeof(word));
+        hash = (hash ^ word) * 0x9e3779b97f4a7c15ull;
+        hash ^= hash >> 32;
+    }
+
+    for (; i < size; i++)
+    {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+
+    return hash;
+}
+
+bool
+hashParmValues(HAPI_NodeId nodeId, unsigned long long &hash)
+{
+    HAPI_NodeInfo nodeInfo;
+    CHECK_HAPI_AND_RETURN(
+        HoudiniApi::GetNodeInfo(theHAPISession.get(), nodeId, &nodeInfo),
+        false);
+
+    if (nodeInfo.parmIntValueCount > 0)
+    {
+        std::vector<int> values(nodeInfo.parmIntValueCount);
+        CHECK_HAPI_AND_RETURN(
+            HoudiniApi::GetParmIntValues(theHAPISession.get(), nodeId,
+                                         &values[0], 0, values.size()),
+            false);
+        hash = hashBytes(hash, &values[0], values.size() * sizeof(int));
+    }
+
+    if (nodeInfo.parmFloatValueCount > 0)
+    {
+        std::vector<float> values(nodeInfo.parmFloatValueCount);
+        CHECK_HAPI_AND_RETURN(
+            HoudiniApi::GetParmFloatValues(theHAPISession.get(), nodeId,
+                                           &values[0], 0, values.size()),
+            false);
+        hash = hashBytes(hash, &values[0], values.size() * sizeof(float));
+    }
+
+    if (nodeInfo.parmStringValueCount > 0)
+    {
+        std::vector<HAPI_StringHandle> handles(nodeInfo.parmStringValueCount);
+        CHECK_HAPI_AND_RETURN(
+            HoudiniApi::GetParmStringValues(theHAPISession.get(), nodeId,
+                                            true, &handles[0], 0,
+                                            handles.size()),
+            false);
+
+        int bufferSize = 0;
+        CHECK_HAPI_AND_RETURN(
+            HoudiniApi::GetStringBatchSize(theHAPISession.get(), &handles[0],
+                                           handles.size(), &bufferSize),
+            false);
+        if (bufferSize > 0)
+        {
+            std::vector<char> buffer(bufferSize);
+            CHECK_HAPI_AND_RETURN(
+                HoudiniApi::GetStringBatch(
+                    theHAPISession.get(), &buffer[0], bufferSize),
+                false);
+            hash = hashBytes(hash, &buffer[0], buffer.size());
+        }
+    }
+
+    return true;
+}
+
 MString
 mangleParmAttrName(const HAPI_ParmInfo &parm, const MString &in_name)
 {
@@ -586,9 +675,44 @@ LogProgressBar::hideProgress()
     myComputation.endComputation();
 }
 
+namespace
+{
+StatusCheckStats theStatusCheckStats;
+
+double
+secondsSince(const std::chrono::steady_clock::time_point &start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                         start)
+        .count();
+}
+}
+
+const StatusCheckStats &
+statusCheckStats()
+{
+    return theStatusCheckStats;
+}
+
+void
+resetStatusCheckStats()
+{
+    theStatusCheckStats = StatusCheckStats();
+}
+
 bool
 statusCheckLoop(bool wantMainProgressBar)
 {
+    // The status is polled again after minPollInterval when the cook state
+    // changes, and then less and less often, up to maxPollInterval, while it
+    // stays the same. A new cook count alone keeps the current interval, so
+    // that a cook of many nodes doesn't poll at the shortest interval.
+    const std::chrono::microseconds minPollInterval(1000);
+    const std::chrono::microseconds maxPollInterval(20000);
+
+    const std::chrono::steady_clock::time_point loopStart =
+        std::chrono::steady_clock::now();
+
     HAPI_State state   = HAPI_STATE_STARTING_LOAD;
     int currState      = (int)state;
     int currCookCount  = -1;
@@ -606,8 +730,26 @@ statusCheckLoop(bool wantMainProgressBar)
 
     progressBar->beginProgress();
 
+    std::chrono::microseconds pollInterval(0);
+    int lastState     = -1;
+    int lastCookCount = -2;
+    std::vector<char> statusBuf;
+    MString status;
+
     while (state > HAPI_STATE_MAX_READY_STATE)
     {
+        if (pollInterval.count() > 0)
+        {
+            const std::chrono::steady_clock::time_point sleepStart =
+                std::chrono::steady_clock::now();
+            std::this_thread::sleep_for(pollInterval);
+            theStatusCheckStats.sleepSeconds += secondsSince(sleepStart);
+        }
+
+        const std::chrono::steady_clock::time_point pollStart =
+            std::chrono::steady_clock::now();
+        theStatusCheckStats.polls++;
+
         HoudiniApi::GetStatus(
             theHAPISession.get(), HAPI_STATUS_COOK_STATE, &currState);
         state = (HAPI_State)currState;
@@ -623,41 +765,55 @@ statusCheckLoop(bool wantMainProgressBar)
             totalCookCount = -1;
         }
 
-        int statusBufSize = 0;
-        HoudiniApi::GetStatusStringBufLength(
-            theHAPISession.get(), HAPI_STATUS_COOK_STATE,
-            HAPI_STATUSVERBOSITY_ERRORS, &statusBufSize);
+        // Only fetch the status string when the status changed.
+        const bool stateChanged     = currState != lastState;
+        const bool cookCountChanged = currCookCount != lastCookCount;
+        if (stateChanged || cookCountChanged)
+        {
+            lastState     = currState;
+            lastCookCount = currCookCount;
 
-        char *statusBuf = NULL;
+            int statusBufSize = 0;
+            HoudiniApi::GetStatusStringBufLength(
+                theHAPISession.get(), HAPI_STATUS_COOK_STATE,
+                HAPI_STATUSVERBOSITY_ERRORS, &statusBufSize);
 
-        if (statusBufSize > 0)
-        {
-            statusBuf = new char[statusBufSize];
-            HoudiniApi::GetStatusString(theHAPISession.get(), HAPI_STATUS_COOK_STATE,
-                                 statusBuf, statusBufSize);
+            status.clear();
+            if (statusBufSize > 0)
+            {
+                statusBuf.resize(statusBufSize);
+                HoudiniApi::GetStatusString(theHAPISession.get(),
+                                            HAPI_STATUS_COOK_STATE,
+                                            &statusBuf[0], statusBufSize);
+                status = &statusBuf[0];
+            }
+            theStatusCheckStats.statusStringFetches++;
         }
 
-        progressBar->updateProgress(currCookCount, totalCookCount, statusBuf);
-
-        if (statusBuf)
+        if (stateChanged)
         {
-            delete[] statusBuf;
+            pollInterval = minPollInterval;
+        }
+        else if (!cookCountChanged)
+        {
+            pollInterval = (std::min)(pollInterval * 2, maxPollInterval);
         }
 
+        progressBar->updateProgress(currCookCount, totalCookCount, status);
+
         if (progressBar->isInterrupted())
         {
             HoudiniApi::Interrupt(theHAPISession.get());
         }
 
-#ifdef _WIN32
-        Sleep(1);
-#else
-        usleep(1000);
-#endif
+        theStatusCheckStats.pollSeconds += secondsSince(pollStart);
     }
 
     progressBar->endProgress();
 
+    theStatusCheckStats.calls++;
+    theStatusCheckStats.totalSeconds += secondsSince(loopStart);
+
     if (state == HAPI_STATE_READY_WITH_FATAL_ERRORS ||
         state == HAPI_STATE_READY_WITH_COOK_ERRORS)
     {
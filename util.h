@@ -18,11 +18,12 @@
 #include <iosfwd>
 #include <memory>
 #include <stdio.h>
+#include <chrono>
 #include <string>
+#include <thread>
 #include <vector>
 #ifdef _WIN32
 #include <direct.h>
-#include <chrono>
 #endif
 
 #include <HAPI/HAPI.h>
@@ -56,12 +57,13 @@
     std::vector<char> _hapiStatusBuffer;                                       \
     {                                                                          \
         int bufferLength;                                                      \
-        HAPI_GetStatusStringBufLength(Util::theHAPISession.get(),              \
-                                      (status_type), (verbosity),              \
-                                      &bufferLength);                          \
+        HoudiniApi::GetStatusStringBufLength(Util::theHAPISession.get(),       \
+                                             (status_type), (verbosity),       \
+                                             &bufferLength);                   \
         _hapiStatusBuffer.resize(bufferLength);                                \
-        HAPI_GetStatusString(Util::theHAPISession.get(), (status_type),        \
-                             &_hapiStatusBuffer.front(), bufferLength);        \
+        HoudiniApi::GetStatusString(Util::theHAPISession.get(),                \
+                                    (status_type), &_hapiStatusBuffer.front(), \
+                                    bufferLength);                             \
     }                                                                          \
     const char *hapiStatus = &_hapiStatusBuffer.front();
 
@@ -152,6 +154,18 @@ void markItemNameUsed(const std::string &itemName,
 bool isItemNameUsed(const std::string &itemName,
 		    std::vector<std::string> &itemNamesUsed);
 
+// Fast non-cryptographic 64-bit hash. Chain calls by passing the previous
+// result as hash, starting from hashSeed.
+extern const unsigned long long hashSeed;
+unsigned long long hashBytes(unsigned long long hash,
+			     const void *data,
+			     size_t size);
+
+// Hashes the int, float and string values of all the parms of a node into
+// hash. The strings are hashed by value, since their handles change between
+// calls.
+bool hashParmValues(HAPI_NodeId nodeId, unsigned long long &hash);
+
 template <size_t N>
 struct CacheImpl;
 
@@ -249,13 +263,44 @@ struct CacheImpl<0>
 	}
 };
 
+// Splits [0, count) into contiguous ranges and calls func(begin, end) for each
+// of them on its own thread. The ranges are at least minRangeSize long, so
+// small counts run on the calling thread only. func must not call HAPI or the
+// Maya API.
+template <typename Func>
+void parallelFor(size_t count, size_t minRangeSize, const Func &func)
+{
+	size_t threadCount = (std::max)(std::thread::hardware_concurrency(), 1u);
+	threadCount = (std::min)(threadCount,
+				 count / (std::max)(minRangeSize, size_t(1)));
+
+	if (threadCount <= 1) {
+		if (count)
+			func(size_t(0), count);
+		return;
+	}
+
+	const size_t rangeSize = (count + threadCount - 1) / threadCount;
+
+	std::vector<std::thread> threads;
+	threads.reserve(threadCount - 1);
+	for (size_t begin = rangeSize; begin < count; begin += rangeSize)
+		threads.emplace_back(
+		    func, begin, (std::min)(begin + rangeSize, count));
+
+	func(size_t(0), rangeSize);
+
+	for (std::thread &thread : threads)
+		thread.join();
+}
+
 class HAPIString
 {
 public:
 	HAPIString(int handle) : myHandle(handle)
 	{
 		int bufLen;
-		HAPI_GetStringBufLength(theHAPISession.get(), myHandle, &bufLen);
+		HoudiniApi::GetStringBufLength(theHAPISession.get(), myHandle, &bufLen);
 
 		if (bufLen == 0) {
 			return;
@@ -263,7 +308,7 @@ public:
 
 		myString.resize(bufLen - 1);
 
-		HAPI_GetString(
+		HoudiniApi::GetString(
 		    theHAPISession.get(), myHandle, &myString[0], myString.size() + 1);
 	}
 
@@ -403,6 +448,33 @@ private:
 
 bool statusCheckLoop(bool wantMainProgressBar = true);
 
+// Overhead of statusCheckLoop, accumulated over all of its calls.
+struct StatusCheckStats
+{
+	StatusCheckStats()
+	    : calls(0),
+	      polls(0),
+	      statusStringFetches(0),
+	      pollSeconds(0),
+	      sleepSeconds(0),
+	      totalSeconds(0)
+	{
+	}
+
+	unsigned long long calls;
+	unsigned long long polls;
+	unsigned long long statusStringFetches;
+	// Time spent polling HAPI and updating the progress bar.
+	double pollSeconds;
+	// Time spent sleeping between the polls.
+	double sleepSeconds;
+	// Time spent in statusCheckLoop overall.
+	double totalSeconds;
+};
+
+const StatusCheckStats &statusCheckStats();
+void resetStatusCheckStats();
+
 MString getNodeName(const MObject &nodeObj);
 MObject findNodeByName(const MString &name,
 		       MFn::Type expectedFn = MFn::kInvalid);